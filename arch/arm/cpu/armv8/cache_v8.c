@@ -164,9 +164,45 @@ static u64 *find_pte(u64 addr, int level)
 }
 
 #ifdef CONFIG_CMO_BY_VA_ONLY
-static void __cmo_on_leaves(void (*cmo_fn)(unsigned long, unsigned long),
-			    u64 pte, int level, u64 base)
+/**
+ * struct cmo_batch - RAM waiting for cache maintenance
+ *
+ * Adjacent leaves are merged so that a large area of RAM mapped with many
+ * blocks is handled by a single call to the CMO function, with a single
+ * barrier at the end, rather than one per block
+ *
+ * @cmo_fn: Function to carry out the maintenance
+ * @start: Start of the pending range
+ * @end: End of the pending range (exclusive), equal to @start if none
+ */
+struct cmo_batch {
+	void (*cmo_fn)(unsigned long, unsigned long);
+	u64 start;
+	u64 end;
+};
+
+static void cmo_batch_flush(struct cmo_batch *batch)
+{
+	if (batch->end == batch->start)
+		return;
+	debug("CMO on %llx-%llx\n", batch->start, batch->end);
+	batch->cmo_fn(batch->start, batch->end);
+	batch->start = batch->end;
+}
+
+static void cmo_batch_add(struct cmo_batch *batch, u64 start, u64 end)
+{
+	if (start != batch->end) {
+		cmo_batch_flush(batch);
+		batch->start = start;
+	}
+	batch->end = end;
+}
+
+static void __cmo_on_leaves(struct cmo_batch *batch, u64 pte, int level,
+			    u64 base)
 {
+	u64 ram_end = gd->ram_base + gd->ram_size;
 	u64 *ptep;
 	int i;
 
@@ -187,7 +223,7 @@ static void __cmo_on_leaves(void (*cmo_fn)(unsigned long, unsigned long),
 		/* Not a leaf? Recurse on the next level */
 		if (!(type == PTE_TYPE_BLOCK ||
 		      (level == 3 && type == PTE_TYPE_PAGE))) {
-			__cmo_on_leaves(cmo_fn, pte, level + 1, va);
+			__cmo_on_leaves(batch, pte, level + 1, va);
 			continue;
 		}
 
@@ -200,11 +236,10 @@ static void __cmo_on_leaves(void (*cmo_fn)(unsigned long, unsigned long),
 		    attrs != PTE_BLOCK_MEMTYPE(MT_NORMAL_NC))
 			continue;
 
-		end = va + BIT(level2shift(level)) - 1;
+		end = va + BIT(level2shift(level));
 
 		/* No intersection with RAM? */
-		if (end < gd->ram_base ||
-		    va >= (gd->ram_base + gd->ram_size))
+		if (end <= gd->ram_base || va >= ram_end)
 			continue;
 
 		/*
@@ -214,16 +249,17 @@ static void __cmo_on_leaves(void (*cmo_fn)(unsigned long, unsigned long),
 		 * about, and not a byte more.
 		 */
 		va = max(va, (u64)gd->ram_base);
-		end = min(end, gd->ram_base + gd->ram_size);
+		end = min(end, ram_end);
 
 		debug("Flush PTE %llx at level %d: %llx-%llx\n",
 		      pte, level, va, end);
-		cmo_fn(va, end);
+		cmo_batch_add(batch, va, end);
 	}
 }
 
 static void apply_cmo_to_mappings(void (*cmo_fn)(unsigned long, unsigned long))
 {
+	struct cmo_batch batch = { .cmo_fn = cmo_fn };
 	u64 va_bits;
 	int sl = 0;
 
@@ -234,7 +270,8 @@ static void apply_cmo_to_mappings(void (*cmo_fn)(unsigned long, unsigned long))
 	if (va_bits < 39)
 		sl = 1;
 
-	__cmo_on_leaves(cmo_fn, gd->arch.tlb_addr, sl, 0);
+	__cmo_on_leaves(&batch, gd->arch.tlb_addr, sl, 0);
+	cmo_batch_flush(&batch);
 }
 #else
 static inline void apply_cmo_to_mappings(void *dummy) {}
@@ -268,6 +305,26 @@ static void set_pte_table(u64 *pte, u64 *table)
 	*pte = PTE_TYPE_TABLE | (ulong)table;
 }
 
+/*
+ * Entries marked contiguous must all have the same attributes, so before one
+ * of them is changed, take the mark off the whole group. Changing the mark
+ * on tables which are in use would need break-before-make over the whole
+ * group, which may well hold this code or its stack. Contiguous entries are
+ * only created by mmu_setup(), whose tables are only changed while running
+ * on the emergency tables, so the group can simply be rewritten.
+ */
+static void clear_cont(u64 *pte)
+{
+	u64 *first = (u64 *)ALIGN_DOWN((ulong)pte,
+				       PTE_CONT_ENTRIES * sizeof(u64));
+	int i;
+
+	if (!(*pte & PTE_BLOCK_CONT))
+		return;
+	for (i = 0; i < PTE_CONT_ENTRIES; i++)
+		first[i] &= ~PTE_BLOCK_CONT;
+}
+
 /* Splits a block PTE into table with subpages spanning the old block */
 static void split_block(u64 *pte, int level)
 {
@@ -285,6 +342,8 @@ static void split_block(u64 *pte, int level)
 	new_table = create_table();
 	debug("Splitting pte %p (%llx) into %p\n", pte, old_pte, new_table);
 
+	clear_cont(pte);
+	old_pte &= ~PTE_BLOCK_CONT;
 	for (i = 0; i < MAX_PTE_ENTRIES; i++) {
 		new_table[i] = old_pte | (i << levelshift);
 
@@ -300,15 +359,37 @@ static void split_block(u64 *pte, int level)
 }
 
 static void map_range(u64 virt, u64 phys, u64 size, int level,
-		      u64 *table, u64 attrs)
+		      u64 *table, u64 attrs, bool cont)
 {
 	u64 map_size = BIT_ULL(level2shift(level));
+	u64 cont_size = map_size * PTE_CONT_ENTRIES;
 	int i, idx;
 
 	idx = (virt >> level2shift(level)) & (MAX_PTE_ENTRIES - 1);
 	for (i = idx; size; i++) {
 		u64 next_size, *next_table;
 
+		/*
+		 * A whole group of aligned pages or level 2 blocks can be
+		 * marked contiguous, so that it takes a single TLB entry
+		 */
+		if (cont && level >= 2 && size >= cont_size &&
+		    !((virt | phys) & (cont_size - 1))) {
+			int j;
+
+			for (j = 0; j < PTE_CONT_ENTRIES; j++, i++) {
+				table[i] = phys | attrs | PTE_BLOCK_CONT;
+				if (level == 3)
+					table[i] |= PTE_TYPE_PAGE;
+				phys += map_size;
+			}
+			i--;
+			virt += cont_size;
+			size -= cont_size;
+
+			continue;
+		}
+
 		if (level >= 1 &&
 		    size >= map_size && !(virt & (map_size - 1))) {
 			if (level == 3)
@@ -330,7 +411,8 @@ static void map_range(u64 virt, u64 phys, u64 size, int level,
 		next_table = (u64 *)(table[i] & GENMASK_ULL(47, PAGE_SHIFT));
 		next_size = min(map_size - (virt & (map_size - 1)), size);
 
-		map_range(virt, phys, next_size, level + 1, next_table, attrs);
+		map_range(virt, phys, next_size, level + 1, next_table, attrs,
+			  cont);
 
 		virt += next_size;
 		phys += next_size;
@@ -338,7 +420,7 @@ static void map_range(u64 virt, u64 phys, u64 size, int level,
 	}
 }
 
-static void add_map(struct mm_region *map)
+static void add_map(struct mm_region *map, bool cont)
 {
 	u64 attrs = map->attrs | PTE_TYPE_BLOCK | PTE_BLOCK_AF;
 	u64 va_bits;
@@ -349,7 +431,7 @@ static void add_map(struct mm_region *map)
 		level = 1;
 
 	map_range(map->virt, map->phys, map->size, level,
-		  (u64 *)gd->arch.tlb_addr, attrs);
+		  (u64 *)gd->arch.tlb_addr, attrs, cont);
 }
 
 static void count_range(u64 virt, u64 size, int level, int *cntp)
@@ -419,7 +501,12 @@ __weak u64 get_page_table_size(void)
 	return size;
 }
 
-void setup_pgtables(void)
+/*
+ * Build the page tables for mem_map. If @cont is true, aligned groups of
+ * entries are marked contiguous; see clear_cont() for why this is only done
+ * for the tables built by mmu_setup().
+ */
+static void build_pgtables(bool cont)
 {
 	int i;
 
@@ -435,21 +522,25 @@ void setup_pgtables(void)
 
 	/* Now add all MMU table entries one after another to the table */
 	for (i = 0; mem_map[i].size || mem_map[i].attrs; i++)
-		add_map(&mem_map[i]);
+		add_map(&mem_map[i], cont);
 }
 
-static void setup_all_pgtables(void)
+void setup_pgtables(void)
+{
+	build_pgtables(false);
+}
+
+/*
+ * Create the emergency page tables in the space after the normal ones. These
+ * are only needed to change the normal tables while the MMU is using them, so
+ * they are not created until mmu_set_region_dcache_behaviour() first needs
+ * them. Many phases (SPL in particular) never do.
+ */
+static void setup_emerg_pgtables(void)
 {
 	u64 tlb_addr = gd->arch.tlb_addr;
 	u64 tlb_size = gd->arch.tlb_size;
 
-	/* Reset the fill ptr */
-	gd->arch.tlb_fillptr = tlb_addr;
-
-	/* Create normal system page tables */
-	setup_pgtables();
-
-	/* Create emergency page tables */
 	gd->arch.tlb_size -= (uintptr_t)gd->arch.tlb_fillptr -
 			     (uintptr_t)gd->arch.tlb_addr;
 	gd->arch.tlb_addr = gd->arch.tlb_fillptr;
@@ -459,6 +550,16 @@ static void setup_all_pgtables(void)
 	gd->arch.tlb_size = tlb_size;
 }
 
+static void setup_all_pgtables(void)
+{
+	/* Reset the fill ptr; any emergency tables after it are lost */
+	gd->arch.tlb_fillptr = gd->arch.tlb_addr;
+	gd->arch.tlb_emerg = 0;
+
+	/* Create normal system page tables */
+	build_pgtables(true);
+}
+
 /* to activate the MMU we need to set up virtual memory */
 __weak void mmu_setup(void)
 {
@@ -603,6 +704,7 @@ static u64 set_one_region(u64 start, u64 size, u64 attrs, bool flag, int level)
 
 	/* Can we can just modify the current level block PTE? */
 	if (is_aligned(start, size, levelsize)) {
+		clear_cont(pte);
 		if (flag) {
 			*pte &= ~PMD_ATTRMASK;
 			*pte |= attrs & PMD_ATTRMASK;
@@ -640,8 +742,11 @@ void mmu_set_region_dcache_behaviour(phys_addr_t start, size_t size,
 
 	debug("start=%lx size=%lx\n", (ulong)start, (ulong)size);
 
-	if (!gd->arch.tlb_emerg)
-		panic("Emergency page table not setup.");
+	if (!gd->arch.tlb_emerg) {
+		if (!gd->arch.tlb_fillptr)
+			panic("Emergency page table not setup.");
+		setup_emerg_pgtables();
+	}
 
 	/*
 	 * We can not modify page tables that we're currently running on,
@@ -684,7 +789,9 @@ void mmu_set_region_dcache_behaviour(phys_addr_t start, size_t size,
 /*
  * Modify MMU table for a region with updated PXN/UXN/Memory type/valid bits.
  * The procecess is break-before-make. The target region will be marked as
- * invalid during the process of changing.
+ * invalid during the process of changing. This works on the tables in use,
+ * so must only be used on tables built with setup_pgtables(), which has no
+ * contiguous entries.
  */
 void mmu_change_region_attr(phys_addr_t addr, size_t siz, u64 attrs)
 {
@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler using the generic timer
+ *
+ * The EL1 virtual timer raises PPI 27 once per period and the IRQ handler
+ * records the interrupted PC and LR. This expects a GICv3 which firmware has
+ * already set up, as on RK35xx, so only the timer's PPI in this CPU's
+ * redistributor and the CPU interface are touched.
+ */
+
+#define LOG_CATEGORY	LOGC_ARCH
+
+#include <common.h>
+#include <log.h>
+#include <mapmem.h>
+#include <profile.h>
+#include <asm/gic.h>
+#include <asm/io.h>
+#include <asm/ptrace.h>
+#include <asm/system.h>
+#include <dm/ofnode.h>
+#include <linux/bitops.h>
+#include <linux/errno.h>
+#include <linux/sizes.h>
+#include <linux/stringify.h>
+
+/* Interrupt ID of the EL1 virtual timer */
+#define PROFILE_INTID		27
+
+/* Priority of the timer interrupt; anything below 0xff is let through */
+#define PROFILE_PRIORITY	0xa0
+
+#define GICR_TYPER_VLPIS	BIT(1)
+#define GICR_TYPER_LAST		BIT(4)
+#define GICR_SGI_BASE		SZ_64K
+#define ICC_IAR_INTID		GENMASK(23, 0)
+#define ICC_INTID_SPURIOUS	1020
+
+#define HCR_EL2_IMO		BIT(4)
+#define CNTV_CTL_ENABLE		BIT(0)
+
+#define read_sysreg(reg) ({						\
+	ulong __val;							\
+	asm volatile("mrs %0, " __stringify(reg) : "=r" (__val));	\
+	__val;								\
+})
+
+#define write_sysreg(reg, val)						\
+	asm volatile("msr " __stringify(reg) ", %0" : : "r" ((ulong)(val)))
+
+/**
+ * struct arm_profile - State of the profiler timer
+ *
+ * The GIC settings touched when starting are saved, so that stopping hands
+ * the GIC back as firmware left it.
+ *
+ * @sgi: SGI/PPI frame of this CPU's redistributor
+ * @tval: Timer ticks per period
+ * @hcr: Value of HCR_EL2 before starting, if running at EL2
+ * @sre: Value of ICC_SRE_ELx before starting
+ * @pmr: Value of ICC_PMR_EL1 before starting
+ * @igrpen1: Value of ICC_IGRPEN1_EL1 before starting
+ * @igroupr: Value of GICR_IGROUPR0 before starting
+ * @enabled: true if the timer's PPI was enabled before starting
+ * @priority: Priority of the timer's PPI before starting
+ */
+struct arm_profile {
+	void __iomem *sgi;
+	ulong tval;
+	ulong hcr;
+	ulong sre;
+	ulong pmr;
+	ulong igrpen1;
+	u32 igroupr;
+	bool enabled;
+	u8 priority;
+};
+
+static struct arm_profile arm_prof;
+
+/* Find the redistributor for this CPU */
+static void __iomem *arm_profile_find_rd(void)
+{
+	ulong mpidr = read_mpidr();
+	void __iomem *rd;
+	fdt_addr_t addr;
+	ofnode node;
+	u64 typer;
+	u32 aff;
+
+	node = ofnode_by_compatible(ofnode_null(), "arm,gic-v3");
+	if (!ofnode_valid(node))
+		return NULL;
+	addr = ofnode_get_addr_index(node, 1);
+	if (addr == FDT_ADDR_T_NONE)
+		return NULL;
+
+	/* GICR_TYPER has Aff3.Aff2.Aff1.Aff0 in its top half */
+	aff = (mpidr & GENMASK(23, 0)) | (mpidr >> 32 & 0xff) << 24;
+	for (rd = map_sysmem(addr, 0);;) {
+		typer = readq(rd + GICR_TYPER);
+		if (typer >> 32 == aff)
+			return rd;
+		if (typer & GICR_TYPER_LAST)
+			return NULL;
+		rd += (typer & GICR_TYPER_VLPIS ? 4 : 2) * SZ_64K;
+	}
+}
+
+int arch_profile_start(ulong period_us)
+{
+	void __iomem *rd;
+
+	rd = arm_profile_find_rd();
+	if (!rd)
+		return log_msg_ret("gic", -ENODEV);
+	arm_prof.sgi = rd + GICR_SGI_BASE;
+	arm_prof.tval = max((u64)read_sysreg(cntfrq_el0) * period_us / 1000000,
+			    1ULL);
+
+	/* Non-secure group 1, enabled; no other interrupt is touched */
+	arm_prof.igroupr = readl(arm_prof.sgi + GICR_IGROUPRn);
+	arm_prof.priority = readb(arm_prof.sgi + GICR_IPRIORITYRn +
+				  PROFILE_INTID);
+	arm_prof.enabled = readl(arm_prof.sgi + GICR_ISENABLERn) &
+		BIT(PROFILE_INTID);
+	writel(arm_prof.igroupr | BIT(PROFILE_INTID),
+	       arm_prof.sgi + GICR_IGROUPRn);
+	writeb(PROFILE_PRIORITY,
+	       arm_prof.sgi + GICR_IPRIORITYRn + PROFILE_INTID);
+	writel(BIT(PROFILE_INTID), arm_prof.sgi + GICR_ISENABLERn);
+
+	if (current_el() == 2) {
+		arm_prof.sre = read_sysreg(ICC_SRE_EL2);
+		write_sysreg(ICC_SRE_EL2, arm_prof.sre | 1);
+		isb();
+
+		/* Physical IRQs are only taken at EL2 if routed here */
+		arm_prof.hcr = read_sysreg(hcr_el2);
+		write_sysreg(hcr_el2, arm_prof.hcr | HCR_EL2_IMO);
+	} else {
+		arm_prof.sre = read_sysreg(ICC_SRE_EL1);
+		write_sysreg(ICC_SRE_EL1, arm_prof.sre | 1);
+	}
+	isb();
+	arm_prof.pmr = read_sysreg(ICC_PMR_EL1);
+	arm_prof.igrpen1 = read_sysreg(ICC_IGRPEN1_EL1);
+	write_sysreg(ICC_PMR_EL1, 0xff);
+	write_sysreg(ICC_IGRPEN1_EL1, 1);
+
+	write_sysreg(cntv_tval_el0, arm_prof.tval);
+	write_sysreg(cntv_ctl_el0, CNTV_CTL_ENABLE);
+	isb();
+	asm volatile("msr daifclr, #2");
+
+	return 0;
+}
+
+void arch_profile_stop(void)
+{
+	asm volatile("msr daifset, #2");
+	write_sysreg(cntv_ctl_el0, 0);
+	isb();
+
+	if (!arm_prof.enabled)
+		writel(BIT(PROFILE_INTID), arm_prof.sgi + GICR_ICENABLERn);
+	writeb(arm_prof.priority,
+	       arm_prof.sgi + GICR_IPRIORITYRn + PROFILE_INTID);
+	writel(arm_prof.igroupr, arm_prof.sgi + GICR_IGROUPRn);
+
+	write_sysreg(ICC_IGRPEN1_EL1, arm_prof.igrpen1);
+	write_sysreg(ICC_PMR_EL1, arm_prof.pmr);
+	if (current_el() == 2) {
+		write_sysreg(hcr_el2, arm_prof.hcr);
+		write_sysreg(ICC_SRE_EL2, arm_prof.sre);
+	} else {
+		write_sysreg(ICC_SRE_EL1, arm_prof.sre);
+	}
+	isb();
+}
+
+int arm_profile_irq(struct pt_regs *regs)
+{
+	ulong intid = read_sysreg(ICC_IAR1_EL1) & ICC_IAR_INTID;
+
+	/* INTIDs 1020-1023 are special; there is nothing to acknowledge */
+	if (intid >= ICC_INTID_SPURIOUS)
+		return 0;
+	if (intid != PROFILE_INTID) {
+		write_sysreg(ICC_EOIR1_EL1, intid);
+		return -ENOENT;
+	}
+
+	profile_sample(regs->elr, regs->regs[30]);
+	write_sysreg(cntv_tval_el0, arm_prof.tval);
+	write_sysreg(ICC_EOIR1_EL1, intid);
+
+	return 0;
+}
@@ -66,6 +66,13 @@
 #define PTE_BLOCK_NG		(1 << 11)
 #define PTE_BLOCK_PXN		(UL(1) << 53)
 #define PTE_BLOCK_UXN		(UL(1) << 54)
+#define PTE_BLOCK_CONT		(UL(1) << 52)
+
+/*
+ * Number of adjacent entries which may be marked with PTE_BLOCK_CONT so that
+ * the TLB can hold them as one (4KiB granule: 64KiB pages, 32MiB blocks)
+ */
+#define PTE_CONT_ENTRIES	16
 
 /*
  * AttrIndx[2:0]
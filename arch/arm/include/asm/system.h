@@ -202,6 +202,20 @@ static inline unsigned long read_mpidr(void)
 	return val;
 }
 
+struct pt_regs;
+
+/**
+ * arm_profile_irq() - Handle the profiler's timer interrupt
+ *
+ * Spurious interrupts (INTIDs 1020-1023), e.g. one which was withdrawn before
+ * it was acknowledged, are ignored.
+ *
+ * @regs: Registers at the time of the interrupt
+ * Return: 0 if handled or spurious, -ENOENT if the interrupt is not the
+ *	profiler's
+ */
+int arm_profile_irq(struct pt_regs *regs);
+
 #define BSP_COREID	0
 
 void __asm_flush_dcache_all(void);
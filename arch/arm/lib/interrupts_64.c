@@ -8,6 +8,7 @@
 #include <asm/esr.h>
 #include <asm/global_data.h>
 #include <asm/ptrace.h>
+#include <asm/system.h>
 #include <irq_func.h>
 #include <linux/compiler.h>
 #include <efi_loader.h>
@@ -212,6 +213,13 @@ void do_sync(struct pt_regs *pt_regs)
  */
 void do_irq(struct pt_regs *pt_regs)
 {
+	/*
+	 * The profiler's timer is the only interrupt that is expected. It
+	 * also swallows spurious interrupts, rather than panicking.
+	 */
+	if (CONFIG_IS_ENABLED(PROFILE) && !arm_profile_irq(pt_regs))
+		return;
+
 	efi_restore_gd();
 	printf("\"Irq\" handler, esr 0x%08lx\n", pt_regs->esr);
 	show_regs(pt_regs);
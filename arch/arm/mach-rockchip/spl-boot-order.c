@@ -4,11 +4,20 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <dm.h>
 #include <log.h>
 #include <mmc.h>
 #include <spl.h>
 #include <asm/global_data.h>
+#include <asm/gpio.h>
+#include <asm/io.h>
+#include <dm/uclass-internal.h>
+#include <linux/bitops.h>
+
+/* Upper half of the boot-hint register, to spot a value we did not write */
+#define BOOT_HINT_MAGIC		0xb0070000
+#define BOOT_HINT_DEV_MASK	0xffff
 
 #if CONFIG_IS_ENABLED(OF_LIBFDT)
 /**
@@ -80,6 +89,82 @@ static int spl_node_to_boot_device(int node)
 	return -1;
 }
 
+/**
+ * spl_node_card_present() - checks for a card in a removable MMC slot
+ * @node:	of_offset of the node
+ *
+ * The controller is not probed just for this. Unless it has been probed
+ * already, only a card-detect GPIO is looked at.
+ *
+ * Returns
+ *   1, if the node is a removable slot and a card is detected
+ *   0, if the node is a removable slot and it is empty
+ *   -ENOSYS, if the node is not a removable slot or it cannot tell
+ */
+static int spl_node_card_present(int node)
+{
+	ofnode np = offset_to_ofnode(node);
+	struct gpio_desc cd;
+	struct udevice *dev;
+	int ret;
+
+	if (ofnode_read_bool(np, "non-removable") ||
+	    ofnode_read_bool(np, "broken-cd"))
+		return -ENOSYS;
+
+	if (!uclass_find_device_by_ofnode(UCLASS_MMC, np, &dev) &&
+	    device_active(dev)) {
+		ret = mmc_getcd(mmc_get_mmc_dev(dev));
+	} else if (CONFIG_IS_ENABLED(DM_GPIO) &&
+		   !gpio_request_by_name_nodev(np, "cd-gpios", 0, &cd,
+					       GPIOD_IS_IN)) {
+		ret = dm_gpio_get_value(&cd);
+		dm_gpio_free(cd.dev, &cd);
+	} else {
+		return -ENOSYS;
+	}
+
+	return ret < 0 ? -ENOSYS : !!ret;
+}
+
+/**
+ * spl_boot_order_apply_hint() - tries the device which worked last time first
+ * @spl_boot_list:	list of boot devices
+ * @count:		number of entries in @spl_boot_list
+ * @present:		bitmask of the entries which are removable cards that
+ *			are known to be present
+ *
+ * The remembered device is moved ahead of everything except removable cards
+ * which are present, so that inserting a card still boots from it.
+ */
+static void spl_boot_order_apply_hint(u32 *spl_boot_list, int count,
+				      ulong present)
+{
+	u32 hint, boot_device;
+	int i, pos;
+
+	if (!CONFIG_ROCKCHIP_BOOT_HINT_REG)
+		return;
+	hint = readl(CONFIG_ROCKCHIP_BOOT_HINT_REG);
+	if ((hint & ~BOOT_HINT_DEV_MASK) != BOOT_HINT_MAGIC)
+		return;
+	boot_device = hint & BOOT_HINT_DEV_MASK;
+
+	for (i = 0; i < count && spl_boot_list[i] != boot_device; i++)
+		;
+	if (i == count)
+		return;
+	for (pos = i; pos && !(present & BIT(pos - 1)); pos--)
+		;
+	if (pos == i)
+		return;
+
+	debug("%s: trying boot-device %x first\n", __func__, boot_device);
+	memmove(&spl_boot_list[pos + 1], &spl_boot_list[pos],
+		(i - pos) * sizeof(*spl_boot_list));
+	spl_boot_list[pos] = boot_device;
+}
+
 /**
  * board_spl_was_booted_from() - retrieves the of-path the SPL was loaded from
  *
@@ -108,10 +193,12 @@ void board_boot_order(u32 *spl_boot_list)
 
 	const void *blob = gd->fdt_blob;
 	int chosen_node = fdt_path_offset(blob, "/chosen");
+	ulong present = 0;
 	int idx = 0;
 	int elem;
 	int boot_device;
 	int node;
+	int span;
 	const char *conf;
 
 	if (chosen_node < 0) {
@@ -121,6 +208,7 @@ void board_boot_order(u32 *spl_boot_list)
 		return;
 	}
 
+	span = bootstage_span_begin("boot_order", NULL);
 	for (elem = 0;
 	     (conf = fdt_stringlist_get(blob, chosen_node,
 					"u-boot,spl-boot-order", elem, NULL));
@@ -154,11 +242,31 @@ void board_boot_order(u32 *spl_boot_list)
 			continue;
 		}
 
+		/* Don't wait for an empty slot to time out */
+		switch (spl_node_card_present(node)) {
+		case 0:
+			debug("%s: no card in %s\n", __func__, conf);
+			continue;
+		case 1:
+			if (idx < BITS_PER_LONG)
+				present |= BIT(idx);
+			break;
+		}
+
 		spl_boot_list[idx++] = boot_device;
 	}
+	spl_boot_order_apply_hint(spl_boot_list, idx, present);
+	bootstage_span_end(span, 0);
 
 	/* If we had no matches, fall back to spl_boot_device */
 	if (idx == 0)
 		spl_boot_list[0] = spl_boot_device();
 }
 #endif
+
+void board_boot_order_record(u32 boot_device)
+{
+	if (CONFIG_ROCKCHIP_BOOT_HINT_REG)
+		writel(BOOT_HINT_MAGIC | (boot_device & BOOT_HINT_DEV_MASK),
+		       CONFIG_ROCKCHIP_BOOT_HINT_REG);
+}
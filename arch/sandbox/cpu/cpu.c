@@ -11,6 +11,7 @@
 #include <errno.h>
 #include <log.h>
 #include <os.h>
+#include <profile.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
 #include <asm/malloc.h>
@@ -382,6 +383,21 @@ ulong timer_get_boot_us(void)
 	return (count - base_count) / 1000;
 }
 
+#if CONFIG_IS_ENABLED(PROFILE)
+int arch_profile_start(ulong period_us)
+{
+	if (os_profile_start(period_us, profile_sample))
+		return -EIO;
+
+	return 0;
+}
+
+void arch_profile_stop(void)
+{
+	os_profile_stop();
+}
+#endif
+
 int sandbox_load_other_fdt(void **fdtp, int *sizep)
 {
 	const char *orig;
@@ -349,6 +349,63 @@ int os_setup_signal_handlers(void)
 	return 0;
 }
 
+static void (*os_profile_func)(unsigned long pc, unsigned long caller);
+
+static void os_profile_handler(int sig, siginfo_t *info, void *con)
+{
+	ucontext_t __maybe_unused *context = con;
+	unsigned long pc, caller;
+
+#if defined(__x86_64__)
+	pc = context->uc_mcontext.gregs[REG_RIP];
+	caller = 0;	/* only on the stack, if at all */
+#elif defined(__aarch64__)
+	pc = context->uc_mcontext.pc;
+	caller = context->uc_mcontext.regs[30];
+#elif defined(__riscv)
+	pc = context->uc_mcontext.__gregs[REG_PC];
+	caller = context->uc_mcontext.__gregs[REG_RA];
+#else
+	pc = 0;
+	caller = 0;
+#endif
+
+	os_profile_func(pc, caller);
+}
+
+int os_profile_start(unsigned long period_us,
+		     void (*func)(unsigned long pc, unsigned long caller))
+{
+	struct itimerval timer;
+	struct sigaction act;
+
+	os_profile_func = func;
+	act.sa_sigaction = os_profile_handler;
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = SA_SIGINFO | SA_RESTART;
+	if (sigaction(SIGPROF, &act, NULL))
+		return -1;
+
+	timer.it_interval.tv_sec = period_us / 1000000;
+	timer.it_interval.tv_usec = period_us % 1000000;
+	timer.it_value = timer.it_interval;
+	if (setitimer(ITIMER_PROF, &timer, NULL))
+		return -1;
+
+	return 0;
+}
+
+void os_profile_stop(void)
+{
+	struct itimerval timer;
+
+	memset(&timer, '\0', sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+
+	/* The default action would kill us if a signal is still pending */
+	signal(SIGPROF, SIG_IGN);
+}
+
 /* Put tty into raw mode so <tab> and <ctrl+c> work */
 void os_tty_raw(int fd, bool allow_sigs)
 {
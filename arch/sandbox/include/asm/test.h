@@ -150,6 +150,44 @@ int sandbox_pwm_get_config(struct udevice *dev, uint channel, uint *period_nsp,
  */
 void sandbox_sf_set_block_protect(struct udevice *dev, int bp_mask);
 
+/**
+ * struct sandbox_spinand_op - An operation seen by the SPI NAND emulator
+ *
+ * @opcode: Opcode of the operation
+ * @addr: Address sent with the opcode, or 0 if none
+ */
+struct sandbox_spinand_op {
+	u8 opcode;
+	uint addr;
+};
+
+/**
+ * sandbox_spinand_get_ops() - Get the operations seen by a SPI NAND emulator
+ *
+ * @dev: SPI NAND emulator device
+ * @opsp: Returns the operations seen since the log was last cleared. At most
+ *	64 are recorded.
+ * Return: number of operations seen since the log was last cleared
+ */
+int sandbox_spinand_get_ops(struct udevice *dev,
+			    const struct sandbox_spinand_op **opsp);
+
+/**
+ * sandbox_spinand_clear_ops() - Clear the log of operations
+ *
+ * @dev: SPI NAND emulator device
+ */
+void sandbox_spinand_clear_ops(struct udevice *dev);
+
+/**
+ * sandbox_spinand_set_flip_page() - Report corrected bitflips for a page
+ *
+ * @dev: SPI NAND emulator device
+ * @page: Page whose reads report corrected bitflips in the status register,
+ *	or -1 for none
+ */
+void sandbox_spinand_set_flip_page(struct udevice *dev, int page);
+
 /**
  * sandbox_get_codec_params() - Read back codec parameters
  *
@@ -247,6 +285,14 @@ uint sandbox_spi_get_mode(struct udevice *dev);
  */
 int sandbox_get_pch_spi_protect(struct udevice *dev);
 
+/**
+ * sandbox_dma_get_transfers() - Get the number of memory-to-memory transfers
+ *
+ * @dev: Device to check
+ * Return: number of transfers since the device was probed
+ */
+uint sandbox_dma_get_transfers(struct udevice *dev);
+
 /**
  * sandbox_get_pci_ep_irq_count() - Get the PCI EP IRQ count
  *
@@ -16,6 +16,7 @@
 #include <log.h>
 #include <malloc.h>
 #include <part.h>
+#include <slab.h>
 #include <sort.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
@@ -44,7 +45,7 @@ int bootdev_add_bootflow(struct bootflow *bflow)
 	if (ret)
 		return ret;
 
-	new = malloc(sizeof(*bflow));
+	new = slab_alloc(SLAB_CACHE_GET(bootflow));
 	if (!new)
 		return log_msg_ret("bflow", -ENOMEM);
 	memcpy(new, bflow, sizeof(*bflow));
@@ -7,6 +7,7 @@
 #define LOG_CATEGORY UCLASS_BOOTSTD
 
 #include <common.h>
+#include <arena.h>
 #include <bootdev.h>
 #include <bootflow.h>
 #include <bootmeth.h>
@@ -15,6 +16,7 @@
 #include <env_internal.h>
 #include <malloc.h>
 #include <serial.h>
+#include <slab.h>
 #include <dm/device-internal.h>
 #include <dm/uclass-internal.h>
 
@@ -24,6 +26,8 @@ enum {
 	BF_NO_MORE_DEVICES	= -ENODEV,
 };
 
+SLAB_CACHE(bootflow, struct bootflow);
+
 /**
  * bootflow_state - name for each state
  *
@@ -328,15 +332,7 @@ static int iter_incr(struct bootflow_iter *iter)
 	return 0;
 }
 
-/**
- * bootflow_check() - Check if a bootflow can be obtained
- *
- * @iter: Provides part, bootmeth to use
- * @bflow: Bootflow to update on success
- * Return: 0 if OK, -ENOSYS if there is no bootflow support on this device,
- *	BF_NO_MORE_PARTS if there are no more partitions on bootdev
- */
-static int bootflow_check(struct bootflow_iter *iter, struct bootflow *bflow)
+static int _bootflow_check(struct bootflow_iter *iter, struct bootflow *bflow)
 {
 	struct udevice *dev;
 	int ret;
@@ -377,6 +373,28 @@ static int bootflow_check(struct bootflow_iter *iter, struct bootflow *bflow)
 	return 0;
 }
 
+/**
+ * bootflow_check() - Check if a bootflow can be obtained
+ *
+ * Working memory which the filesystems take from the arena is released before
+ * the next attempt
+ *
+ * @iter: Provides part, bootmeth to use
+ * @bflow: Bootflow to update on success
+ * Return: 0 if OK, -ENOSYS if there is no bootflow support on this device,
+ *	BF_NO_MORE_PARTS if there are no more partitions on bootdev
+ */
+static int bootflow_check(struct bootflow_iter *iter, struct bootflow *bflow)
+{
+	int depth, ret;
+
+	depth = arena_push();
+	ret = _bootflow_check(iter, bflow);
+	arena_pop(depth);
+
+	return ret;
+}
+
 int bootflow_scan_first(struct udevice *dev, const char *label,
 			struct bootflow_iter *iter, int flags,
 			struct bootflow *bflow)
@@ -481,7 +499,7 @@ void bootflow_remove(struct bootflow *bflow)
 	list_del(&bflow->glob_node);
 
 	bootflow_free(bflow);
-	free(bflow);
+	slab_free(SLAB_CACHE_GET(bootflow), bflow);
 }
 
 #if CONFIG_IS_ENABLED(BOOTSTD_FULL)
@@ -19,9 +19,11 @@
 #include <malloc.h>
 #include <mapmem.h>
 #include <net.h>
+#include <profile.h>
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
+#include <dm/probe-async.h>
 #include <linux/sizes.h>
 #include <tpm-v2.h>
 #if defined(CONFIG_CMD_USB)
@@ -64,14 +66,22 @@ static void boot_start_lmb(struct bootm_headers *images)
 	lmb_init_and_reserve_range(&images->lmb, (phys_addr_t)mem_start,
 				   mem_size, NULL);
 }
+
+static void boot_stop_lmb(struct bootm_headers *images)
+{
+	lmb_uninit(&images->lmb);
+}
 #else
 #define lmb_reserve(lmb, base, size)
 static inline void boot_start_lmb(struct bootm_headers *images) { }
+static inline void boot_stop_lmb(struct bootm_headers *images) { }
 #endif
 
 static int bootm_start(struct cmd_tbl *cmdtp, int flag, int argc,
 		       char *const argv[])
 {
+	/* drop anything left over from a previous bootm */
+	boot_stop_lmb(&images);
 	memset((void *)&images, 0, sizeof(images));
 	images.verify = env_get_yesno("verify");
 
@@ -486,6 +496,8 @@ ulong bootm_disable_interrupts(void)
 	 * overwrite all exception vector code, so we cannot easily
 	 * recover from any failures any more...
 	 */
+	if (CONFIG_IS_ENABLED(PROFILE))
+		profile_stop();
 	iflag = disable_interrupts();
 #ifdef CONFIG_NETCONSOLE
 	/* Stop the ethernet stack if NetConsole could have left it up */
@@ -858,6 +870,8 @@ int do_bootm_states(struct cmd_tbl *cmdtp, int flag, int argc,
 			ret = CMD_RET_FAILURE;
 			goto err;
 		}
+		/* Devices still probing must settle before the OS takes over */
+		dm_probe_join_all();
 		ret = boot_fn(BOOTM_STATE_OS_PREP, argc, argv, images);
 	}
 
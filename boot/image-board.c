@@ -12,6 +12,7 @@
 #include <bootstage.h>
 #include <cpu_func.h>
 #include <display_options.h>
+#include <dma.h>
 #include <env.h>
 #include <fpga.h>
 #include <image.h>
@@ -173,6 +174,12 @@ void memmove_wd(void *to, void *from, size_t len, ulong chunksz)
 	if (to == from)
 		return;
 
+	/* The DMA driver looks after the watchdog while it waits */
+	if (IS_ENABLED(CONFIG_DMA_MEMCPY_OFFLOAD) &&
+	    (to + len <= from || from + len <= to) &&
+	    !dma_memcpy_large(to, from, len))
+		return;
+
 	if (IS_ENABLED(CONFIG_HW_WATCHDOG) || IS_ENABLED(CONFIG_WATCHDOG)) {
 		if (to > from) {
 			from += len;
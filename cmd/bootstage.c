@@ -6,6 +6,9 @@
 #include <common.h>
 #include <bootstage.h>
 #include <command.h>
+#include <env.h>
+#include <malloc.h>
+#include <mapmem.h>
 
 static int do_bootstage_report(struct cmd_tbl *cmdtp, int flag, int argc,
 			       char *const argv[])
@@ -59,10 +62,51 @@ static int do_bootstage_stash(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+static int do_bootstage_export(struct cmd_tbl *cmdtp, int flag, int argc,
+			       char *const argv[])
+{
+	ulong base, size;
+	char *buf;
+	int len;
+
+	if (argc == 2)
+		return CMD_RET_USAGE;
+
+	/* With no address, write to the console */
+	if (argc < 2) {
+		len = bootstage_export(NULL, 0);
+		buf = malloc(len + 1);
+		if (!buf) {
+			printf("Out of memory\n");
+			return CMD_RET_FAILURE;
+		}
+		bootstage_export(buf, len + 1);
+		puts(buf);
+		putc('\n');
+		free(buf);
+
+		return 0;
+	}
+
+	if (get_base_size(argc, argv, &base, &size))
+		return CMD_RET_USAGE;
+	buf = map_sysmem(base, size);
+	len = bootstage_export(buf, size);
+	unmap_sysmem(buf);
+	if (len >= size) {
+		printf("Error: truncated (%#x bytes needed)\n", len + 1);
+		return CMD_RET_FAILURE;
+	}
+	env_set_hex("filesize", len);
+
+	return 0;
+}
+
 static struct cmd_tbl cmd_bootstage_sub[] = {
 	U_BOOT_CMD_MKENT(report, 2, 1, do_bootstage_report, "", ""),
 	U_BOOT_CMD_MKENT(stash, 4, 0, do_bootstage_stash, "", ""),
 	U_BOOT_CMD_MKENT(unstash, 4, 0, do_bootstage_stash, "", ""),
+	U_BOOT_CMD_MKENT(export, 3, 0, do_bootstage_export, "", ""),
 };
 
 /*
@@ -92,5 +136,6 @@ U_BOOT_CMD(bootstage, 4, 1, do_boostage,
 	" - check boot progress and timing\n"
 	"report                      - Print a report\n"
 	"stash [<start> [<size>]]    - Stash data into memory\n"
-	"unstash [<start> [<size>]]  - Unstash data from memory"
+	"unstash [<start> [<size>]]  - Unstash data from memory\n"
+	"export [<start> <size>]     - Export as Chrome trace-event JSON"
 );
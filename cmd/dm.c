@@ -19,6 +19,16 @@ static int do_dm_dump_driver_compat(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(DM_PROBE_ASYNC)
+static int do_dm_dump_deps(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	dm_dump_probe_deps();
+
+	return 0;
+}
+#endif /* DM_PROBE_ASYNC */
+
 static int do_dm_dump_devres(struct cmd_tbl *cmdtp, int flag, int argc,
 			     char *const argv[])
 {
@@ -48,6 +58,23 @@ static int do_dm_dump_mem(struct cmd_tbl *cmdtp, int flag, int argc,
 }
 #endif /* DM_STATS */
 
+#if CONFIG_IS_ENABLED(DM_DEVICE_STATS)
+static int do_dm_dump_stats(struct cmd_tbl *cmdtp, int flag, int argc,
+			    char *const argv[])
+{
+	bool sort = false;
+
+	if (argc > 1) {
+		if (strcmp(argv[1], "-s"))
+			return CMD_RET_USAGE;
+		sort = true;
+	}
+	dm_dump_stats(sort);
+
+	return 0;
+}
+#endif /* DM_DEVICE_STATS */
+
 static int do_dm_dump_static_driver_info(struct cmd_tbl *cmdtp, int flag,
 					 int argc, char * const argv[])
 {
@@ -59,7 +86,7 @@ static int do_dm_dump_static_driver_info(struct cmd_tbl *cmdtp, int flag,
 static int do_dm_dump_tree(struct cmd_tbl *cmdtp, int flag, int argc,
 			   char *const argv[])
 {
-	bool extended = false, sort = false;
+	bool extended = false, sort = false, show_time = false;
 	char *device = NULL;
 
 	for (; argc > 1; argc--, argv++) {
@@ -70,6 +97,9 @@ static int do_dm_dump_tree(struct cmd_tbl *cmdtp, int flag, int argc,
 			extended = true;
 		} else if (!strcmp(argv[1], "-s")) {
 			sort = true;
+		} else if (CONFIG_IS_ENABLED(DM_PROBE_TIME) &&
+			   !strcmp(argv[1], "-t")) {
+			show_time = true;
 		} else {
 			printf("Unknown parameter: %s\n", argv[1]);
 			return 0;
@@ -78,7 +108,7 @@ static int do_dm_dump_tree(struct cmd_tbl *cmdtp, int flag, int argc,
 	if (argc > 1)
 		device = argv[1];
 
-	dm_dump_tree(device, extended, sort);
+	dm_dump_tree(device, extended, sort, show_time);
 
 	return 0;
 }
@@ -104,6 +134,29 @@ static int do_dm_dump_uclass(struct cmd_tbl *cmdtp, int flag, int argc,
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(DM_PROBE_ASYNC)
+#define DM_DEPS_HELP	"dm deps          Dump devices needed by each device's probe\n"
+#define DM_DEPS		U_BOOT_SUBCMD_MKENT(deps, 1, 1, do_dm_dump_deps),
+#else
+#define DM_DEPS_HELP
+#define DM_DEPS
+#endif
+
+#if CONFIG_IS_ENABLED(DM_DEVICE_STATS)
+#define DM_DEV_STATS_HELP	"dm stats [-s]    Dump probe time and memory usage of each device (-s=sort)\n"
+#define DM_DEV_STATS	U_BOOT_SUBCMD_MKENT(stats, 2, 1, do_dm_dump_stats),
+#else
+#define DM_DEV_STATS_HELP
+#define DM_DEV_STATS
+#endif
+
+#if CONFIG_IS_ENABLED(DM_PROBE_TIME)
+#define DM_TREE_HELP	"dm tree [-s][-e][-t][name]   Dump tree of driver model devices (-s=sort,\n" \
+			"                             -t=show probe time)\n"
+#else
+#define DM_TREE_HELP	"dm tree [-s][-e][name]   Dump tree of driver model devices (-s=sort)\n"
+#endif
+
 #if CONFIG_IS_ENABLED(DM_STATS)
 #define DM_MEM_HELP	"dm mem           Provide a summary of memory usage\n"
 #define DM_MEM		U_BOOT_SUBCMD_MKENT(mem, 1, 1, do_dm_dump_mem),
@@ -114,18 +167,22 @@ static int do_dm_dump_uclass(struct cmd_tbl *cmdtp, int flag, int argc,
 
 U_BOOT_LONGHELP(dm,
 	"compat        Dump list of drivers with compatibility strings\n"
+	DM_DEPS_HELP
 	"dm devres        Dump list of device resources for each device\n"
 	"dm drivers       Dump list of drivers with uclass and instances\n"
 	DM_MEM_HELP
 	"dm static        Dump list of drivers with static platform data\n"
-	"dm tree [-s][-e][name]   Dump tree of driver model devices (-s=sort)\n"
+	DM_DEV_STATS_HELP
+	DM_TREE_HELP
 	"dm uclass [-e][name]     Dump list of instances for each uclass");
 
 U_BOOT_CMD_WITH_SUBCMDS(dm, "Driver model low level access", dm_help_text,
 	U_BOOT_SUBCMD_MKENT(compat, 1, 1, do_dm_dump_driver_compat),
+	DM_DEPS
 	U_BOOT_SUBCMD_MKENT(devres, 1, 1, do_dm_dump_devres),
 	U_BOOT_SUBCMD_MKENT(drivers, 1, 1, do_dm_dump_drivers),
 	DM_MEM
 	U_BOOT_SUBCMD_MKENT(static, 1, 1, do_dm_dump_static_driver_info),
-	U_BOOT_SUBCMD_MKENT(tree, 4, 1, do_dm_dump_tree),
+	DM_DEV_STATS
+	U_BOOT_SUBCMD_MKENT(tree, 5, 1, do_dm_dump_tree),
 	U_BOOT_SUBCMD_MKENT(uclass, 3, 1, do_dm_dump_uclass));
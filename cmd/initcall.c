@@ -0,0 +1,22 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Command-line access to initcall timing
+ */
+
+#include <common.h>
+#include <command.h>
+#include <initcall.h>
+
+static int do_initcall_stats(struct cmd_tbl *cmdtp, int flag, int argc,
+			     char *const argv[])
+{
+	initcall_show_stats();
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(initcall,
+	"stats - show the time taken by each initcall, slowest first");
+
+U_BOOT_CMD_WITH_SUBCMDS(initcall, "Initcalls", initcall_help_text,
+	U_BOOT_SUBCMD_MKENT(stats, 1, 1, do_initcall_stats));
@@ -153,6 +153,7 @@ static ulong load_serial(long offset)
 	ulong	start_addr = ~0;
 	ulong	end_addr   =  0;
 	int	line_count =  0;
+	ulong	rcode = ~0;
 	long ret;
 
 	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
@@ -160,9 +161,8 @@ static ulong load_serial(long offset)
 	while (read_record(record, SREC_MAXRECLEN + 1) >= 0) {
 		type = srec_decode(record, &binlen, &addr, binbuf);
 
-		if (type < 0) {
-			return (~0);		/* Invalid S-Record		*/
-		}
+		if (type < 0)
+			goto out;		/* Invalid S-Record		*/
 
 		switch (type) {
 		case SREC_DATA2:
@@ -176,7 +176,7 @@ static ulong load_serial(long offset)
 			rc = flash_write((char *)binbuf,store_addr,binlen);
 			if (rc != 0) {
 				flash_perror(rc);
-				return (~0);
+				goto out;
 			}
 		    } else
 #endif
@@ -187,7 +187,8 @@ static ulong load_serial(long offset)
 			if (ret) {
 				printf("\nCannot overwrite reserved area (%08lx..%08lx)\n",
 					store_addr, store_addr + binlen);
-				return ret;
+				rcode = ret;
+				goto out;
 			}
 			dst = map_sysmem(store_addr, binlen);
 			memcpy(dst, binbuf, binlen);
@@ -212,7 +213,8 @@ static ulong load_serial(long offset)
 		    );
 		    flush_cache(start_addr, size);
 		    env_set_hex("filesize", size);
-		    return (addr);
+		    rcode = addr;
+		    goto out;
 		case SREC_START:
 		    break;
 		default:
@@ -223,8 +225,11 @@ static ulong load_serial(long offset)
 				putc('.');
 		}
 	}
+	/* Download aborted */
+out:
+	lmb_uninit(&lmb);
 
-	return (~0);			/* Download aborted		*/
+	return rcode;
 }
 
 static int read_record(char *buf, ulong len)
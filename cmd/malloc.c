@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Show information about malloc()
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc_profile.h>
+#include <vsprintf.h>
+
+static int do_malloc_dump(struct cmd_tbl *cmdtp, int flag, int argc,
+			  char *const argv[])
+{
+	uint count = 20;
+
+	if (argc > 1)
+		count = dectoul(argv[1], NULL);
+	malloc_profile_dump(count);
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(malloc,
+	"dump [n] - show the n callers holding the most memory at their peak\n"
+	"    (default 20). Callers are link-time addresses, so can be passed\n"
+	"    to 'addr2line -e u-boot'");
+
+U_BOOT_CMD_WITH_SUBCMDS(malloc, "Show information about malloc()",
+			malloc_help_text,
+	U_BOOT_SUBCMD_MKENT(dump, 2, 1, do_malloc_dump));
@@ -11,12 +11,14 @@
  */
 
 #include <common.h>
+#include <arena.h>
 #include <console.h>
 #include <bootretry.h>
 #include <cli.h>
 #include <command.h>
 #include <console.h>
 #include <display_options.h>
+#include <dma.h>
 #ifdef CONFIG_MTD_NOR_FLASH
 #include <flash.h>
 #endif
@@ -24,6 +26,7 @@
 #include <log.h>
 #include <mapmem.h>
 #include <rand.h>
+#include <slab.h>
 #include <watchdog.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
@@ -361,7 +364,8 @@ static int do_mem_cp(struct cmd_tbl *cmdtp, int flag, int argc,
 	}
 #endif
 
-	memcpy(dst, src, count * size);
+	if (dma_memcpy_large(dst, src, count * size))
+		memcpy(dst, src, count * size);
 
 	unmap_sysmem(src);
 	unmap_sysmem(dst);
@@ -1384,11 +1388,74 @@ U_BOOT_CMD(
 #endif
 
 #ifdef CONFIG_CMD_MEMINFO
+static void show_heap(void)
+{
+	struct malloc_info info;
+	ulong avail;
+
+	malloc_get_info(&info);
+	avail = info.size - info.in_use;
+	puts("Heap:  ");
+	print_size(info.size, "");
+	printf(" at %lx\n", mem_malloc_start);
+	puts("       in use ");
+	print_size(info.in_use, ", peak ");
+	print_size(info.peak, "\n");
+	puts("       free ");
+	print_size(avail, "");
+	printf(" in %u blocks, largest ", info.free_blocks);
+	print_size(info.largest_free, "");
+	printf(" (%lu%% fragmented)\n",
+	       avail ? (avail - info.largest_free) * 100 / avail : 0);
+}
+
+static void show_arena(void)
+{
+	struct arena_stats stats;
+
+	arena_get_stats(&stats);
+	printf("Arena: %u chunks, ", stats.chunks);
+	print_size(stats.size, ", peak ");
+	print_size(stats.peak, "\n");
+}
+
+static void show_slab(void)
+{
+	struct slab_cache *start = ll_entry_start(struct slab_cache,
+						  slab_cache);
+	const int count = ll_entry_count(struct slab_cache, slab_cache);
+	struct slab_cache *cache;
+	long saved = 0;
+	ulong heap = 0;
+	uint pages = 0;
+
+	puts("Slab:  name          size  used  peak  pages   saved\n");
+	for (cache = start; cache != start + count; cache++) {
+		long diff = slab_malloc_size(cache) - slab_heap_size(cache);
+
+		printf("       %-12s %5u %5u %5u %6u %7ld\n", cache->name,
+		       cache->size, cache->live, cache->peak, cache->pages,
+		       diff);
+		pages += cache->pages;
+		heap += slab_heap_size(cache);
+		saved += diff;
+	}
+	printf("       total %u pages, ", pages);
+	print_size(heap, "");
+	printf(", saved %ld bytes\n", saved);
+}
+
 static int do_mem_info(struct cmd_tbl *cmdtp, int flag, int argc,
 		       char *const argv[])
 {
 	puts("DRAM:  ");
 	print_size(gd->ram_size, "\n");
+	if (gd->flags & GD_FLG_FULL_MALLOC_INIT)
+		show_heap();
+	if (CONFIG_IS_ENABLED(ARENA))
+		show_arena();
+	if (CONFIG_IS_ENABLED(SLAB) && (gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		show_slab();
 
 	return 0;
 }
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Command-line access to the sampling profiler
+ */
+
+#include <common.h>
+#include <command.h>
+#include <env.h>
+#include <mapmem.h>
+#include <profile.h>
+#include <vsprintf.h>
+
+/* Number of addresses shown by 'profile show' by default */
+#define PROFILE_SHOW_DEFAULT	20
+
+static int do_profile_start(struct cmd_tbl *cmdtp, int flag, int argc,
+			    char *const argv[])
+{
+	ulong period_us = CONFIG_PROFILE_PERIOD_US;
+	int ret;
+
+	if (argc > 1)
+		period_us = dectoul(argv[1], NULL);
+	if (!period_us)
+		return CMD_RET_USAGE;
+
+	ret = profile_start(period_us);
+	if (ret) {
+		printf("Cannot start profiler (err=%d)\n", ret);
+		return CMD_RET_FAILURE;
+	}
+
+	return 0;
+}
+
+static int do_profile_stop(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	profile_stop();
+
+	return 0;
+}
+
+static int do_profile_show(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	uint max = PROFILE_SHOW_DEFAULT;
+
+	if (argc > 1)
+		max = dectoul(argv[1], NULL);
+	profile_show(max);
+
+	return 0;
+}
+
+/* This uses the same environment variables as 'trace calls' */
+static int do_profile_save(struct cmd_tbl *cmdtp, int flag, int argc,
+			   char *const argv[])
+{
+	size_t buff_size, avail, buff_ptr, needed, used;
+	char *buff;
+	int ret;
+
+	if (argc == 2)
+		return CMD_RET_USAGE;
+	if (argc < 3) {
+		buff_size = env_get_ulong("profsize", 16, 0);
+		buff = map_sysmem(env_get_ulong("profbase", 16, 0), buff_size);
+		buff_ptr = env_get_ulong("profoffset", 16, 0);
+	} else {
+		buff_size = hextoul(argv[2], NULL);
+		buff = map_sysmem(hextoul(argv[1], NULL), buff_size);
+		buff_ptr = 0;
+	}
+	if (buff_ptr > buff_size)
+		return CMD_RET_USAGE;
+
+	avail = buff_size - buff_ptr;
+	ret = profile_list_samples(buff + buff_ptr, avail, &needed);
+	if (ret)
+		printf("Error: truncated (%#zx bytes needed)\n", needed);
+	used = min(avail, needed);
+	printf("Samples dumped to %08lx, size %#zx\n",
+	       (ulong)map_to_sysmem(buff + buff_ptr), used);
+
+	env_set_hex("profbase", map_to_sysmem(buff));
+	env_set_hex("profsize", buff_size);
+	env_set_hex("profoffset", buff_ptr + used);
+	unmap_sysmem(buff);
+
+	return 0;
+}
+
+U_BOOT_LONGHELP(profile,
+	"start [<period_us>]  - start taking samples\n"
+	"profile stop                 - stop taking samples\n"
+	"profile show [<count>]       - show where most samples were taken\n"
+	"profile save [<addr> <size>] - write samples to memory for proftool");
+
+U_BOOT_CMD_WITH_SUBCMDS(profile, "Sampling profiler", profile_help_text,
+	U_BOOT_SUBCMD_MKENT(start, 2, 1, do_profile_start),
+	U_BOOT_SUBCMD_MKENT(stop, 1, 1, do_profile_stop),
+	U_BOOT_SUBCMD_MKENT(show, 2, 1, do_profile_show),
+	U_BOOT_SUBCMD_MKENT(save, 3, 1, do_profile_save));
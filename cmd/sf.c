@@ -17,7 +17,9 @@
 #include <spi_flash.h>
 #include <asm/cache.h>
 #include <jffs2/jffs2.h>
+#include <linux/math64.h>
 #include <linux/mtd/mtd.h>
+#include <linux/sizes.h>
 
 #include <asm/io.h>
 #include <dm/device-internal.h>
@@ -442,7 +444,7 @@ static void show_time(struct test_info *test, int stage)
 
 	speed = (long long)test->bytes * 1000;
 	if (test->time_ms[stage])
-		do_div(speed, test->time_ms[stage] * 1024);
+		speed = div64_u64(speed, (uint64_t)test->time_ms[stage] * 1024);
 	bps = speed * 8;
 
 	printf("%d %s: %u ticks, %d KiB/s %d.%03d Mbps\n", stage,
@@ -576,6 +578,66 @@ static int do_spi_flash_test(int argc, char *const argv[])
 	return 0;
 }
 
+static int do_spi_flash_bench(int argc, char *const argv[])
+{
+	enum spi_nor_protocol proto = flash->read_proto;
+	unsigned long offset, len, count = 1;
+	unsigned long start, us;
+	uint64_t bytes, speed;	/* bytes/s */
+	uint8_t *buf;
+	char *endp;
+	int i, ret = 0;
+
+	if (argc < 3)
+		return -1;
+	offset = hextoul(argv[1], &endp);
+	if (*argv[1] == 0 || *endp != 0)
+		return -1;
+	len = hextoul(argv[2], &endp);
+	if (*argv[2] == 0 || *endp != 0 || !len)
+		return -1;
+	if (argc > 3) {
+		count = dectoul(argv[3], &endp);
+		if (*argv[3] == 0 || *endp != 0 || !count)
+			return -1;
+	}
+
+	if (offset + len > flash->size) {
+		puts("ERROR: attempting read past flash size\n");
+		return 1;
+	}
+
+	buf = memalign(ARCH_DMA_MINALIGN, len);
+	if (!buf) {
+		printf("Cannot allocate memory (%lu bytes)\n", len);
+		return 1;
+	}
+
+	start = timer_get_us();
+	for (i = 0; i < count; i++) {
+		ret = spi_flash_read(flash, offset, len, buf);
+		if (ret) {
+			printf("Read failed (err = %d)\n", ret);
+			break;
+		}
+	}
+	us = timer_get_us() - start;
+	free(buf);
+	if (ret)
+		return 1;
+
+	bytes = (uint64_t)len * count;
+	speed = div64_u64(bytes * 1000000, max(us, 1UL));
+	printf("SF: read %llu bytes in %lu us, %llu.%02llu MiB/s (%d-%d-%d%s)\n",
+	       bytes, us, speed >> 20, ((speed & (SZ_1M - 1)) * 100) >> 20,
+	       spi_nor_get_protocol_inst_nbits(proto),
+	       spi_nor_get_protocol_addr_nbits(proto),
+	       spi_nor_get_protocol_data_nbits(proto),
+	       spi_nor_protocol_is_dtr(proto) ? " DTR" : "");
+
+	return 0;
+}
+
 static int do_spi_flash(struct cmd_tbl *cmdtp, int flag, int argc,
 			char *const argv[])
 {
@@ -608,6 +670,8 @@ static int do_spi_flash(struct cmd_tbl *cmdtp, int flag, int argc,
 		ret = do_spi_protect(argc, argv);
 	else if (IS_ENABLED(CONFIG_CMD_SF_TEST) && !strcmp(cmd, "test"))
 		ret = do_spi_flash_test(argc, argv);
+	else if (IS_ENABLED(CONFIG_CMD_SF_BENCH) && !strcmp(cmd, "bench"))
+		ret = do_spi_flash_bench(argc, argv);
 	else
 		ret = CMD_RET_USAGE;
 
@@ -635,6 +699,10 @@ U_BOOT_LONGHELP(sf,
 #endif
 #ifdef CONFIG_CMD_SF_TEST
 	"\nsf test offset len		- run a very basic destructive test"
+#endif
+#ifdef CONFIG_CMD_SF_BENCH
+	"\nsf bench offset len [count]	- measure read throughput of `len' bytes\n"
+	"					  at `offset', `count' times"
 #endif
 	);
 
@@ -73,6 +73,15 @@ static void display_ubi_info(struct ubi_device *ubi)
 	ubi_msg("number of PEBs reserved for bad PEB handling: %d",
 			ubi->beb_rsvd_pebs);
 	ubi_msg("max/mean erase counter: %d/%d", ubi->max_ec, ubi->mean_ec);
+	ubi_msg("attached from:              %s",
+		ubi->attach_stats.fastmap ? "fastmap" : "scan");
+	ubi_msg("number of scanned PEBs:     %d",
+		ubi->attach_stats.scanned_pebs);
+	ubi_msg("attach time:                %lu us", ubi->attach_stats.total_us);
+	ubi_msg("  scan/fastmap:             %lu us", ubi->attach_stats.scan_us);
+	ubi_msg("  volume table:             %lu us", ubi->attach_stats.vtbl_us);
+	ubi_msg("  wear-leveling:            %lu us", ubi->attach_stats.wl_us);
+	ubi_msg("  EBA:                      %lu us", ubi->attach_stats.eba_us);
 }
 
 static int ubi_info(int layout)
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Scoped arena for short-lived allocations
+ *
+ * The arena is a stack of chunks obtained from malloc(). Allocations are taken
+ * from the end of the top chunk, and a scope records where the top was when it
+ * was pushed, so popping it just frees any newer chunks and winds back the
+ * top. When the last scope is popped, all chunks are freed, leaving the heap
+ * as it was.
+ *
+ * Within a scope, freeing the most recent allocation gives its space back, so
+ * code which allocates and frees a buffer in each call, such as the FAT
+ * iterator, does not use up the scope when it is called many times.
+ */
+
+#define LOG_CATEGORY	LOGC_ALLOC
+
+#include <common.h>
+#include <arena.h>
+#include <log.h>
+#include <malloc.h>
+#include <asm/cache.h>
+#include <asm/global_data.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct arena_chunk - A chunk of memory to allocate from
+ *
+ * The memory for allocations follows this header, at ARENA_HDR_SIZE
+ *
+ * @prev: Previous chunk, or NULL if none
+ * @size: Number of bytes available for allocations
+ * @used: Number of bytes allocated
+ * @last: Offset of the most recent allocation, or @used if it has been freed
+ */
+struct arena_chunk {
+	struct arena_chunk *prev;
+	ulong size;
+	ulong used;
+	ulong last;
+};
+
+#define ARENA_HDR_SIZE	ALIGN(sizeof(struct arena_chunk), ARCH_DMA_MINALIGN)
+
+/**
+ * struct arena_mark - Position of the arena when a scope was pushed
+ *
+ * @chunk: Top chunk, or NULL if none
+ * @used: Value of @chunk->used
+ */
+struct arena_mark {
+	struct arena_chunk *chunk;
+	ulong used;
+};
+
+/**
+ * struct arena_state - State of the arena
+ *
+ * @top: Chunk being allocated from, or NULL if none
+ * @marks: Position of the arena at the start of each scope
+ * @depth: Number of scopes pushed
+ * @chunks: Number of chunks held
+ * @size: Total size of the chunks
+ * @peak: Largest value of @size so far
+ */
+struct arena_state {
+	struct arena_chunk *top;
+	struct arena_mark marks[CONFIG_ARENA_DEPTH];
+	uint depth;
+	uint chunks;
+	ulong size;
+	ulong peak;
+};
+
+static struct arena_state arena;
+
+static inline void *arena_chunk_data(struct arena_chunk *chunk)
+{
+	return (void *)chunk + ARENA_HDR_SIZE;
+}
+
+static void arena_free_chunk(void)
+{
+	struct arena_chunk *chunk = arena.top;
+
+	arena.top = chunk->prev;
+	arena.chunks--;
+	arena.size -= chunk->size;
+	free(chunk);
+}
+
+int arena_push(void)
+{
+	struct arena_mark *mark;
+
+	/* The arena's state is in BSS, so only use it after relocation */
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return -EAGAIN;
+	if (arena.depth == CONFIG_ARENA_DEPTH)
+		return -ENOSPC;
+
+	mark = &arena.marks[arena.depth++];
+	mark->chunk = arena.top;
+	mark->used = arena.top ? arena.top->used : 0;
+
+	return arena.depth;
+}
+
+void arena_pop(int depth)
+{
+	struct arena_mark *mark;
+
+	if (depth <= 0 || depth > arena.depth)
+		return;
+
+	mark = &arena.marks[depth - 1];
+	while (arena.top != mark->chunk)
+		arena_free_chunk();
+	if (arena.top) {
+		arena.top->used = mark->used;
+		arena.top->last = mark->used;
+	}
+	arena.depth = depth - 1;
+}
+
+static struct arena_chunk *arena_new_chunk(size_t size)
+{
+	struct arena_chunk *chunk;
+
+	size = max(size, (size_t)CONFIG_ARENA_CHUNK_SIZE);
+	chunk = memalign(ARCH_DMA_MINALIGN, ARENA_HDR_SIZE + size);
+	if (!chunk)
+		return NULL;
+	chunk->prev = arena.top;
+	chunk->size = size;
+	chunk->used = 0;
+	chunk->last = 0;
+
+	arena.top = chunk;
+	arena.chunks++;
+	arena.size += size;
+	arena.peak = max(arena.peak, arena.size);
+	log_debug("New chunk %p size %zx, total %lx\n", chunk, size,
+		  arena.size);
+
+	return chunk;
+}
+
+void *arena_alloc(size_t size)
+{
+	struct arena_chunk *chunk = arena.top;
+	void *ptr;
+
+	if (!arena.depth)
+		return malloc_cache_aligned(size);
+
+	size = ALIGN(size, ARCH_DMA_MINALIGN);
+	if (!chunk || chunk->size - chunk->used < size) {
+		chunk = arena_new_chunk(size);
+		if (!chunk)
+			return NULL;
+	}
+	ptr = arena_chunk_data(chunk) + chunk->used;
+	chunk->last = chunk->used;
+	chunk->used += size;
+
+	return ptr;
+}
+
+void arena_free(void *ptr)
+{
+	struct arena_chunk *chunk = arena.top;
+	struct arena_mark *mark;
+
+	if (!ptr)
+		return;
+
+	/*
+	 * Give back the most recent allocation, unless it belongs to a scope
+	 * outside the current one. A chunk left empty is freed, unless the
+	 * current scope started inside it.
+	 */
+	if (chunk && arena.depth &&
+	    ptr == arena_chunk_data(chunk) + chunk->last &&
+	    chunk->last != chunk->used) {
+		mark = &arena.marks[arena.depth - 1];
+		if (chunk == mark->chunk && chunk->last < mark->used)
+			return;
+		chunk->used = chunk->last;
+		if (!chunk->used && chunk != mark->chunk)
+			arena_free_chunk();
+		return;
+	}
+	for (chunk = arena.top; chunk; chunk = chunk->prev) {
+		if (ptr >= arena_chunk_data(chunk) &&
+		    ptr < arena_chunk_data(chunk) + chunk->size)
+			return;
+	}
+	free(ptr);
+}
+
+void arena_get_stats(struct arena_stats *stats)
+{
+	struct arena_chunk *chunk;
+
+	stats->depth = arena.depth;
+	stats->chunks = arena.chunks;
+	stats->size = arena.size;
+	stats->peak = arena.peak;
+	stats->used = 0;
+	for (chunk = arena.top; chunk; chunk = chunk->prev)
+		stats->used += chunk->used;
+}
@@ -585,6 +585,20 @@ static int reserve_stacks(void)
 	return arch_reserve_stacks();
 }
 
+static int reserve_initcall_stats(void)
+{
+#if CONFIG_IS_ENABLED(INITCALL_STATS)
+	int size = initcall_stats_size();
+
+	gd->start_addr_sp = reserve_stack_aligned(size);
+	gd->new_initcall_stats = map_sysmem(gd->start_addr_sp, size);
+	debug("Reserving %#x Bytes for initcall stats at: %08lx\n", size,
+	      gd->start_addr_sp);
+#endif
+
+	return 0;
+}
+
 static int reserve_bloblist(void)
 {
 #ifdef CONFIG_BLOBLIST
@@ -664,6 +678,25 @@ static int reloc_bootstage(void)
 	return 0;
 }
 
+static int reloc_initcall_stats(void)
+{
+#if CONFIG_IS_ENABLED(INITCALL_STATS)
+	if (gd->flags & GD_FLG_SKIP_RELOC)
+		return 0;
+	if (gd->new_initcall_stats) {
+		int size = initcall_stats_size();
+
+		if (gd->initcall_stats)
+			memcpy(gd->new_initcall_stats, gd->initcall_stats, size);
+		else
+			memset(gd->new_initcall_stats, '\0', size);
+		gd->initcall_stats = gd->new_initcall_stats;
+	}
+#endif
+
+	return 0;
+}
+
 static int reloc_bloblist(void)
 {
 #ifdef CONFIG_BLOBLIST
@@ -914,7 +947,10 @@ static const init_fnc_t init_sequence_f[] = {
 	 *  - LCD framebuffer
 	 *  - monitor code
 	 *  - board info struct
+	 *
+	 * Finish any work that initcalls have deferred before we start.
 	 */
+	INITCALL_SYNC,
 	setup_dest_addr,
 #ifdef CONFIG_OF_BOARD_FIXUP
 	fix_fdt,
@@ -932,6 +968,7 @@ static const init_fnc_t init_sequence_f[] = {
 	reserve_global_data,
 	reserve_fdt,
 	reserve_bootstage,
+	reserve_initcall_stats,
 	reserve_bloblist,
 	reserve_arch,
 	reserve_stacks,
@@ -943,6 +980,7 @@ static const init_fnc_t init_sequence_f[] = {
 	INIT_FUNC_WATCHDOG_RESET
 	reloc_fdt,
 	reloc_bootstage,
+	reloc_initcall_stats,
 	reloc_bloblist,
 	setup_reloc,
 #if defined(CONFIG_X86) || defined(CONFIG_ARC)
@@ -47,6 +47,7 @@
 #include <nand.h>
 #include <of_live.h>
 #include <onenand_uboot.h>
+#include <profile.h>
 #include <pvblock.h>
 #include <scsi.h>
 #include <serial.h>
@@ -233,6 +234,8 @@ static int initr_dm(void)
 	/* Save the pre-reloc driver model and start a new one */
 	gd->dm_root_f = gd->dm_root;
 	gd->dm_root = NULL;
+	/* The index lives in the pre-relocation malloc() area */
+	gd_set_dm_compat_index(NULL);
 #ifdef CONFIG_TIMER
 	gd->timer = NULL;
 #endif
@@ -277,6 +280,20 @@ static int initr_bootstage(void)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(PROFILE_BOOT)
+static int initr_profile(void)
+{
+	int ret;
+
+	/* Not being able to profile is no reason to stop booting */
+	ret = profile_start(CONFIG_PROFILE_PERIOD_US);
+	if (ret)
+		log_warning("Cannot start profiler (err=%dE)\n", ret);
+
+	return 0;
+}
+#endif
+
 __weak int power_init_board(void)
 {
 	return 0;
@@ -554,6 +571,13 @@ static int dm_announce(void)
 
 static int run_main_loop(void)
 {
+	int ret;
+
+	/* This does not return, so the initcall list cannot finish the work */
+	ret = initcall_finish();
+	if (ret)
+		return ret;
+
 #ifdef CONFIG_SANDBOX
 	sandbox_main_loop_init();
 #endif
@@ -597,6 +621,9 @@ static init_fnc_t init_sequence_r[] = {
 	initr_malloc,
 	log_init,
 	initr_bootstage,	/* Needs malloc() but has its own timer */
+#if CONFIG_IS_ENABLED(PROFILE_BOOT)
+	initr_profile,
+#endif
 #if defined(CONFIG_CONSOLE_RECORD)
 	console_record_init,
 #endif
@@ -782,6 +809,9 @@ void board_init_r(gd_t *new_gd, ulong dest_addr)
 #endif
 	gd->flags &= ~GD_FLG_LOG_READY;
 
+	/* The pre-relocation init sequence is not running any more */
+	gd_set_initcall_run(NULL);
+
 	if (initcall_run_list(init_sequence_r))
 		hang();
 
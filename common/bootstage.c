@@ -18,6 +18,7 @@
 #include <malloc.h>
 #include <sort.h>
 #include <spl.h>
+#include <vsprintf.h>
 #include <asm/global_data.h>
 #include <linux/compiler.h>
 #include <linux/libfdt.h>
@@ -26,6 +27,9 @@ DECLARE_GLOBAL_DATA_PTR;
 
 enum {
 	RECORD_COUNT = CONFIG_VAL(BOOTSTAGE_RECORD_COUNT),
+#ifdef ENABLE_BOOTSTAGE_SPANS
+	SPAN_COUNT = CONFIG_VAL(BOOTSTAGE_SPAN_COUNT),
+#endif
 };
 
 struct bootstage_record {
@@ -36,14 +40,49 @@ struct bootstage_record {
 	enum bootstage_id id;
 };
 
+/**
+ * struct bootstage_span - A span of time, which may contain other spans
+ *
+ * @start_us: Time the span started, in microseconds
+ * @end_us: Time the span ended, if @ended is true
+ * @bytes: Number of bytes transferred, or 0 if not relevant
+ * @name: Name of the span
+ * @dev_name: Name of the device used, or NULL if none
+ * @id: ID returned by bootstage_span_begin(), or -1 if passed on from an
+ *	earlier phase
+ * @parent: Index of the span containing this one, or -1 if none
+ * @depth: Nesting depth, 0 for a span with no parent
+ * @phase: Phase of U-Boot in which the span was recorded (enum u_boot_phase)
+ * @ended: true if bootstage_span_end() has been called
+ */
+struct bootstage_span {
+	u32 start_us;
+	u32 end_us;
+	u64 bytes;
+	const char *name;
+	const char *dev_name;
+	int id;
+	s16 parent;
+	u8 depth;
+	u8 phase;
+	bool ended;
+};
+
 struct bootstage_data {
 	uint rec_count;
 	uint next_id;
 	struct bootstage_record record[RECORD_COUNT];
+#ifdef ENABLE_BOOTSTAGE_SPANS
+	uint span_count;
+	uint span_dropped;	/* Number of spans with no space, or recycled */
+	int cur_span;		/* Innermost span not yet ended, or -1 */
+	int next_span_id;	/* ID for the next span */
+	struct bootstage_span span[SPAN_COUNT];
+#endif
 };
 
 enum {
-	BOOTSTAGE_VERSION	= 0,
+	BOOTSTAGE_VERSION	= 1,
 	BOOTSTAGE_MAGIC		= 0xb00757a3,
 	BOOTSTAGE_DIGITS	= 9,
 };
@@ -54,8 +93,22 @@ struct bootstage_hdr {
 	u32 size;		/* Total data size (non-zero if valid) */
 	u32 magic;		/* Magic number */
 	u32 next_id;		/* Next ID to use for bootstage */
+	u32 span_count;		/* Number of spans, following the records */
 };
 
+/* Copy a string to *@ptrp, advancing it; NULL is left as NULL */
+static const char *copy_str(char **ptrp, const char *str)
+{
+	char *ptr = *ptrp;
+
+	if (!str)
+		return NULL;
+	strcpy(ptr, str);
+	*ptrp += strlen(ptr) + 1;
+
+	return ptr;
+}
+
 int bootstage_relocate(void)
 {
 	struct bootstage_data *data = gd->bootstage;
@@ -77,6 +130,14 @@ int bootstage_relocate(void)
 		data->record[i].name = ptr;
 		ptr += strlen(ptr) + 1;
 	}
+#ifdef ENABLE_BOOTSTAGE_SPANS
+	for (i = 0; i < data->span_count; i++) {
+		struct bootstage_span *span = &data->span[i];
+
+		span->name = copy_str(&ptr, span->name);
+		span->dev_name = copy_str(&ptr, span->dev_name);
+	}
+#endif
 
 	return 0;
 }
@@ -218,6 +279,103 @@ uint32_t bootstage_accum(enum bootstage_id id)
 	return duration;
 }
 
+#ifdef ENABLE_BOOTSTAGE_SPANS
+/**
+ * span_recycle() - Make room for more spans
+ *
+ * This drops the oldest span which has ended, along with the spans inside
+ * it, provided that they have all ended too. A new span with no parent is
+ * only started once every earlier span has ended, so each span with no
+ * parent is followed in the table by the spans inside it, then by the next
+ * span with no parent.
+ *
+ * @data: Bootstage data
+ * Return: true if some spans were dropped, false if all are still in use
+ */
+static bool span_recycle(struct bootstage_data *data)
+{
+	struct bootstage_span *span = data->span;
+	int i, j, k, drop;
+	bool ended;
+
+	for (i = 0; i < data->span_count; i = j) {
+		ended = span[i].ended;
+		for (j = i + 1; j < data->span_count && span[j].depth; j++)
+			ended = ended && span[j].ended;
+		if (ended)
+			break;
+	}
+	if (i == data->span_count)
+		return false;
+
+	drop = j - i;
+	memmove(&span[i], &span[j], (data->span_count - j) * sizeof(*span));
+	data->span_count -= drop;
+	data->span_dropped += drop;
+	for (k = i; k < data->span_count; k++) {
+		if (span[k].parent >= j)
+			span[k].parent -= drop;
+	}
+	if (data->cur_span >= j)
+		data->cur_span -= drop;
+
+	return true;
+}
+
+int bootstage_span_begin(const char *name, const char *dev_name)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_span *span;
+	int parent;
+
+	if (!data)
+		return -ENOSPC;
+	if (data->span_count == SPAN_COUNT && !span_recycle(data)) {
+		data->span_dropped++;
+		return -ENOSPC;
+	}
+
+	parent = data->cur_span;
+	span = &data->span[data->span_count];
+	memset(span, '\0', sizeof(*span));
+	span->name = name;
+	span->dev_name = dev_name;
+	span->parent = parent;
+	span->depth = parent >= 0 ? data->span[parent].depth + 1 : 0;
+	span->phase = spl_phase();
+	span->start_us = timer_get_boot_us();
+	span->id = data->next_span_id++ & INT_MAX;
+	data->cur_span = data->span_count++;
+
+	return span->id;
+}
+
+void bootstage_span_end(int id, uint64_t bytes)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_span *span;
+	int cur, i;
+
+	if (!data || id < 0)
+		return;
+
+	/* Open spans are usually recent; an old one may have been recycled */
+	for (i = data->span_count - 1; i >= 0 && data->span[i].id != id; i--)
+		;
+	if (i < 0 || data->span[i].ended)
+		return;
+	span = &data->span[i];
+	span->end_us = timer_get_boot_us();
+	span->bytes = bytes;
+	span->ended = true;
+
+	/* Spans may end out of order, so find the innermost one still open */
+	for (cur = data->cur_span; cur >= 0 && data->span[cur].ended;)
+		cur = data->span[cur].parent;
+	data->cur_span = cur;
+}
+#endif
+
 /**
  * Get a record name as a printable string
  *
@@ -255,6 +413,37 @@ static uint32_t print_time_record(struct bootstage_record *rec, uint32_t prev)
 	return rec->time_us;
 }
 
+#ifdef ENABLE_BOOTSTAGE_SPANS
+static void report_spans(struct bootstage_data *data)
+{
+	struct bootstage_span *span;
+	int i;
+
+	if (!data->span_count)
+		return;
+	printf("\nSpans:\n");
+	printf("%11s%11s  %s\n", "Start", "Duration", "Span");
+	for (i = 0, span = data->span; i < data->span_count; i++, span++) {
+		print_grouped_ull(span->start_us, BOOTSTAGE_DIGITS);
+		if (span->ended)
+			print_grouped_ull(span->end_us - span->start_us,
+					  BOOTSTAGE_DIGITS);
+		else
+			printf("%11s", "-");
+		printf("  %*s%s", span->depth * 2, "", span->name);
+		if (span->dev_name)
+			printf(" (%s)", span->dev_name);
+		if (span->bytes)
+			printf(", %llu bytes", (unsigned long long)span->bytes);
+		printf("\n");
+	}
+	if (data->span_dropped)
+		printf("Dropped %u spans\n"
+		       "Please increase CONFIG_(SPL_TPL_)BOOTSTAGE_SPAN_COUNT\n",
+		       data->span_dropped);
+}
+#endif
+
 static int h_compare_record(const void *r1, const void *r2)
 {
 	const struct bootstage_record *rec1 = r1, *rec2 = r2;
@@ -357,6 +546,120 @@ void bootstage_report(void)
 		if (rec->start_us)
 			prev = print_time_record(rec, -1);
 	}
+#ifdef ENABLE_BOOTSTAGE_SPANS
+	report_spans(data);
+#endif
+}
+
+/**
+ * struct bootstage_out - Output buffer for bootstage_export()
+ *
+ * @buf: Buffer to write to
+ * @size: Size of @buf in bytes
+ * @len: Number of bytes written so far, including any that did not fit
+ */
+struct bootstage_out {
+	char *buf;
+	int size;
+	int len;
+};
+
+static void out_printf(struct bootstage_out *out, const char *fmt, ...)
+{
+	int avail = max(out->size - out->len, 0);
+	va_list args;
+
+	va_start(args, fmt);
+	out->len += vsnprintf(avail ? out->buf + out->len : NULL, avail, fmt,
+			      args);
+	va_end(args);
+}
+
+/* Write a JSON string, escaping it as needed */
+static void out_str(struct bootstage_out *out, const char *str)
+{
+	const char *p;
+
+	out_printf(out, "\"");
+	for (p = str; *p; p++) {
+		if (*p == '"' || *p == '\\')
+			out_printf(out, "\\%c", *p);
+		else if ((u8)*p < ' ')
+			out_printf(out, "\\u%04x", *p);
+		else
+			out_printf(out, "%c", *p);
+	}
+	out_printf(out, "\"");
+}
+
+/* Start an event, with the fields that every event has */
+static void out_event(struct bootstage_out *out, const char *name,
+		      const char *cat, char type, int tid)
+{
+	out_printf(out, out->len > 1 ? ",\n{\"name\":" : "\n{\"name\":");
+	out_str(out, name);
+	if (cat)
+		out_printf(out, ",\"cat\":\"%s\"", cat);
+	out_printf(out, ",\"ph\":\"%c\",\"pid\":1,\"tid\":%d", type, tid);
+}
+
+enum {
+	EXPORT_TID_CPU		= 1,	/* Track for marks and spans */
+	EXPORT_TID_DEV,			/* Track for spans using a device */
+};
+
+int bootstage_export(char *buf, int size)
+{
+	struct bootstage_data *data = gd->bootstage;
+	struct bootstage_out out;
+	struct bootstage_record *rec;
+	char name[20];
+	int i;
+
+	out.buf = buf;
+	out.size = buf ? size : 0;
+	out.len = 0;
+
+	out_printf(&out, "[");
+	out_event(&out, "thread_name", NULL, 'M', EXPORT_TID_CPU);
+	out_printf(&out, ",\"args\":{\"name\":\"CPU\"}}");
+	out_event(&out, "thread_name", NULL, 'M', EXPORT_TID_DEV);
+	out_printf(&out, ",\"args\":{\"name\":\"Devices\"}}");
+
+	/* Accumulated times have no start time, so cannot be shown */
+	for (i = 0, rec = data->record; i < data->rec_count; i++, rec++) {
+		if (rec->start_us || (rec->id != BOOTSTAGE_ID_AWAKE &&
+				      !rec->time_us))
+			continue;
+		out_event(&out, get_record_name(name, sizeof(name), rec),
+			  "mark", 'i', EXPORT_TID_CPU);
+		out_printf(&out, ",\"s\":\"p\",\"ts\":%lu}", rec->time_us);
+	}
+
+#ifdef ENABLE_BOOTSTAGE_SPANS
+	for (i = 0; i < data->span_count; i++) {
+		struct bootstage_span *span = &data->span[i];
+
+		/* A span which has not ended is shown as just its start */
+		out_event(&out, span->name, spl_phase_name(span->phase),
+			  span->ended ? 'X' : 'B',
+			  span->dev_name ? EXPORT_TID_DEV : EXPORT_TID_CPU);
+		out_printf(&out, ",\"ts\":%u", span->start_us);
+		if (span->ended)
+			out_printf(&out, ",\"dur\":%u",
+				   span->end_us - span->start_us);
+		out_printf(&out, ",\"args\":{\"bytes\":%llu",
+			   (unsigned long long)span->bytes);
+		if (span->dev_name) {
+			out_printf(&out, ",\"device\":");
+			out_str(&out, span->dev_name);
+		}
+		out_printf(&out, "}}");
+	}
+#endif
+	out_printf(&out, "\n]");
+
+	return out.len;
 }
 
 /**
@@ -402,6 +705,10 @@ int bootstage_stash(void *base, int size)
 	hdr->size = 0;
 	hdr->magic = BOOTSTAGE_MAGIC;
 	hdr->next_id = data->next_id;
+	hdr->span_count = 0;
+#ifdef ENABLE_BOOTSTAGE_SPANS
+	hdr->span_count = data->span_count;
+#endif
 	ptr += sizeof(*hdr);
 
 	/* Write the records, silently stopping when we run out of space */
@@ -416,6 +723,19 @@ int bootstage_stash(void *base, int size)
 		append_data(&ptr, end, name, strlen(name) + 1);
 	}
 
+#ifdef ENABLE_BOOTSTAGE_SPANS
+	/* Write the spans, then their strings, using "" for no device */
+	append_data(&ptr, end, data->span,
+		    data->span_count * sizeof(struct bootstage_span));
+	for (i = 0; i < data->span_count; i++) {
+		const struct bootstage_span *span = &data->span[i];
+		const char *dev_name = span->dev_name ? span->dev_name : "";
+
+		append_data(&ptr, end, span->name, strlen(span->name) + 1);
+		append_data(&ptr, end, dev_name, strlen(dev_name) + 1);
+	}
+#endif
+
 	/* Check for buffer overflow */
 	if (ptr > end) {
 		debug("%s: Not enough space for bootstage stash\n", __func__);
@@ -499,6 +819,37 @@ int bootstage_unstash(const void *base, int size)
 	data->next_id = hdr->next_id;
 	debug("Unstashed %d records\n", hdr->count);
 
+#ifdef ENABLE_BOOTSTAGE_SPANS
+	/* Losing the spans is not worth failing for */
+	if (data->span_count + hdr->span_count > SPAN_COUNT) {
+		debug("%s: Bootstage has %d spans, we have space for %d\n",
+		      __func__, hdr->span_count, SPAN_COUNT - data->span_count);
+		return 0;
+	} else if (hdr->span_count) {
+		struct bootstage_span *span = data->span + data->span_count;
+		uint base = data->span_count;
+
+		memcpy(span, ptr, hdr->span_count * sizeof(*span));
+		ptr += hdr->span_count * sizeof(*span);
+		for (i = 0; i < hdr->span_count; i++, span++) {
+			span->name = ptr;
+			ptr += strlen(ptr) + 1;
+			span->dev_name = *ptr ? ptr : NULL;
+			ptr += strlen(ptr) + 1;
+			if (spl_phase() == PHASE_SPL) {
+				span->name = strdup(span->name);
+				if (span->dev_name)
+					span->dev_name = strdup(span->dev_name);
+			}
+			if (span->parent >= 0)
+				span->parent += base;
+			span->id = -1;
+		}
+		data->span_count += hdr->span_count;
+		debug("Unstashed %d spans\n", hdr->span_count);
+	}
+#endif
+
 	return 0;
 }
 
@@ -527,6 +878,13 @@ int bootstage_get_size(void)
 	for (rec = data->record, i = 0; i < data->rec_count;
 	     i++, rec++)
 		size += strlen(rec->name) + 1;
+#ifdef ENABLE_BOOTSTAGE_SPANS
+	for (i = 0; i < data->span_count; i++) {
+		size += strlen(data->span[i].name) + 1;
+		if (data->span[i].dev_name)
+			size += strlen(data->span[i].dev_name) + 1;
+	}
+#endif
 
 	return size;
 }
@@ -541,6 +899,9 @@ int bootstage_init(bool first)
 		return -ENOMEM;
 	data = gd->bootstage;
 	memset(data, '\0', size);
+#ifdef ENABLE_BOOTSTAGE_SPANS
+	data->cur_span = -1;
+#endif
 	if (first) {
 		data->next_id = BOOTSTAGE_ID_USER;
 		bootstage_add_record(BOOTSTAGE_ID_AWAKE, "reset", 0, 0);
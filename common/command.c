@@ -9,6 +9,7 @@
  */
 
 #include <common.h>
+#include <arena.h>
 #include <compiler.h>
 #include <command.h>
 #include <console.h>
@@ -630,11 +631,13 @@ enum command_ret_t cmd_process(int flag, int argc, char *const argv[],
 
 	/* If OK so far, then do the command */
 	if (!rc) {
-		int newrep;
+		int newrep, depth;
 
 		if (ticks)
 			*ticks = get_timer(0);
+		depth = arena_push();
 		rc = cmd_call(cmdtp, flag, argc, argv, &newrep);
+		arena_pop(depth);
 		if (ticks)
 			*ticks = get_timer(*ticks);
 		*repeatable &= newrep;
@@ -17,9 +17,34 @@
 #include <asm/global_data.h>
 
 #include <malloc.h>
+#include <malloc_profile.h>
 #include <asm/io.h>
 #include <valgrind/memcheck.h>
 
+#if CONFIG_IS_ENABLED(MALLOC_PROFILE) && !CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE)
+/*
+ * The public functions record their caller and are defined at the end of this
+ * file. The allocator calls itself through these names, so that only calls
+ * from outside are recorded.
+ */
+#undef mALLOc
+#undef fREe
+#undef rEALLOc
+#undef mEMALIGn
+#undef cALLOc
+#define mALLOc		dlmalloc_impl
+#define fREe		dlfree_impl
+#define rEALLOc		dlrealloc_impl
+#define mEMALIGn	dlmemalign_impl
+#define cALLOc		dlcalloc_impl
+
+Void_t *mALLOc(size_t bytes);
+void fREe(Void_t *mem);
+Void_t *rEALLOc(Void_t *oldmem, size_t bytes);
+Void_t *mEMALIGn(size_t alignment, size_t bytes);
+Void_t *cALLOc(size_t n, size_t elem_size);
+#endif
+
 #ifdef DEBUG
 #if __STD_C
 static void malloc_update_mallinfo (void);
@@ -608,6 +633,16 @@ void *sbrk(ptrdiff_t increment)
 
 void mem_malloc_init(ulong start, ulong size)
 {
+#if CONFIG_IS_ENABLED(MALLOC_PROFILE)
+	/* The profile goes at the end, outside the heap */
+	if (size > CONFIG_MALLOC_PROFILE_SIZE * 2) {
+		size = ALIGN_DOWN(size - CONFIG_MALLOC_PROFILE_SIZE,
+				  sizeof(long));
+		malloc_profile_setup((void *)start + size,
+				     CONFIG_MALLOC_PROFILE_SIZE,
+				     CONFIG_MALLOC_PROFILE_SITES, true);
+	}
+#endif
 	mem_malloc_start = start;
 	mem_malloc_end = start + size;
 	mem_malloc_brk = start;
@@ -2411,6 +2446,91 @@ struct mallinfo mALLINFo(void)
 }
 #endif	/* DEBUG */
 
+void malloc_get_info(struct malloc_info *info)
+{
+	INTERNAL_SIZE_T avail, largest;
+	mchunkptr p;
+	mbinptr b;
+	int i;
+
+	memset(info, '\0', sizeof(*info));
+	info->size = mem_malloc_end - mem_malloc_start;
+
+	/* The top chunk can grow into the space not yet used */
+	avail = chunksize(top);
+	largest = avail + mem_malloc_end - mem_malloc_brk;
+	if (largest >= MINSIZE)
+		info->free_blocks++;
+	for (i = 1; i < NAV; ++i) {
+		b = bin_at(i);
+		for (p = last(b); p != b; p = p->bk) {
+			avail += chunksize(p);
+			largest = max(largest, chunksize(p));
+			info->free_blocks++;
+		}
+	}
+
+	info->in_use = sbrked_mem - avail;
+	info->peak = max_sbrked_mem;
+	info->largest_free = largest;
+}
+
+#if CONFIG_IS_ENABLED(MALLOC_PROFILE) && !CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE)
+#undef mALLOc
+#undef fREe
+#undef rEALLOc
+#undef mEMALIGn
+#undef cALLOc
+
+void *malloc(size_t bytes)
+{
+	void *ptr = dlmalloc_impl(bytes);
+
+	malloc_profile_alloc(ptr, bytes, (ulong)__builtin_return_address(0));
+
+	return ptr;
+}
+
+void free(void *mem)
+{
+	malloc_profile_free(mem);
+	dlfree_impl(mem);
+}
+
+void *realloc(void *oldmem, size_t bytes)
+{
+	void *ptr = dlrealloc_impl(oldmem, bytes);
+
+	/* On failure the old memory is still allocated */
+	if (ptr) {
+		malloc_profile_free(oldmem);
+		malloc_profile_alloc(ptr, bytes,
+				     (ulong)__builtin_return_address(0));
+	}
+
+	return ptr;
+}
+
+void *memalign(size_t alignment, size_t bytes)
+{
+	void *ptr = dlmemalign_impl(alignment, bytes);
+
+	malloc_profile_alloc(ptr, bytes, (ulong)__builtin_return_address(0));
+
+	return ptr;
+}
+
+void *calloc(size_t n, size_t elem_size)
+{
+	void *ptr = dlcalloc_impl(n, elem_size);
+
+	malloc_profile_alloc(ptr, n * elem_size,
+			     (ulong)__builtin_return_address(0));
+
+	return ptr;
+}
+#endif
+
 
 
 
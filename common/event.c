@@ -10,11 +10,13 @@
 #define LOG_CATEGORY	LOGC_EVENT
 
 #include <common.h>
+#include <dm.h>
 #include <event.h>
 #include <event_internal.h>
 #include <log.h>
 #include <linker_lists.h>
 #include <malloc.h>
+#include <time.h>
 #include <asm/global_data.h>
 #include <linux/list.h>
 #include <relocate.h>
@@ -62,14 +64,38 @@ const char *event_type_name(enum event_t type)
 #endif
 }
 
-static int notify_static(struct event *ev)
+/* Find where the static spies for each event type are in the linker list */
+static void event_build_index(struct event_state *state)
 {
 	struct evspy_info *start =
 		ll_entry_start(struct evspy_info, evspy_info);
 	const int n_ents = ll_entry_count(struct evspy_info, evspy_info);
-	struct evspy_info *spy;
+	int i;
 
-	for (spy = start; spy != start + n_ents; spy++) {
+	for (i = 0; i < n_ents; i++) {
+		uint type = start[i].type;
+
+		if (type >= EVT_COUNT)
+			continue;
+		if (!state->spy_end[type])
+			state->spy_first[type] = i;
+		state->spy_end[type] = i + 1;
+	}
+	state->indexed = true;
+}
+
+static int notify_static(struct event *ev)
+{
+	struct event_state *state = gd_event_state();
+	struct evspy_info *start =
+		ll_entry_start(struct evspy_info, evspy_info);
+	struct evspy_info *spy, *end;
+
+	if (!state->indexed)
+		event_build_index(state);
+	end = start + state->spy_end[ev->type];
+
+	for (spy = start + state->spy_first[ev->type]; spy < end; spy++) {
 		if (spy->type == ev->type) {
 			int ret;
 
@@ -98,49 +124,66 @@ static int notify_static(struct event *ev)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(EVENT_DYNAMIC)
 static int notify_dynamic(struct event *ev)
 {
 	struct event_state *state = gd_event_state();
 	struct event_spy *spy, *next;
 
-	list_for_each_entry_safe(spy, next, &state->spy_head, sibling_node) {
-		if (spy->type == ev->type) {
-			int ret;
+	list_for_each_entry_safe(spy, next, &state->spy_head[ev->type],
+				 sibling_node) {
+		int ret;
 
-			log_debug("Sending event %x/%s to spy '%s'\n", ev->type,
-				  event_type_name(ev->type), spy->id);
-			ret = spy->func(spy->ctx, ev);
+		log_debug("Sending event %x/%s to spy '%s'\n", ev->type,
+			  event_type_name(ev->type), spy->id);
+		ret = spy->func(spy->ctx, ev);
 
-			/*
-			 * TODO: Handle various return codes to
-			 *
-			 * - claim an event (no others will see it)
-			 * - return an error from the event
-			 */
-			if (ret)
-				return log_msg_ret("spy", ret);
-		}
+		/*
+		 * TODO: Handle various return codes to
+		 *
+		 * - claim an event (no others will see it)
+		 * - return an error from the event
+		 */
+		if (ret)
+			return log_msg_ret("spy", ret);
 	}
 
 	return 0;
 }
 
-int event_notify(enum event_t type, void *data, int size)
+static int count_dynamic(enum event_t type)
 {
-	struct event event;
-	int ret;
+	struct event_state *state = gd_event_state();
+	struct event_spy *spy;
+	int count = 0;
 
-	event.type = type;
-	if (size > sizeof(event.data))
-		return log_msg_ret("size", -E2BIG);
-	memcpy(&event.data, data, size);
+	list_for_each_entry(spy, &state->spy_head[type], sibling_node)
+		count++;
 
-	ret = notify_static(&event);
+	return count;
+}
+#else
+static int notify_dynamic(struct event *ev)
+{
+	return 0;
+}
+
+static int count_dynamic(enum event_t type)
+{
+	return 0;
+}
+#endif
+
+static int event_send(struct event *ev)
+{
+	int ret;
+
+	ret = notify_static(ev);
 	if (ret)
 		return log_msg_ret("sta", ret);
 
 	if (CONFIG_IS_ENABLED(EVENT_DYNAMIC)) {
-		ret = notify_dynamic(&event);
+		ret = notify_dynamic(ev);
 		if (ret)
 			return log_msg_ret("dyn", ret);
 	}
@@ -148,11 +191,93 @@ int event_notify(enum event_t type, void *data, int size)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(EVENT_DEBUG)
+static ulong event_time_us(void)
+{
+#ifdef CONFIG_TIMER
+	/* Reading the time may probe the timer, which sends more events */
+	if (!gd->timer || !device_active(gd->timer))
+		return 0;
+#endif
+
+	return timer_get_us();
+}
+
+static int event_send_timed(struct event *ev)
+{
+	struct event_stats *stats = &gd_event_state()->stats[ev->type];
+	ulong start, now;
+	int ret;
+
+	start = event_time_us();
+	ret = event_send(ev);
+	now = event_time_us();
+	stats->count++;
+	if (start && now)
+		stats->time_us += now - start;
+
+	return ret;
+}
+
+int event_get_stats(enum event_t type, struct event_stats *stats)
+{
+	if (type >= EVT_COUNT)
+		return -EINVAL;
+	*stats = gd_event_state()->stats[type];
+
+	return 0;
+}
+#else
+static int event_send_timed(struct event *ev)
+{
+	return event_send(ev);
+}
+
+int event_get_stats(enum event_t type, struct event_stats *stats)
+{
+	return -ENOSYS;
+}
+#endif
+
+int event_notify(enum event_t type, void *data, int size)
+{
+	struct event event;
+
+	if (type >= EVT_COUNT)
+		return log_msg_ret("type", -EINVAL);
+	event.type = type;
+	if (size > sizeof(event.data))
+		return log_msg_ret("size", -E2BIG);
+	memcpy(&event.data, data, size);
+
+	return event_send_timed(&event);
+}
+
 int event_notify_null(enum event_t type)
 {
 	return event_notify(type, NULL, 0);
 }
 
+/* Count the spies for an event type, both static and dynamic */
+static int event_count_spies(enum event_t type)
+{
+	struct event_state *state = gd_event_state();
+	struct evspy_info *start =
+		ll_entry_start(struct evspy_info, evspy_info);
+	struct evspy_info *spy;
+	int count = 0;
+
+	if (!state->indexed)
+		event_build_index(state);
+	for (spy = start + state->spy_first[type];
+	     spy < start + state->spy_end[type]; spy++) {
+		if (spy->type == type)
+			count++;
+	}
+
+	return count + count_dynamic(type);
+}
+
 void event_show_spy_list(void)
 {
 	struct evspy_info *start =
@@ -160,6 +285,8 @@ void event_show_spy_list(void)
 	const int n_ents = ll_entry_count(struct evspy_info, evspy_info);
 	struct evspy_info *spy;
 	const int size = sizeof(ulong) * 2;
+	struct event_stats stats;
+	int type, spies;
 
 	printf("Seq  %-24s  %*s  %s\n", "Type", size, "Function", "ID");
 	for (spy = start; spy != start + n_ents; spy++) {
@@ -167,6 +294,21 @@ void event_show_spy_list(void)
 		       spy->type, event_type_name(spy->type), size, spy->func,
 		       event_spy_id(spy));
 	}
+
+	if (!CONFIG_IS_ENABLED(EVENT_DEBUG))
+		return;
+
+	printf("\n%-24s  %5s  %8s  %10s\n", "Type", "Spies", "Sent",
+	       "Time(us)");
+	for (type = EVT_NONE + 1; type < EVT_COUNT; type++) {
+		spies = event_count_spies(type);
+		event_get_stats(type, &stats);
+		if (!spies && !stats.count)
+			continue;
+		printf("%-3x %-20s  %5d  %8u  %10lu\n", type,
+		       event_type_name(type), spies, stats.count,
+		       stats.time_us);
+	}
 }
 
 #if CONFIG_IS_ENABLED(EVENT_DYNAMIC)
@@ -180,6 +322,8 @@ int event_register(const char *id, enum event_t type, event_handler_t func, void
 	struct event_state *state = gd_event_state();
 	struct event_spy *spy;
 
+	if (type >= EVT_COUNT)
+		return log_msg_ret("type", -EINVAL);
 	spy = malloc(sizeof(*spy));
 	if (!spy)
 		return log_msg_ret("alloc", -ENOMEM);
@@ -188,7 +332,7 @@ int event_register(const char *id, enum event_t type, event_handler_t func, void
 	spy->type = type;
 	spy->func = func;
 	spy->ctx = ctx;
-	list_add_tail(&spy->sibling_node, &state->spy_head);
+	list_add_tail(&spy->sibling_node, &state->spy_head[type]);
 
 	return 0;
 }
@@ -197,9 +341,13 @@ int event_uninit(void)
 {
 	struct event_state *state = gd_event_state();
 	struct event_spy *spy, *next;
+	int type;
 
-	list_for_each_entry_safe(spy, next, &state->spy_head, sibling_node)
-		spy_free(spy);
+	for (type = 0; type < EVT_COUNT; type++) {
+		list_for_each_entry_safe(spy, next, &state->spy_head[type],
+					 sibling_node)
+			spy_free(spy);
+	}
 
 	return 0;
 }
@@ -207,8 +355,10 @@ int event_uninit(void)
 int event_init(void)
 {
 	struct event_state *state = gd_event_state();
+	int type;
 
-	INIT_LIST_HEAD(&state->spy_head);
+	for (type = 0; type < EVT_COUNT; type++)
+		INIT_LIST_HEAD(&state->spy_head[type]);
 
 	return 0;
 }
@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Heap profiler, recording which code allocates memory
+ *
+ * Call sites and live allocations are kept in open-addressed hash tables with
+ * linear probing, in a buffer set aside when the heap is set up, so the
+ * profiler never allocates memory itself.
+ */
+
+#define LOG_CATEGORY	LOGC_ALLOC
+
+#include <common.h>
+#include <malloc_profile.h>
+#include <asm/global_data.h>
+#include <linux/errno.h>
+#include <linux/kernel.h>
+#include <linux/log2.h>
+#include <linux/string.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct malloc_live - An allocation which has not been freed
+ *
+ * @ptr: Address of the allocation, or 0 if this entry is empty
+ * @size: Number of bytes requested
+ * @site: Index of the call site in struct malloc_profile->sites
+ */
+struct malloc_live {
+	ulong ptr;
+	uint size;
+	uint site;
+};
+
+static uint prof_hash(ulong val, uint num)
+{
+	return ((u64)val * 0x9e3779b97f4a7c15ULL) >> 32 & (num - 1);
+}
+
+/* Find the entry for a caller, or the empty entry where it should go */
+static struct malloc_site *site_lookup(struct malloc_site *sites, uint num,
+				       ulong caller)
+{
+	uint i, n;
+
+	i = prof_hash(caller, num);
+	for (n = 0; n < num; n++, i = (i + 1) & (num - 1)) {
+		if (sites[i].caller == caller || !sites[i].caller)
+			return &sites[i];
+	}
+
+	return NULL;
+}
+
+static int live_lookup(struct malloc_profile *prof, ulong ptr)
+{
+	uint i, n;
+
+	i = prof_hash(ptr, prof->num_live);
+	for (n = 0; n < prof->num_live; n++) {
+		if (prof->live[i].ptr == ptr)
+			return i;
+		if (!prof->live[i].ptr)
+			break;
+		i = (i + 1) & (prof->num_live - 1);
+	}
+
+	return -ENOENT;
+}
+
+/* Remove an entry, moving back any which probed past it */
+static void live_remove(struct malloc_profile *prof, uint i)
+{
+	uint mask = prof->num_live - 1;
+	uint j = i, k;
+
+	for (;;) {
+		prof->live[i].ptr = 0;
+		do {
+			j = (j + 1) & mask;
+			if (!prof->live[j].ptr)
+				goto done;
+			k = prof_hash(prof->live[j].ptr, prof->num_live);
+		} while (i <= j ? i < k && k <= j : i < k || k <= j);
+		prof->live[i] = prof->live[j];
+		i = j;
+	}
+done:
+	prof->used_live--;
+}
+
+struct malloc_profile *malloc_profile_setup(void *buf, ulong size,
+					    uint num_sites, bool track_frees)
+{
+	struct malloc_profile *old = gd->malloc_profile;
+	struct malloc_profile *prof = buf;
+	struct malloc_site *site;
+	ulong used;
+	uint i;
+
+	used = ALIGN(sizeof(*prof), sizeof(long));
+	used += num_sites * sizeof(struct malloc_site);
+	if (old)
+		used += old->used_sites * sizeof(struct malloc_site);
+	if (!is_power_of_2(num_sites) || used > size)
+		return NULL;
+
+	memset(prof, '\0', sizeof(*prof));
+	prof->sites = buf + ALIGN(sizeof(*prof), sizeof(long));
+	prof->num_sites = num_sites;
+	memset(prof->sites, '\0', num_sites * sizeof(struct malloc_site));
+
+	prof->early = prof->sites + num_sites;
+	if (old) {
+		for (i = 0; i < old->num_sites; i++) {
+			site = &old->sites[i];
+			if (site->caller)
+				prof->early[prof->num_early++] = *site;
+		}
+		prof->dropped = old->dropped;
+	}
+
+	size = (size - used) / sizeof(struct malloc_live);
+	if (track_frees && size) {
+		prof->live = buf + used;
+		prof->num_live = rounddown_pow_of_two(size);
+		memset(prof->live, '\0',
+		       prof->num_live * sizeof(struct malloc_live));
+	}
+	gd->malloc_profile = prof;
+
+	return prof;
+}
+
+void malloc_profile_alloc(void *ptr, size_t size, ulong caller)
+{
+	struct malloc_profile *prof = gd->malloc_profile;
+	bool full = gd->flags & GD_FLG_FULL_MALLOC_INIT;
+	struct malloc_site *site;
+	struct malloc_live *live;
+	int i;
+
+	if (!ptr)
+		return;
+	if (!prof) {
+		if (full || !CONFIG_IS_ENABLED(SYS_MALLOC_F))
+			return;
+		prof = malloc_simple_profile();
+		if (!prof)
+			return;
+	}
+
+	site = site_lookup(prof->sites, prof->num_sites, caller);
+	if (!site) {
+		prof->dropped++;
+		return;
+	}
+
+	/* Keep a quarter of the table empty so lookups stay short */
+	if (full && prof->live) {
+		if (prof->used_live >= prof->num_live / 4 * 3) {
+			prof->dropped++;
+			return;
+		}
+		i = prof_hash((ulong)ptr, prof->num_live);
+		while (prof->live[i].ptr)
+			i = (i + 1) & (prof->num_live - 1);
+		live = &prof->live[i];
+		live->ptr = (ulong)ptr;
+		live->size = size;
+		live->site = site - prof->sites;
+		prof->used_live++;
+	}
+
+	if (!site->caller) {
+		site->caller = caller;
+		prof->used_sites++;
+	}
+	site->total++;
+	site->count++;
+	site->bytes += size;
+	site->peak_count = max(site->peak_count, site->count);
+	site->peak_bytes = max(site->peak_bytes, site->bytes);
+}
+
+void malloc_profile_free(void *ptr)
+{
+	struct malloc_profile *prof = gd->malloc_profile;
+	struct malloc_live *live;
+	struct malloc_site *site;
+	int i;
+
+	/* The simple malloc() does not free anything */
+	if (!ptr || !prof || !prof->live ||
+	    !(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return;
+
+	i = live_lookup(prof, (ulong)ptr);
+	if (i < 0)
+		return;
+	live = &prof->live[i];
+	site = &prof->sites[live->site];
+	site->count--;
+	site->bytes -= live->size;
+	live_remove(prof, i);
+}
+
+struct malloc_site *malloc_profile_find(ulong caller)
+{
+	struct malloc_profile *prof = gd->malloc_profile;
+	struct malloc_site *site;
+
+	if (!prof)
+		return NULL;
+	site = site_lookup(prof->sites, prof->num_sites, caller);
+	if (!site || !site->caller)
+		return NULL;
+
+	return site;
+}
+
+/* Check whether @a is shown before @b, i.e. has a larger peak */
+static bool site_before(struct malloc_site *sites, int a, int b)
+{
+	if (sites[a].peak_bytes != sites[b].peak_bytes)
+		return sites[a].peak_bytes > sites[b].peak_bytes;
+
+	return a < b;
+}
+
+/*
+ * Callers in the early table were recorded before relocation, so only those
+ * in the full table need @reloc_off taken off
+ */
+static void show_sites(struct malloc_site *sites, uint num, uint count,
+		       ulong reloc_off)
+{
+	struct malloc_site *site;
+	int prev = -1, best;
+	uint i, upto;
+
+	printf("%-*s  %6s %6s %10s %10s %7s\n", (int)sizeof(long) * 2,
+	       "caller", "count", "peak", "bytes", "peak", "total");
+	for (upto = 0; upto < count; upto++) {
+		best = -1;
+		for (i = 0; i < num; i++) {
+			if (!sites[i].caller ||
+			    (prev != -1 && !site_before(sites, prev, i)))
+				continue;
+			if (best == -1 || site_before(sites, i, best))
+				best = i;
+		}
+		if (best == -1)
+			break;
+
+		site = &sites[best];
+		printf("%0*lx  %6u %6u %10lu %10lu %7u\n",
+		       (int)sizeof(long) * 2, site->caller - reloc_off,
+		       site->count, site->peak_count, site->bytes,
+		       site->peak_bytes, site->total);
+		prev = best;
+	}
+}
+
+void malloc_profile_dump(uint count)
+{
+	struct malloc_profile *prof = gd->malloc_profile;
+
+	if (!prof) {
+		printf("No heap profile\n");
+		return;
+	}
+	printf("%u call sites, %u live allocations, %u not recorded\n",
+	       prof->used_sites, prof->used_live, prof->dropped);
+	show_sites(prof->sites, prof->num_sites, count, gd->reloc_off);
+	if (prof->num_early) {
+		printf("\nBefore the full heap was ready:\n");
+		show_sites(prof->early, prof->num_early, count, 0);
+	}
+}
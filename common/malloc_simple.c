@@ -10,6 +10,7 @@
 #include <common.h>
 #include <log.h>
 #include <malloc.h>
+#include <malloc_profile.h>
 #include <mapmem.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
@@ -47,6 +48,9 @@ void *malloc_simple(size_t bytes)
 
 	log_debug("%lx\n", (ulong)ptr);
 	VALGRIND_MALLOCLIKE_BLOCK(ptr, bytes, 0, false);
+	if (CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE))
+		malloc_profile_alloc(ptr, bytes,
+				     (ulong)__builtin_return_address(0));
 
 	return ptr;
 }
@@ -60,6 +64,9 @@ void *memalign_simple(size_t align, size_t bytes)
 		return ptr;
 	log_debug("aligned to %lx\n", (ulong)ptr);
 	VALGRIND_MALLOCLIKE_BLOCK(ptr, bytes, 0, false);
+	if (CONFIG_IS_ENABLED(SYS_MALLOC_SIMPLE))
+		malloc_profile_alloc(ptr, bytes,
+				     (ulong)__builtin_return_address(0));
 
 	return ptr;
 }
@@ -70,9 +77,11 @@ void *calloc(size_t nmemb, size_t elem_size)
 	size_t size = nmemb * elem_size;
 	void *ptr;
 
-	ptr = malloc(size);
+	ptr = alloc_simple(size, 1);
 	if (!ptr)
 		return ptr;
+	VALGRIND_MALLOCLIKE_BLOCK(ptr, size, 0, false);
+	malloc_profile_alloc(ptr, size, (ulong)__builtin_return_address(0));
 	memset(ptr, '\0', size);
 
 	return ptr;
@@ -86,6 +95,27 @@ void free_simple(void *ptr)
 #endif
 #endif
 
+#if CONFIG_IS_ENABLED(MALLOC_PROFILE)
+struct malloc_profile *malloc_simple_profile(void)
+{
+	ulong size;
+	void *buf;
+
+	if (gd->malloc_profile)
+		return gd->malloc_profile;
+
+	/* Nothing is freed, so only the call sites are needed */
+	size = ALIGN(sizeof(struct malloc_profile), sizeof(long)) +
+		CONFIG_MALLOC_PROFILE_F_SITES * sizeof(struct malloc_site);
+	buf = alloc_simple(size, sizeof(long));
+	if (!buf)
+		return NULL;
+
+	return malloc_profile_setup(buf, size, CONFIG_MALLOC_PROFILE_F_SITES,
+				    false);
+}
+#endif
+
 void malloc_simple_info(void)
 {
 	log_info("malloc_simple: %lx bytes used, %lx remain\n", gd->malloc_ptr,
@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Slab caches for small fixed-size objects
+ *
+ * Each page is aligned to its size and starts with a header, so the page
+ * holding an object can be found from the object's address. Free objects in a
+ * page are kept on a list threaded through the objects themselves.
+ */
+
+#define LOG_CATEGORY	LOGC_ALLOC
+
+#include <common.h>
+#include <log.h>
+#include <malloc.h>
+#include <slab.h>
+#include <asm/global_data.h>
+#include <linux/kernel.h>
+#include <linux/list.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	/* Alignment of each object */
+	SLAB_ALIGN	= 8,
+
+	/* Smallest number of objects worth putting in a page */
+	SLAB_MIN_OBJS	= 4,
+
+	SLAB_MAGIC	= 0x51ab51ab,
+};
+
+/**
+ * struct slab_page - Header at the start of each page
+ *
+ * @node: Position in the cache's partial or full list
+ * @cache: Cache this page belongs to
+ * @free: First free object, or NULL if none
+ * @live: Number of objects allocated from this page
+ * @magic: SLAB_MAGIC, to check that an object came from a page
+ */
+struct slab_page {
+	struct list_head node;
+	struct slab_cache *cache;
+	void *free;
+	uint live;
+	uint magic;
+};
+
+#define SLAB_HDR_SIZE	ALIGN(sizeof(struct slab_page), SLAB_ALIGN)
+
+static inline uint slab_obj_size(struct slab_cache *cache)
+{
+	return ALIGN(cache->size, SLAB_ALIGN);
+}
+
+static inline uint slab_per_page(struct slab_cache *cache)
+{
+	return (CONFIG_SLAB_PAGE_SIZE - SLAB_HDR_SIZE) / slab_obj_size(cache);
+}
+
+static struct slab_page *slab_new_page(struct slab_cache *cache)
+{
+	uint size = slab_obj_size(cache);
+	struct slab_page *page;
+	void *ptr, **prevp;
+	uint i;
+
+	page = memalign(CONFIG_SLAB_PAGE_SIZE, CONFIG_SLAB_PAGE_SIZE);
+	if (!page)
+		return NULL;
+	page->cache = cache;
+	page->live = 0;
+	page->magic = SLAB_MAGIC;
+
+	prevp = &page->free;
+	ptr = (void *)page + SLAB_HDR_SIZE;
+	for (i = 0; i < slab_per_page(cache); i++, ptr += size) {
+		*prevp = ptr;
+		prevp = ptr;
+	}
+	*prevp = NULL;
+
+	list_add(&page->node, &cache->partial);
+	cache->pages++;
+	log_debug("New page %p for %s, %d pages\n", page, cache->name,
+		  cache->pages);
+
+	return page;
+}
+
+void *slab_alloc(struct slab_cache *cache)
+{
+	struct slab_page *page;
+	void *ptr;
+
+	/* The simple malloc() never frees, so there is nothing to gain */
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT) ||
+	    slab_per_page(cache) < SLAB_MIN_OBJS)
+		return calloc(1, cache->size);
+
+	if (!cache->partial.next) {
+		INIT_LIST_HEAD(&cache->partial);
+		INIT_LIST_HEAD(&cache->full);
+	}
+	if (list_empty(&cache->partial)) {
+		page = slab_new_page(cache);
+		if (!page)
+			return NULL;
+	} else {
+		page = list_first_entry(&cache->partial, struct slab_page,
+					node);
+	}
+
+	ptr = page->free;
+	page->free = *(void **)ptr;
+	page->live++;
+	if (!page->free)
+		list_move(&page->node, &cache->full);
+	cache->live++;
+	cache->peak = max(cache->peak, cache->live);
+	memset(ptr, '\0', cache->size);
+
+	return ptr;
+}
+
+void slab_free(struct slab_cache *cache, void *ptr)
+{
+	struct slab_page *page;
+	bool was_full;
+
+	if (!ptr)
+		return;
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT)) {
+		free(ptr);
+		return;
+	}
+
+	page = (struct slab_page *)ALIGN_DOWN((ulong)ptr,
+					      CONFIG_SLAB_PAGE_SIZE);
+	if (page->magic != SLAB_MAGIC || page->cache != cache) {
+		free(ptr);
+		return;
+	}
+
+	was_full = !page->free;
+	*(void **)ptr = page->free;
+	page->free = ptr;
+	cache->live--;
+	if (!--page->live) {
+		list_del(&page->node);
+		page->magic = 0;
+		free(page);
+		cache->pages--;
+	} else if (was_full) {
+		list_move(&page->node, &cache->partial);
+	}
+}
+
+ulong slab_heap_size(struct slab_cache *cache)
+{
+	return (ulong)cache->pages * CONFIG_SLAB_PAGE_SIZE;
+}
+
+ulong slab_malloc_size(struct slab_cache *cache)
+{
+	ulong chunk;
+
+	/* dlmalloc adds a size word and rounds up to two words */
+	chunk = ALIGN(cache->size + sizeof(size_t), 2 * sizeof(size_t));
+	chunk = max(chunk, (ulong)(4 * sizeof(size_t)));
+
+	return chunk * cache->live;
+}
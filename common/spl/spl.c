@@ -531,6 +531,10 @@ __weak void board_boot_order(u32 *spl_boot_list)
 	spl_boot_list[0] = spl_boot_device();
 }
 
+__weak void board_boot_order_record(u32 boot_device)
+{
+}
+
 __weak int spl_check_board_image(struct spl_image_info *spl_image,
 				 const struct spl_boot_device *bootdev)
 {
@@ -540,13 +544,15 @@ __weak int spl_check_board_image(struct spl_image_info *spl_image,
 static int spl_load_image(struct spl_image_info *spl_image,
 			  struct spl_image_loader *loader)
 {
-	int ret;
+	int ret, span;
 	struct spl_boot_device bootdev;
 
 	bootdev.boot_device = loader->boot_device;
 	bootdev.boot_device_name = NULL;
 
+	span = bootstage_span_begin("load_image", spl_loader_name(loader));
 	ret = loader->load_image(spl_image, &bootdev);
+	bootstage_span_end(span, ret ? 0 : spl_image->size);
 #ifdef CONFIG_SPL_LEGACY_IMAGE_CRC_CHECK
 	if (!ret && spl_image->dcrc_length) {
 		/* check data crc */
@@ -726,6 +732,7 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 			puts(SPL_TPL_PROMPT "failed to boot from all boot devices\n");
 		hang();
 	}
+	board_boot_order_record(spl_image.boot_device);
 
 	spl_perform_fixups(&spl_image);
 
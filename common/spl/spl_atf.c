@@ -206,6 +206,12 @@ static void __noreturn bl31_entry(uintptr_t bl31_entry, uintptr_t bl32_entry,
 	raw_write_daif(SPSR_EXCEPTION_MASK);
 	dcache_disable();
 
+	/*
+	 * The images were written through the D-cache, which has now been
+	 * cleaned, so make sure that no stale lines are fetched for them
+	 */
+	invalidate_icache_all();
+
 	atf_entry(bl31_params, (void *)fdt_addr);
 }
 
@@ -22,11 +22,37 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Most images which can be read ahead of being loaded */
+#define SPL_FIT_MAX_EXTENTS	8
+
+/**
+ * struct spl_fit_extent - External data of an image which is read early
+ *
+ * @node: Offset of the image node in the FIT
+ * @offset: Offset of the data from the start of the FIT, in bytes
+ * @size: Size of the data in bytes
+ * @load_addr: Address the image is loaded to
+ * @data: Where the data has been read to (its load address), or NULL if not
+ *	read yet
+ */
+struct spl_fit_extent {
+	int node;
+	int offset;
+	int size;
+	ulong load_addr;
+	void *data;
+};
+
 struct spl_fit_info {
 	const void *fit;	/* Pointer to a valid FIT blob */
 	size_t ext_data_offset;	/* Offset to FIT external data (end of FIT) */
 	int images_node;	/* FDT offset to "/images" node */
 	int conf_node;		/* FDT offset to selected configuration node */
+#if IS_ENABLED(CONFIG_SPL_LOAD_FIT_COALESCE)
+	/* Images to read early, sorted by offset */
+	struct spl_fit_extent ext[SPL_FIT_MAX_EXTENTS];
+	int ext_count;		/* Number of entries in @ext */
+#endif
 };
 
 __weak ulong board_spl_fit_size_align(ulong size)
@@ -208,6 +234,184 @@ static int get_aligned_image_size(struct spl_load_info *info, int data_size,
 	return (data_size + info->bl_len - 1) / info->bl_len;
 }
 
+#if IS_ENABLED(CONFIG_SPL_LOAD_FIT_COALESCE)
+static int spl_fit_extent_end(const struct spl_fit_extent *ext)
+{
+	return ext->offset + ext->size;
+}
+
+/* Get the data for an image if it has already been read, else NULL */
+static void *spl_fit_extent_data(const struct spl_fit_info *ctx, int node)
+{
+	int i;
+
+	for (i = 0; i < ctx->ext_count; i++) {
+		if (ctx->ext[i].node == node)
+			return ctx->ext[i].data;
+	}
+
+	return NULL;
+}
+
+/*
+ * Add an image to the list to read early. Only uncompressed images with
+ * external data and a load address are added, since anything else needs a
+ * buffer which is not known until the image is loaded.
+ */
+static void spl_fit_add_extent(struct spl_fit_info *ctx, int node)
+{
+	struct spl_fit_extent *ext;
+	uint8_t image_comp = -1;
+	ulong load_addr;
+	int offset, len, i;
+
+	if (node < 0 || ctx->ext_count == SPL_FIT_MAX_EXTENTS)
+		return;
+	for (i = 0; i < ctx->ext_count; i++) {
+		if (ctx->ext[i].node == node)
+			return;
+	}
+
+	if (fit_image_get_load(ctx->fit, node, &load_addr))
+		return;
+	if (!fit_image_get_data_position(ctx->fit, node, &offset))
+		;
+	else if (!fit_image_get_data_offset(ctx->fit, node, &offset))
+		offset += ctx->ext_data_offset;
+	else
+		return;
+	if (fit_image_get_data_size(ctx->fit, node, &len) || !len)
+		return;
+	if (spl_decompression_enabled()) {
+		fit_image_get_comp(ctx->fit, node, &image_comp);
+		if (image_comp == IH_COMP_GZIP || image_comp == IH_COMP_LZMA)
+			return;
+	}
+
+	/* Keep the list in order of offset */
+	for (i = ctx->ext_count; i && ctx->ext[i - 1].offset > offset; i--)
+		ctx->ext[i] = ctx->ext[i - 1];
+	ext = &ctx->ext[i];
+	ext->node = node;
+	ext->offset = offset;
+	ext->size = len;
+	ext->load_addr = load_addr;
+	ext->data = NULL;
+	ctx->ext_count++;
+}
+
+/*
+ * Check whether an image directly follows another both in the FIT and in
+ * memory, so that the two can be read straight to their load addresses with
+ * one request. The padding which mkimage may add to align external data to
+ * four bytes is allowed for.
+ */
+static bool spl_fit_extent_adjacent(const struct spl_fit_extent *prev,
+				    const struct spl_fit_extent *ext)
+{
+	int end = spl_fit_extent_end(prev);
+
+	return ext->offset >= end && ext->offset <= ALIGN(end, 4) &&
+		ext->load_addr - prev->load_addr == ext->offset - prev->offset;
+}
+
+/**
+ * spl_fit_read_run() - Read a run of images with a single request
+ *
+ * @ctx: FIT context
+ * @info: Device to read from
+ * @sector: Start sector of the FIT on the device
+ * @first: Index of the first image in the run
+ * @last: Index of the image after the run
+ * Return: 0 if OK, -ve on error
+ */
+static int spl_fit_read_run(struct spl_fit_info *ctx,
+			    struct spl_load_info *info, ulong sector,
+			    int first, int last)
+{
+	struct spl_fit_extent *ext = ctx->ext;
+	int start = ext[first].offset;
+	int size = spl_fit_extent_end(&ext[last - 1]) - start;
+	int overhead = get_aligned_image_overhead(info, start);
+	int nr_sectors = get_aligned_image_size(info, size, start);
+	ulong bytes = nr_sectors * (info->filename ? 1 : info->bl_len);
+	ulong fit = map_to_sysmem(ctx->fit);
+	void *buf;
+	int i;
+
+	/* The read must not land on the FIT itself */
+	if (overhead ||
+	    !IS_ALIGNED(ext[first].load_addr, ARCH_DMA_MINALIGN) ||
+	    (ext[first].load_addr < fit + fdt_totalsize(ctx->fit) &&
+	     fit < ext[first].load_addr + bytes))
+		return -EXDEV;
+	buf = map_sysmem(ext[first].load_addr, bytes);
+
+	if (info->read(info, sector + get_aligned_image_offset(info, start),
+		       nr_sectors, buf) != nr_sectors)
+		return -EIO;
+	debug("Read %d images: dst=%p, offset=%x, size=%x\n", last - first,
+	      buf, start, size);
+
+	for (i = first; i < last; i++)
+		ext[i].data = buf + ext[i].offset - start;
+
+	return 0;
+}
+
+/**
+ * spl_fit_prefetch() - Read the images in the configuration early
+ *
+ * The images which will be loaded are sorted by their position in the FIT.
+ * Each run of images which follow each other both in the FIT and in memory
+ * is read with a single request, straight to the load addresses. Nothing is
+ * staged through a buffer, so images which are not part of such a run are
+ * left to be loaded one by one, as before.
+ *
+ * @ctx: FIT context
+ * @info: Device to read from
+ * @sector: Start sector of the FIT on the device
+ */
+static void spl_fit_prefetch(struct spl_fit_info *ctx,
+			     struct spl_load_info *info, ulong sector)
+{
+	struct spl_fit_extent *ext = ctx->ext;
+	int i, j, node, index;
+
+	/* Follow the same search order as spl_load_simple_fit() */
+	ctx->ext_count = 0;
+	node = spl_fit_get_image_node(ctx, FIT_FIRMWARE_PROP, 0);
+	if (node < 0 && IS_ENABLED(CONFIG_SPL_OS_BOOT))
+		node = spl_fit_get_image_node(ctx, FIT_KERNEL_PROP, 0);
+	spl_fit_add_extent(ctx, node);
+	for (index = 0; ; index++) {
+		node = spl_fit_get_image_node(ctx, "loadables", index);
+		if (node < 0)
+			break;
+		spl_fit_add_extent(ctx, node);
+	}
+
+	for (i = 0; i < ctx->ext_count; i = j) {
+		for (j = i + 1; j < ctx->ext_count &&
+		     spl_fit_extent_adjacent(&ext[j - 1], &ext[j]); j++)
+			;
+		if (j - i > 1 && spl_fit_read_run(ctx, info, sector, i, j))
+			debug("Cannot read images together, loading one by one\n");
+	}
+}
+#else
+static inline void *spl_fit_extent_data(const struct spl_fit_info *ctx,
+					int node)
+{
+	return NULL;
+}
+
+static inline void spl_fit_prefetch(struct spl_fit_info *ctx,
+				    struct spl_load_info *info, ulong sector)
+{
+}
+#endif
+
 /**
  * load_simple_fit(): load the image described in a certain FIT node
  * @info:	points to information about the device to load data from
@@ -283,24 +487,31 @@ static int load_simple_fit(struct spl_load_info *info, ulong sector,
 			return 0;
 		}
 
-		if (spl_decompression_enabled() &&
-		    (image_comp == IH_COMP_GZIP || image_comp == IH_COMP_LZMA))
-			src_ptr = map_sysmem(ALIGN(CONFIG_SYS_LOAD_ADDR, ARCH_DMA_MINALIGN), len);
-		else
-			src_ptr = map_sysmem(ALIGN(load_addr, ARCH_DMA_MINALIGN), len);
 		length = len;
 
-		overhead = get_aligned_image_overhead(info, offset);
-		nr_sectors = get_aligned_image_size(info, length, offset);
-
-		if (info->read(info,
-			       sector + get_aligned_image_offset(info, offset),
-			       nr_sectors, src_ptr) != nr_sectors)
-			return -EIO;
+		/* The data may already have been read with other images */
+		src = spl_fit_extent_data(ctx, node);
+		if (!src) {
+			if (spl_decompression_enabled() &&
+			    (image_comp == IH_COMP_GZIP ||
+			     image_comp == IH_COMP_LZMA))
+				src_ptr = map_sysmem(ALIGN(CONFIG_SYS_LOAD_ADDR, ARCH_DMA_MINALIGN), len);
+			else
+				src_ptr = map_sysmem(ALIGN(load_addr, ARCH_DMA_MINALIGN), len);
+
+			overhead = get_aligned_image_overhead(info, offset);
+			nr_sectors = get_aligned_image_size(info, length,
+							    offset);
+
+			if (info->read(info,
+				       sector + get_aligned_image_offset(info, offset),
+				       nr_sectors, src_ptr) != nr_sectors)
+				return -EIO;
+			src = src_ptr + overhead;
+		}
 
 		debug("External data: dst=%p, offset=%x, size=%lx\n",
-		      src_ptr, offset, (unsigned long)length);
-		src = src_ptr + overhead;
+		      src, offset, (unsigned long)length);
 	} else {
 		/* Embedded data */
 		if (fit_image_get_data(fit, node, &data, &length)) {
@@ -342,7 +553,7 @@ static int load_simple_fit(struct spl_load_info *info, ulong sector,
 			return -EIO;
 		}
 		length = loadEnd - CONFIG_SYS_LOAD_ADDR;
-	} else {
+	} else if (src != load_ptr) {
 		memcpy(load_ptr, src, length);
 	}
 
@@ -754,6 +965,8 @@ int spl_load_simple_fit(struct spl_image_info *spl_image,
 	if (IS_ENABLED(CONFIG_SPL_FPGA))
 		spl_fit_load_fpga(&ctx, info, sector);
 
+	spl_fit_prefetch(&ctx, info, sector);
+
 	/*
 	 * Find the U-Boot image using the following search order:
 	 *   - start at 'firmware' (e.g. an ARM Trusted Firmware)
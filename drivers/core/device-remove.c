@@ -14,8 +14,10 @@
 #include <errno.h>
 #include <log.h>
 #include <malloc.h>
+#include <slab.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
+#include <dm/probe-async.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
 #include <dm/util.h>
@@ -118,10 +120,11 @@ int device_unbind(struct udevice *dev)
 		list_del(&dev->sibling_node);
 
 	devres_release_all(dev);
+	dm_probe_forget(dev);
 
 	if (dev_get_flags(dev) & DM_FLAG_NAME_ALLOCED)
 		free((char *)dev->name);
-	free(dev);
+	slab_free(SLAB_CACHE_GET(udevice), dev);
 
 	return 0;
 }
@@ -196,9 +199,23 @@ static int flags_remove(uint flags, uint drv_flags)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(DM_DEVICE_STATS)
+static void device_remove_time(struct udevice *dev, ulong start)
+{
+	ulong now = device_time_us();
+
+	dev->remove_time_us = start && now ? now - start : 0;
+}
+#else
+static inline void device_remove_time(struct udevice *dev, ulong start)
+{
+}
+#endif
+
 int device_remove(struct udevice *dev, uint flags)
 {
 	const struct driver *drv;
+	ulong start;
 	int ret;
 
 	if (!dev)
@@ -207,6 +224,18 @@ int device_remove(struct udevice *dev, uint flags)
 	if (!(dev_get_flags(dev) & DM_FLAG_ACTIVATED))
 		return 0;
 
+	/*
+	 * Let a probe running in the background settle first. This cannot be
+	 * done from the device's own poll function, so leave it alone then.
+	 */
+	if (dev_get_flags(dev) & DM_FLAG_PROBE_PENDING) {
+		ret = dm_probe_join(dev);
+		if (ret == -EDEADLK)
+			return ret;
+		if (!(dev_get_flags(dev) & DM_FLAG_ACTIVATED))
+			return 0;
+	}
+
 	ret = device_notify(dev, EVT_DM_PRE_REMOVE);
 	if (ret)
 		return ret;
@@ -232,6 +261,7 @@ int device_remove(struct udevice *dev, uint flags)
 		return ret;
 	}
 
+	start = CONFIG_IS_ENABLED(DM_DEVICE_STATS) ? device_time_us() : 0;
 	ret = uclass_pre_remove_device(dev);
 	if (ret)
 		return ret;
@@ -257,6 +287,7 @@ int device_remove(struct udevice *dev, uint flags)
 		dev_power_domain_off(dev);
 
 	device_free(dev);
+	device_remove_time(dev, start);
 
 	dev_bic_flags(dev, DM_FLAG_ACTIVATED);
 
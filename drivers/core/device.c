@@ -10,6 +10,7 @@
 
 #include <common.h>
 #include <cpu_func.h>
+#include <cyclic.h>
 #include <event.h>
 #include <log.h>
 #include <asm/global_data.h>
@@ -18,6 +19,7 @@
 #include <fdtdec.h>
 #include <fdt_support.h>
 #include <malloc.h>
+#include <slab.h>
 #include <asm/cache.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
@@ -25,6 +27,7 @@
 #include <dm/of_access.h>
 #include <dm/pinctrl.h>
 #include <dm/platdata.h>
+#include <dm/probe-async.h>
 #include <dm/read.h>
 #include <dm/uclass.h>
 #include <dm/uclass-internal.h>
@@ -34,9 +37,12 @@
 #include <linux/list.h>
 #include <power-domain.h>
 #include <linux/printk.h>
+#include <time.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+SLAB_CACHE(udevice, struct udevice);
+
 static int device_bind_common(struct udevice *parent, const struct driver *drv,
 			      const char *name, void *plat,
 			      ulong driver_data, ofnode node,
@@ -62,7 +68,7 @@ static int device_bind_common(struct udevice *parent, const struct driver *drv,
 		return ret;
 	}
 
-	dev = calloc(1, sizeof(struct udevice));
+	dev = slab_alloc(SLAB_CACHE_GET(udevice));
 	if (!dev)
 		return -ENOMEM;
 
@@ -232,7 +238,7 @@ fail_alloc2:
 fail_alloc1:
 	devres_release_all(dev);
 
-	free(dev);
+	slab_free(SLAB_CACHE_GET(udevice), dev);
 
 	return ret;
 }
@@ -478,16 +484,94 @@ static int device_get_dma_constraints(struct udevice *dev)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(DM_PROBE_TIME)
+ulong device_time_us(void)
+{
+#ifdef CONFIG_TIMER
+	/*
+	 * Reading the time may itself probe the timer, and the timer may be
+	 * removed before other devices
+	 */
+	if (!gd->timer || !device_active(gd->timer))
+		return 0;
+#endif
+
+	return timer_get_us();
+}
+
+static void device_probe_time_start(struct udevice *dev)
+{
+	dev_bic_flags(dev, DM_FLAG_PROBE_TIME_VALID);
+	dev->probe_time_us = device_time_us();
+}
+
+static void device_probe_time_end(struct udevice *dev)
+{
+	ulong now = device_time_us();
+
+	if (!dev->probe_time_us || !now)
+		return;
+	dev->probe_time_us = now - dev->probe_time_us;
+	dev_or_flags(dev, DM_FLAG_PROBE_TIME_VALID);
+}
+#else
+static inline void device_probe_time_start(struct udevice *dev)
+{
+}
+
+static inline void device_probe_time_end(struct udevice *dev)
+{
+}
+#endif
+
+int device_probe_complete(struct udevice *dev, int ret)
+{
+	if (ret)
+		goto fail;
+
+	ret = uclass_post_probe_device(dev);
+	if (ret)
+		goto fail_uclass;
+
+	if (dev->parent && device_get_uclass_id(dev) == UCLASS_PINCTRL) {
+		ret = pinctrl_select_state(dev, "default");
+		if (ret && ret != -ENOSYS)
+			log_debug("Device '%s' failed to configure default pinctrl: %d (%s)\n",
+				  dev->name, ret, errno_str(ret));
+	}
+
+	ret = device_notify(dev, EVT_DM_POST_PROBE);
+	if (ret)
+		goto fail_event;
+	device_probe_time_end(dev);
+
+	return 0;
+fail_event:
+fail_uclass:
+	if (device_remove(dev, DM_REMOVE_NORMAL)) {
+		dm_warn("%s: Device '%s' failed to remove on error path\n",
+			__func__, dev->name);
+	}
+fail:
+	dev_bic_flags(dev, DM_FLAG_ACTIVATED);
+
+	device_free(dev);
+
+	return ret;
+}
+
 int device_probe(struct udevice *dev)
 {
 	const struct driver *drv;
+	struct udevice *prev;
 	int ret;
 
 	if (!dev)
 		return -EINVAL;
 
+	dm_probe_add_dep(dev);
 	if (dev_get_flags(dev) & DM_FLAG_ACTIVATED)
-		return 0;
+		return dm_probe_join(dev);
 
 	ret = device_notify(dev, EVT_DM_PRE_PROBE);
 	if (ret)
@@ -513,17 +597,19 @@ int device_probe(struct udevice *dev)
 		 * so that we don't mess up the device.
 		 */
 		if (dev_get_flags(dev) & DM_FLAG_ACTIVATED)
-			return 0;
+			return dm_probe_join(dev);
 	}
 
 	dev_or_flags(dev, DM_FLAG_ACTIVATED);
+	device_probe_time_start(dev);
+	prev = dm_probe_enter(dev);
 
 	if (CONFIG_IS_ENABLED(POWER_DOMAIN) && dev->parent &&
 	    (device_get_uclass_id(dev) != UCLASS_POWER_DOMAIN) &&
 	    !(drv->flags & DM_FLAG_DEFAULT_PD_CTRL_OFF)) {
 		ret = dev_power_domain_on(dev);
 		if (ret)
-			goto fail;
+			goto fail_probe;
 	}
 
 	/*
@@ -552,21 +638,21 @@ int device_probe(struct udevice *dev)
 	    (device_get_uclass_id(dev) != UCLASS_IOMMU)) {
 		ret = dev_iommu_enable(dev);
 		if (ret)
-			goto fail;
+			goto fail_probe;
 	}
 
 	ret = device_get_dma_constraints(dev);
 	if (ret)
-		goto fail;
+		goto fail_probe;
 
 	ret = uclass_pre_probe_device(dev);
 	if (ret)
-		goto fail;
+		goto fail_probe;
 
 	if (dev->parent && dev->parent->driver->child_pre_probe) {
 		ret = dev->parent->driver->child_pre_probe(dev);
 		if (ret)
-			goto fail;
+			goto fail_probe;
 	}
 
 	/* Only handle devices that have a valid ofnode */
@@ -577,41 +663,38 @@ int device_probe(struct udevice *dev)
 		 */
 		ret = clk_set_defaults(dev, CLK_DEFAULTS_PRE);
 		if (ret)
-			goto fail;
+			goto fail_probe;
 	}
 
 	if (drv->probe) {
 		ret = drv->probe(dev);
 		if (ret)
-			goto fail;
+			goto fail_probe;
 	}
 
-	ret = uclass_post_probe_device(dev);
-	if (ret)
-		goto fail_uclass;
+	/* The driver may have left the device to finish in the background */
+	if (!(dev_get_flags(dev) & DM_FLAG_PROBE_PENDING))
+		ret = device_probe_complete(dev, 0);
+	dm_probe_leave(prev);
 
-	if (dev->parent && device_get_uclass_id(dev) == UCLASS_PINCTRL) {
-		ret = pinctrl_select_state(dev, "default");
-		if (ret && ret != -ENOSYS)
-			log_debug("Device '%s' failed to configure default pinctrl: %d (%s)\n",
-				  dev->name, ret, errno_str(ret));
-	}
+	return ret;
+fail_probe:
+	dm_probe_leave(prev);
+fail:
+	return device_probe_complete(dev, ret);
+}
 
-	ret = device_notify(dev, EVT_DM_POST_PROBE);
-	if (ret)
-		goto fail_event;
+int dev_probe_wait(struct udevice *dev, dev_probe_poll_t poll,
+		   ulong timeout_us)
+{
+	ulong start = timer_get_us();
+	int ret;
 
-	return 0;
-fail_event:
-fail_uclass:
-	if (device_remove(dev, DM_REMOVE_NORMAL)) {
-		dm_warn("%s: Device '%s' failed to remove on error path\n",
-			__func__, dev->name);
+	while ((ret = poll(dev)) == -EAGAIN) {
+		if (timer_get_us() - start >= timeout_us)
+			return -ETIMEDOUT;
+		schedule();
 	}
-fail:
-	dev_bic_flags(dev, DM_FLAG_ACTIVATED);
-
-	device_free(dev);
 
 	return ret;
 }
@@ -47,6 +47,8 @@ struct devres {
 	enum devres_phase		phase;
 #ifdef CONFIG_DEBUG_DEVRES
 	const char			*name;
+#endif
+#if defined(CONFIG_DEBUG_DEVRES) || CONFIG_IS_ENABLED(DM_DEVICE_STATS)
 	size_t				size;
 #endif
 	unsigned long long		data[];
@@ -65,6 +67,9 @@ static void devres_log(struct udevice *dev, struct devres *dr,
 	log_debug("%s: DEVRES %3s %p %s (%lu bytes)\n", dev->name, op, dr,
 		  dr->name, (unsigned long)dr->size);
 }
+#elif CONFIG_IS_ENABLED(DM_DEVICE_STATS)
+#define set_node_dbginfo(dr, n, s)	((dr)->size = (s))
+#define devres_log(dev, dr, op)		do {} while (0)
 #else /* CONFIG_DEBUG_DEVRES */
 #define set_node_dbginfo(dr, n, s)	do {} while (0)
 #define devres_log(dev, dr, op)		do {} while (0)
@@ -245,6 +250,9 @@ void dm_dump_devres(void)
 		dump_resources(root, 0);
 }
 
+#endif
+
+#if defined(CONFIG_DEBUG_DEVRES) || CONFIG_IS_ENABLED(DM_DEVICE_STATS)
 void devres_get_stats(const struct udevice *dev, struct devres_stats *stats)
 {
 	struct devres *dr;
@@ -256,7 +264,6 @@ void devres_get_stats(const struct udevice *dev, struct devres_stats *stats)
 		stats->total_size += dr->size;
 	}
 }
-
 #endif
 
 /*
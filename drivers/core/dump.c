@@ -32,17 +32,26 @@ static int h_cmp_uclass_id(const void *d1, const void *d2)
 }
 
 static void show_devices(struct udevice *dev, int depth, int last_flag,
-			 struct udevice **devs)
+			 struct udevice **devs, bool show_time)
 {
 	int i, is_last;
 	struct udevice *child;
 	u32 flags = dev_get_flags(dev);
+	char probed;
+
+	if (flags & DM_FLAG_PROBE_PENDING)
+		probed = '~';
+	else if (flags & DM_FLAG_ACTIVATED)
+		probed = '+';
+	else
+		probed = ' ';
 
 	/* print the first 20 characters to not break the tree-format. */
 	printf(CONFIG_IS_ENABLED(USE_TINY_PRINTF) ? " %s  %d  [ %c ]   %s  " :
 	       " %-10.10s  %3d  [ %c ]   %-20.20s  ", dev->uclass->uc_drv->name,
-	       dev_get_uclass_index(dev, NULL),
-	       flags & DM_FLAG_ACTIVATED ? '+' : ' ', dev->driver->name);
+	       dev_get_uclass_index(dev, NULL), probed, dev->driver->name);
+	if (show_time)
+		printf("%8u  ", dev_get_probe_time(dev));
 
 	for (i = depth; i >= 0; i--) {
 		is_last = (last_flag >> i) & 1;
@@ -73,19 +82,21 @@ static void show_devices(struct udevice *dev, int depth, int last_flag,
 		for (i = 0; i < count; i++) {
 			show_devices(devs[i], depth + 1,
 				     (last_flag << 1) | (i == count - 1),
-				     devs + count);
+				     devs + count, show_time);
 		}
 	} else {
 		device_foreach_child(child, dev) {
 			is_last = list_is_last(&child->sibling_node,
 					       &dev->child_head);
 			show_devices(child, depth + 1,
-				     (last_flag << 1) | is_last, NULL);
+				     (last_flag << 1) | is_last, NULL,
+				     show_time);
 		}
 	}
 }
 
-static void dm_dump_tree_single(struct udevice *dev, bool sort)
+static void dm_dump_tree_single(struct udevice *dev, bool sort,
+				bool show_time)
 {
 	int dev_count, uclasses;
 	struct udevice **devs = NULL;
@@ -98,12 +109,12 @@ static void dm_dump_tree_single(struct udevice *dev, bool sort)
 			return;
 		}
 	}
-	show_devices(dev, -1, 0, devs);
+	show_devices(dev, -1, 0, devs, show_time);
 	free(devs);
 }
 
 static void dm_dump_tree_recursive(struct udevice *dev, char *dev_name,
-				   bool extended, bool sort)
+				   bool extended, bool sort, bool show_time)
 {
 	struct udevice *child;
 	size_t len;
@@ -113,36 +124,41 @@ static void dm_dump_tree_recursive(struct udevice *dev, char *dev_name,
 	device_foreach_child(child, dev) {
 		if (extended) {
 			if (!strncmp(child->name, dev_name, len)) {
-				dm_dump_tree_single(child, sort);
+				dm_dump_tree_single(child, sort,
+						    show_time);
 				continue;
 			}
 		} else {
 			if (!strcmp(child->name, dev_name)) {
-				dm_dump_tree_single(child, sort);
+				dm_dump_tree_single(child, sort,
+						    show_time);
 				continue;
 			}
 		}
-		dm_dump_tree_recursive(child, dev_name, extended, sort);
+		dm_dump_tree_recursive(child, dev_name, extended, sort,
+				       show_time);
 	}
 }
 
-void dm_dump_tree(char *dev_name, bool extended, bool sort)
+void dm_dump_tree(char *dev_name, bool extended, bool sort, bool show_time)
 {
 	struct udevice *root;
 
-	printf(" Class     Index  Probed  Driver                Name\n");
-	printf("-----------------------------------------------------------\n");
+	printf(" Class     Index  Probed  Driver                %sName\n",
+	       show_time ? "Time(us)  " : "");
+	printf("-----------------------------------------------------------%s\n",
+	       show_time ? "----------" : "");
 
 	root = dm_root();
 	if (!root)
 		return;
 
 	if (!dev_name || !strcmp(dev_name, "root")) {
-		dm_dump_tree_single(root, sort);
+		dm_dump_tree_single(root, sort, show_time);
 		return;
 	}
 
-	dm_dump_tree_recursive(root, dev_name, extended, sort);
+	dm_dump_tree_recursive(root, dev_name, extended, sort, show_time);
 }
 
 /**
@@ -285,6 +301,75 @@ void dm_dump_static_driver_info(void)
 		printf("%-25.25s %p\n", entry->name, entry->plat);
 }
 
+#if CONFIG_IS_ENABLED(DM_DEVICE_STATS)
+static void collect_devices(struct udevice *dev, struct udevice **devs,
+			    int *countp)
+{
+	struct udevice *child;
+
+	/* Show devices which have been probed at some point */
+	if (device_active(dev) || dev_get_remove_time(dev))
+		devs[(*countp)++] = dev;
+	device_foreach_child(child, dev)
+		collect_devices(child, devs, countp);
+}
+
+static int h_cmp_probe_time(const void *d1, const void *d2)
+{
+	const struct udevice *const *dev1 = d1;
+	const struct udevice *const *dev2 = d2;
+	u32 time1 = dev_get_probe_time(*dev1);
+	u32 time2 = dev_get_probe_time(*dev2);
+
+	return time1 < time2 ? 1 : time1 > time2 ? -1 : 0;
+}
+
+void dm_dump_stats(bool sort)
+{
+	int dev_count, uclasses, count, i;
+	struct dm_dev_stats stats, total;
+	struct udevice **devs;
+
+	if (!dm_root())
+		return;
+	dm_get_stats(&dev_count, &uclasses);
+	devs = calloc(dev_count, sizeof(struct udevice *));
+	if (!devs) {
+		printf("(out of memory)\n");
+		return;
+	}
+	count = 0;
+	collect_devices(dm_root(), devs, &count);
+	if (sort)
+		qsort(devs, count, sizeof(struct udevice *), h_cmp_probe_time);
+
+	printf(" %-20s  %-20s  %9s  %9s  %6s  %6s  %6s  %6s\n", "Device",
+	       "Driver", "Probe us", "Remove us", "Priv", "Plat", "UcPriv",
+	       "Devres");
+	printf("-----------------------------------------------------------------------------------------------\n");
+	memset(&total, '\0', sizeof(total));
+	for (i = 0; i < count; i++) {
+		struct udevice *dev = devs[i];
+
+		dev_get_stats(dev, &stats);
+		printf(" %-20.20s  %-20.20s  %9u  %9u  %6d  %6d  %6d  %6d\n",
+		       dev->name, dev->driver->name, stats.probe_us,
+		       stats.remove_us, stats.attach_size[DM_TAG_PRIV],
+		       stats.attach_size[DM_TAG_PLAT],
+		       stats.attach_size[DM_TAG_UC_PRIV], stats.devres_size);
+		total.probe_us += stats.probe_us;
+		total.remove_us += stats.remove_us;
+		total.attach_total += stats.attach_total;
+		total.devres_count += stats.devres_count;
+		total.devres_size += stats.devres_size;
+	}
+	printf("\n%d devices: probe %u us, remove %u us, attached data %d bytes, devres %d bytes in %d allocs\n",
+	       count, total.probe_us, total.remove_us, total.attach_total,
+	       total.devres_size, total.devres_count);
+	free(devs);
+}
+#endif
+
 void dm_dump_mem(struct dm_stats *stats)
 {
 	int total, total_delta;
@@ -11,6 +11,8 @@
 #include <common.h>
 #include <errno.h>
 #include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
 #include <dm/lists.h>
@@ -20,6 +22,8 @@
 #include <fdtdec.h>
 #include <linux/compiler.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 struct driver *lists_driver_lookup_name(const char *name)
 {
 	struct driver *drv =
@@ -181,6 +185,130 @@ static int driver_check_compatible(const struct udevice_id *of_match,
 	return -ENOENT;
 }
 
+static struct driver *lists_driver_scan_compat(const char *compat,
+					       const struct udevice_id **idp)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	struct driver *entry;
+
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		if (!driver_check_compatible(entry->of_match, idp, compat))
+			return entry;
+	}
+
+	return NULL;
+}
+
+/**
+ * struct dm_compat_index - Hash index of driver compatible strings
+ *
+ * Slots refer to drivers by their position in the linker list rather than
+ * by address, so that they do not depend on where U-Boot runs from.
+ *
+ * @mask: Number of slots minus one, the number of slots is a power of two
+ * @slots: Open-addressed hash table. A used slot holds the driver index plus
+ *	one in its top 16 bits and the of_match index in its bottom 16 bits,
+ *	an empty slot is 0
+ */
+struct dm_compat_index {
+	uint mask;
+	u32 slots[];
+};
+
+static uint compat_hash(const char *str)
+{
+	uint hash = 5381;
+
+	while (*str)
+		hash = (hash * 33) ^ (u8)*str++;
+
+	return hash;
+}
+
+static const struct udevice_id *compat_index_slot(u32 slot,
+						  struct driver **drvp)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+
+	*drvp = driver + (slot >> 16) - 1;
+
+	return &(*drvp)->of_match[slot & 0xffff];
+}
+
+static struct dm_compat_index *compat_index_get(void)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	struct dm_compat_index *idx = gd_dm_compat_index();
+	const struct udevice_id *id;
+	uint count = 0, size, h;
+	struct driver *entry;
+	int i, j;
+
+	if (idx || n_ents >= 0xffff)
+		return idx;
+
+	for (i = 0; i < n_ents; i++) {
+		for (id = driver[i].of_match; id && id->compatible; id++)
+			count++;
+	}
+
+	/* Keep the table at most half full so that probe chains stay short */
+	for (size = 16; size < count * 2; size <<= 1)
+		;
+	idx = calloc(1, sizeof(*idx) + size * sizeof(u32));
+	if (!idx)
+		return NULL;
+	idx->mask = size - 1;
+
+	for (i = 0; i < n_ents; i++) {
+		for (j = 0, id = driver[i].of_match; id && id->compatible;
+		     j++, id++) {
+			h = compat_hash(id->compatible) & idx->mask;
+			while (idx->slots[h]) {
+				/* The first driver wins, as with a linear scan */
+				if (!strcmp(compat_index_slot(idx->slots[h],
+							      &entry)->compatible,
+					    id->compatible))
+					break;
+				h = (h + 1) & idx->mask;
+			}
+			if (!idx->slots[h])
+				idx->slots[h] = (i + 1) << 16 | j;
+		}
+	}
+	gd_set_dm_compat_index(idx);
+	log_debug("indexed %u compatible strings in %u slots\n", count, size);
+
+	return idx;
+}
+
+struct driver *lists_driver_match_compat(const char *compat,
+					 const struct udevice_id **idp)
+{
+	struct dm_compat_index *idx = NULL;
+	const struct udevice_id *id;
+	struct driver *entry;
+	uint h;
+
+	if (CONFIG_IS_ENABLED(DM_COMPAT_INDEX))
+		idx = compat_index_get();
+	if (!idx)
+		return lists_driver_scan_compat(compat, idp);
+
+	for (h = compat_hash(compat) & idx->mask; idx->slots[h];
+	     h = (h + 1) & idx->mask) {
+		id = compat_index_slot(idx->slots[h], &entry);
+		if (!strcmp(id->compatible, compat)) {
+			*idp = id;
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
 int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 		   struct driver *drv, bool pre_reloc_only)
 {
@@ -223,20 +351,26 @@ int lists_bind_fdt(struct udevice *parent, ofnode node, struct udevice **devp,
 			  compat);
 
 		id = NULL;
-		for (entry = driver; entry != driver + n_ents; entry++) {
-			if (drv) {
+		if (drv) {
+			for (entry = driver; entry != driver + n_ents; entry++) {
 				if (drv != entry)
 					continue;
 				if (!entry->of_match)
 					break;
+				ret = driver_check_compatible(entry->of_match,
+							      &id, compat);
+				if (!ret)
+					break;
+			}
+			if (entry == driver + n_ents)
+				continue;
+		} else {
+			entry = lists_driver_match_compat(compat, &id);
+			if (!entry) {
+				ret = -ENOENT;
+				continue;
 			}
-			ret = driver_check_compatible(entry->of_match, &id,
-						      compat);
-			if (!ret)
-				break;
 		}
-		if (entry == driver + n_ents)
-			continue;
 
 		if (pre_reloc_only) {
 			if (!ofnode_pre_reloc(node) &&
@@ -22,6 +22,7 @@
 #include <common.h>
 #include <log.h>
 #include <malloc.h>
+#include <of_live.h>
 #include <asm/global_data.h>
 #include <linux/bug.h>
 #include <linux/libfdt.h>
@@ -131,7 +132,7 @@ struct property *of_find_property(const struct device_node *np,
 	if (!np)
 		return NULL;
 
-	for (pp = np->properties; pp; pp = pp->next) {
+	for (pp = of_node_props(np); pp; pp = pp->next) {
 		if (strcmp(pp->name, name) == 0) {
 			if (lenp)
 				*lenp = pp->length;
@@ -150,7 +151,7 @@ struct device_node *of_find_all_nodes(struct device_node *prev)
 
 	if (!prev) {
 		np = gd->of_root;
-	} else if (prev->child) {
+	} else if (of_node_child(prev)) {
 		np = prev->child;
 	} else {
 		/*
@@ -179,7 +180,7 @@ const struct property *of_get_first_property(const struct device_node *np)
 	if (!np)
 		return NULL;
 
-	return  np->properties;
+	return of_node_props(np);
 }
 
 const struct property *of_get_next_property(const struct device_node *np,
@@ -302,7 +303,7 @@ static struct device_node *__of_get_next_child(const struct device_node *node,
 	if (!node)
 		return NULL;
 
-	next = prev ? prev->sibling : node->child;
+	next = prev ? prev->sibling : of_node_child(node);
 	/*
 	 * coverity[dead_error_line : FALSE]
 	 * Dead code here since our current implementation of of_node_get()
@@ -341,7 +342,7 @@ static struct device_node *__of_find_node_by_path(struct device_node *parent,
 }
 
 #define for_each_property_of_node(dn, pp) \
-	for (pp = dn->properties; pp != NULL; pp = pp->next)
+	for (pp = of_node_props(dn); pp != NULL; pp = pp->next)
 
 struct device_node *of_find_node_opts_by_path(struct device_node *root,
 					      const char *path,
@@ -453,6 +454,11 @@ struct device_node *of_find_node_by_phandle(struct device_node *root,
 	if (!handle)
 		return NULL;
 
+	/* Avoid building the whole of a lazy tree just to find one node */
+	if (CONFIG_IS_ENABLED(OF_LIVE_LAZY) &&
+	    !of_live_find_phandle(root ? root : gd->of_root, handle, &np))
+		return np;
+
 	for_each_of_allnodes_from(root, np)
 		if (np->phandle == handle)
 			break;
@@ -945,7 +951,7 @@ int of_write_prop(struct device_node *np, const char *propname, int len,
 	if (!np)
 		return -EINVAL;
 
-	for (pp = np->properties; pp; pp = pp->next) {
+	for (pp = of_node_props(np); pp; pp = pp->next) {
 		if (strcmp(pp->name, propname) == 0) {
 			/* Property exists -> change value */
 			pp->value = (void *)value;
@@ -573,7 +573,7 @@ ofnode ofnode_find_subnode(ofnode node, const char *subnode_name)
 	if (ofnode_is_np(node)) {
 		struct device_node *np = ofnode_to_np(node);
 
-		for (np = np->child; np; np = np->sibling) {
+		for (np = of_node_child(np); np; np = np->sibling) {
 			if (!strcmp(subnode_name, np->name))
 				break;
 		}
@@ -631,7 +631,7 @@ ofnode ofnode_first_subnode(ofnode node)
 {
 	assert(ofnode_valid(node));
 	if (ofnode_is_np(node))
-		return np_to_ofnode(node.np->child);
+		return np_to_ofnode(of_node_child(node.np));
 
 	return noffset_to_ofnode(node,
 		fdt_first_subnode(ofnode_to_fdt(node), ofnode_to_offset(node)));
@@ -707,8 +707,7 @@ ofnode ofnode_get_by_phandle(uint phandle)
 	if (of_live_active())
 		node = np_to_ofnode(of_find_node_by_phandle(NULL, phandle));
 	else
-		node.of_offset = fdt_node_offset_by_phandle(gd->fdt_blob,
-							    phandle);
+		node.of_offset = fdtdec_phandle_offset(gd->fdt_blob, phandle);
 
 	return node;
 }
@@ -721,8 +720,8 @@ ofnode oftree_get_by_phandle(oftree tree, uint phandle)
 		node = np_to_ofnode(of_find_node_by_phandle(tree.np, phandle));
 	else
 		node = ofnode_from_tree_offset(tree,
-			fdt_node_offset_by_phandle(oftree_lookup_fdt(tree),
-						   phandle));
+			fdtdec_phandle_offset(oftree_lookup_fdt(tree),
+					      phandle));
 
 	return node;
 }
@@ -940,7 +939,7 @@ ofnode ofnode_path(const char *path)
 	if (of_live_active())
 		return np_to_ofnode(of_find_node_by_path(path));
 	else
-		return offset_to_ofnode(fdt_path_offset(gd->fdt_blob, path));
+		return offset_to_ofnode(fdtdec_path_offset(gd->fdt_blob, path));
 }
 
 ofnode oftree_root(oftree tree)
@@ -960,7 +959,7 @@ ofnode oftree_path(oftree tree, const char *path)
 	} else if (*path != '/' && tree.fdt != gd->fdt_blob) {
 		return ofnode_null();  /* Aliases only on control FDT */
 	} else {
-		int offset = fdt_path_offset(tree.fdt, path);
+		int offset = fdtdec_path_offset(tree.fdt, path);
 
 		return ofnode_from_tree_offset(tree, offset);
 	}
@@ -1617,6 +1616,8 @@ int ofnode_write_prop(ofnode node, const char *propname, const void *value,
 			free(newval);
 		return ret;
 	} else {
+		fdtdec_index_invalidate(ofnode_to_fdt(node));
+
 		return fdt_setprop(ofnode_to_fdt(node), ofnode_to_offset(node),
 				   propname, value, len);
 	}
@@ -1681,6 +1682,8 @@ int ofnode_delete_prop(ofnode node, const char *propname)
 			return of_remove_property(ofnode_to_np(node), prop);
 		return 0;
 	} else {
+		fdtdec_index_invalidate(ofnode_to_fdt(node));
+
 		return fdt_delprop(ofnode_to_fdt(node), ofnode_to_offset(node),
 				   propname);
 	}
@@ -1852,6 +1855,7 @@ int ofnode_add_subnode(ofnode node, const char *name, ofnode *subnodep)
 		int poffset = ofnode_to_offset(node);
 		int offset;
 
+		fdtdec_index_invalidate(fdt);
 		offset = fdt_add_subnode(fdt, poffset, name);
 		if (offset == -FDT_ERR_EXISTS) {
 			offset = fdt_subnode_offset(fdt, poffset, name);
@@ -1879,6 +1883,7 @@ int ofnode_delete(ofnode *nodep)
 		void *fdt = ofnode_to_fdt(node);
 		int offset = ofnode_to_offset(node);
 
+		fdtdec_index_invalidate(fdt);
 		ret = fdt_del_node(fdt, offset);
 		if (ret)
 			ret = -EFAULT;
@@ -0,0 +1,468 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Background completion of device probing
+ *
+ * Devices whose driver calls dev_probe_async() while being probed with
+ * device_probe_async() are queued here as jobs. Jobs are polled from
+ * schedule() and by anyone joining a pending device, so several slow devices
+ * wait in parallel, but polling only records whether the device is ready,
+ * has failed or has timed out. The probe is finished (or unwound) by
+ * device_probe_complete() only when the device is joined: when it or a
+ * device which needs it is probed or removed, by dm_probe_join_all() and
+ * before booting an OS. So uclass post-probe methods and events never run in
+ * the middle of unrelated code which happens to call schedule().
+ *
+ * While a device is being probed, the devices it probes or looks up (clocks,
+ * regulators, resets, PHYs and so on) are recorded as its dependencies.
+ */
+
+#define LOG_CATEGORY	LOGC_DM
+
+#include <common.h>
+#include <cyclic.h>
+#include <dm.h>
+#include <log.h>
+#include <malloc.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <dm/device-internal.h>
+#include <dm/probe-async.h>
+#include <dm/util.h>
+#include <linux/errno.h>
+#include <linux/list.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* How often schedule() polls pending devices */
+#define DM_PROBE_POLL_US	1000
+
+/**
+ * struct dm_probe_job - A device which is finishing its probe
+ *
+ * @node: Entry in &dm_probe_sched.jobs
+ * @dev: Device being probed
+ * @poll: Function to check whether @dev is ready
+ * @start: Time the job was queued, in microseconds
+ * @timeout_us: Time allowed for @dev to become ready
+ * @result: -EAGAIN while @dev is busy, else the outcome of its probe
+ * @in_poll: true while @poll is running
+ * @joining: true if someone is waiting for this job in dm_probe_join(), in
+ *	which case dm_probe_poll() leaves it alone
+ */
+struct dm_probe_job {
+	struct list_head node;
+	struct udevice *dev;
+	dev_probe_poll_t poll;
+	ulong start;
+	ulong timeout_us;
+	int result;
+	bool in_poll;
+	bool joining;
+};
+
+/**
+ * struct dm_probe_dep - A dependency between two devices
+ *
+ * @node: Entry in &dm_probe_sched.deps
+ * @consumer: Device whose probe needed @supplier
+ * @supplier: Device needed
+ */
+struct dm_probe_dep {
+	struct list_head node;
+	struct udevice *consumer;
+	struct udevice *supplier;
+};
+
+/**
+ * struct dm_probe_sched - State of the probe scheduler
+ *
+ * @jobs: List of pending devices (struct dm_probe_job)
+ * @deps: List of recorded dependencies (struct dm_probe_dep)
+ * @cur: Device whose probe is in progress, or NULL
+ * @nowait: Device being probed by device_probe_async(), or NULL
+ * @cyclic: Cyclic function polling @jobs, or NULL if not registered
+ * @polling: true while dm_probe_poll() is running, to avoid recursion
+ * @finished: Number of jobs finished so far, so that dm_probe_poll() can tell
+ *	when the list changed under it
+ */
+struct dm_probe_sched {
+	struct list_head jobs;
+	struct list_head deps;
+	struct udevice *cur;
+	struct udevice *nowait;
+	struct cyclic_info *cyclic;
+	bool polling;
+	uint finished;
+};
+
+/*
+ * Get the scheduler, creating it if needed. Devices probed before relocation
+ * are thrown away by initr_dm(), so there is no scheduler until then.
+ */
+static struct dm_probe_sched *dm_probe_sched(void)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+
+	if (sched || !(gd->flags & GD_FLG_RELOC))
+		return sched;
+
+	sched = calloc(1, sizeof(*sched));
+	if (!sched)
+		return NULL;
+	INIT_LIST_HEAD(&sched->jobs);
+	INIT_LIST_HEAD(&sched->deps);
+	gd_set_dm_probe_sched(sched);
+
+	return sched;
+}
+
+static void dm_probe_cyclic(void *ctx)
+{
+	dm_probe_poll();
+}
+
+/*
+ * cyclic_unregister_all() may have freed our cyclic function behind our back,
+ * so check that it is still registered before using it
+ */
+static bool dm_probe_cyclic_live(struct dm_probe_sched *sched)
+{
+#ifdef CONFIG_CYCLIC
+	struct cyclic_info *cyclic;
+
+	if (!sched->cyclic)
+		return false;
+	hlist_for_each_entry(cyclic, cyclic_get_list(), list) {
+		if (cyclic == sched->cyclic)
+			return true;
+	}
+	sched->cyclic = NULL;
+#endif
+
+	return false;
+}
+
+static struct dm_probe_job *dm_probe_find_job(struct dm_probe_sched *sched,
+					      struct udevice *dev)
+{
+	struct dm_probe_job *job;
+
+	list_for_each_entry(job, &sched->jobs, node) {
+		if (job->dev == dev)
+			return job;
+	}
+
+	return NULL;
+}
+
+/**
+ * dm_probe_check() - Poll a job once, recording whether the device is done
+ *
+ * This only calls the driver's poll function; the probe is not finished.
+ *
+ * @job: Job to poll
+ * Return: -EAGAIN if the device is still busy, else the result of the probe
+ */
+static int dm_probe_check(struct dm_probe_job *job)
+{
+	int ret;
+
+	/* The poll function may end up here again, e.g. via schedule() */
+	if (job->result != -EAGAIN || job->in_poll)
+		return job->result;
+
+	job->in_poll = true;
+	ret = job->poll(job->dev);
+	job->in_poll = false;
+	if (ret == -EAGAIN && timer_get_us() - job->start >= job->timeout_us)
+		ret = -ETIMEDOUT;
+	job->result = ret;
+
+	return ret;
+}
+
+/**
+ * dm_probe_finish() - Finish the probe of a device which is done
+ *
+ * If the device failed, it is removed again, since its probe() method did
+ * succeed, and it is left inactive.
+ *
+ * @job: Job to finish, which is freed
+ * Return: 0 if the device is now active, else the error
+ */
+static int dm_probe_finish(struct dm_probe_job *job)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+	struct udevice *dev = job->dev, *prev;
+	int ret = job->result;
+
+	list_del(&job->node);
+	free(job);
+	sched->finished++;
+	dev_bic_flags(dev, DM_FLAG_PROBE_PENDING);
+
+	prev = sched->cur;
+	sched->cur = dev;
+	if (ret) {
+		log_debug("Device '%s' failed to finish probing: %d\n",
+			  dev->name, ret);
+		if (device_remove(dev, DM_REMOVE_NORMAL))
+			dm_warn("%s: Device '%s' failed to remove on error path\n",
+				__func__, dev->name);
+	}
+	ret = device_probe_complete(dev, ret);
+	sched->cur = prev;
+
+	return ret;
+}
+
+int dev_probe_async(struct udevice *dev, dev_probe_poll_t poll,
+		    ulong timeout_us)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+	struct dm_probe_job *job;
+
+	if (!sched || sched->nowait != dev || sched->cur != dev)
+		return dev_probe_wait(dev, poll, timeout_us);
+
+	job = calloc(1, sizeof(*job));
+	if (!job)
+		return dev_probe_wait(dev, poll, timeout_us);
+	job->dev = dev;
+	job->poll = poll;
+	job->start = timer_get_us();
+	job->timeout_us = timeout_us;
+	job->result = -EAGAIN;
+	list_add_tail(&job->node, &sched->jobs);
+	dev_or_flags(dev, DM_FLAG_PROBE_PENDING);
+
+	if (!dm_probe_cyclic_live(sched))
+		sched->cyclic = cyclic_register(dm_probe_cyclic,
+						DM_PROBE_POLL_US, "dm_probe",
+						NULL);
+
+	return 0;
+}
+
+int device_probe_async(struct udevice *dev)
+{
+	struct dm_probe_sched *sched = dm_probe_sched();
+	struct udevice *prev;
+	int ret;
+
+	if (!sched)
+		return device_probe(dev);
+
+	prev = sched->nowait;
+	sched->nowait = dev;
+	ret = device_probe(dev);
+	sched->nowait = prev;
+
+	return ret;
+}
+
+void dm_probe_poll(void)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+	struct dm_probe_job *job;
+	uint finished;
+
+	if (!sched || sched->polling)
+		return;
+
+	sched->polling = true;
+restart:
+	finished = sched->finished;
+	list_for_each_entry(job, &sched->jobs, node) {
+		if (job->joining)
+			continue;
+		dm_probe_check(job);
+		/* A poll function which joined a device changed the list */
+		if (sched->finished != finished)
+			goto restart;
+	}
+	sched->polling = false;
+}
+
+int dm_probe_join(struct udevice *dev)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+	struct dm_probe_job *job;
+	int ret;
+
+	if (!sched)
+		return 0;
+	job = dm_probe_find_job(sched, dev);
+	if (!job)
+		return 0;
+	/* Joining from the device's own poll function cannot work */
+	if (job->joining || job->in_poll)
+		return log_msg_ret("join", -EDEADLK);
+
+	job->joining = true;
+	while ((ret = dm_probe_check(job)) == -EAGAIN) {
+		/* Let everything else make progress while we wait */
+		dm_probe_poll();
+		schedule();
+	}
+
+	return dm_probe_finish(job);
+}
+
+int dm_probe_join_all(void)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+	struct dm_probe_job *job;
+	int ret, err = 0;
+
+	if (!sched)
+		return 0;
+
+	while (!list_empty(&sched->jobs)) {
+		job = list_first_entry(&sched->jobs, struct dm_probe_job, node);
+		if (job->joining || job->in_poll)
+			return log_msg_ret("all", -EDEADLK);
+		ret = dm_probe_join(job->dev);
+		if (ret)
+			err = ret;
+	}
+
+	return err;
+}
+
+int dm_probe_pending(void)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+	struct dm_probe_job *job;
+	int count = 0;
+
+	if (!sched)
+		return 0;
+	list_for_each_entry(job, &sched->jobs, node)
+		count++;
+
+	return count;
+}
+
+struct udevice *dm_probe_enter(struct udevice *dev)
+{
+	struct dm_probe_sched *sched = dm_probe_sched();
+	struct udevice *prev;
+
+	if (!sched)
+		return NULL;
+	prev = sched->cur;
+	sched->cur = dev;
+
+	return prev;
+}
+
+void dm_probe_leave(struct udevice *prev)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+
+	if (sched)
+		sched->cur = prev;
+}
+
+/* Check whether one device is an ancestor of the other */
+static bool dm_probe_related(struct udevice *dev, struct udevice *other)
+{
+	struct udevice *pos;
+
+	for (pos = dev->parent; pos; pos = pos->parent) {
+		if (pos == other)
+			return true;
+	}
+	for (pos = other->parent; pos; pos = pos->parent) {
+		if (pos == dev)
+			return true;
+	}
+
+	return false;
+}
+
+void dm_probe_add_dep(struct udevice *supplier)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+	struct udevice *consumer;
+	struct dm_probe_dep *dep;
+
+	/*
+	 * This runs on every device_probe(), mostly for devices which are
+	 * already up, so skip those before looking at the list. Only a
+	 * supplier which is still pending can hold up the consumer.
+	 */
+	if ((dev_get_flags(supplier) &
+	     (DM_FLAG_ACTIVATED | DM_FLAG_PROBE_PENDING)) == DM_FLAG_ACTIVATED)
+		return;
+	if (!sched || !sched->cur || sched->cur == supplier)
+		return;
+	consumer = sched->cur;
+
+	/* Parents and children are already tracked by the device tree */
+	if (dm_probe_related(consumer, supplier))
+		return;
+	list_for_each_entry(dep, &sched->deps, node) {
+		if (dep->consumer == consumer && dep->supplier == supplier)
+			return;
+	}
+
+	dep = malloc(sizeof(*dep));
+	if (!dep)
+		return;
+	dep->consumer = consumer;
+	dep->supplier = supplier;
+	list_add_tail(&dep->node, &sched->deps);
+}
+
+void dm_probe_forget(struct udevice *dev)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+	struct dm_probe_dep *dep, *next;
+
+	if (!sched)
+		return;
+
+	list_for_each_entry_safe(dep, next, &sched->deps, node) {
+		if (dep->consumer == dev || dep->supplier == dev) {
+			list_del(&dep->node);
+			free(dep);
+		}
+	}
+}
+
+void dm_probe_free(void)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+	struct dm_probe_dep *dep, *next_dep;
+	struct dm_probe_job *job, *next_job;
+
+	if (!sched)
+		return;
+
+	if (dm_probe_cyclic_live(sched))
+		cyclic_unregister(sched->cyclic);
+	list_for_each_entry_safe(job, next_job, &sched->jobs, node)
+		free(job);
+	list_for_each_entry_safe(dep, next_dep, &sched->deps, node)
+		free(dep);
+	free(sched);
+	gd_set_dm_probe_sched(NULL);
+}
+
+void dm_dump_probe_deps(void)
+{
+	struct dm_probe_sched *sched = gd_dm_probe_sched();
+	struct dm_probe_dep *dep;
+
+	printf(" Device                Needs                 Class\n");
+	printf("-----------------------------------------------------------\n");
+	if (!sched)
+		return;
+
+	list_for_each_entry(dep, &sched->deps, node) {
+		printf(" %-20.20s  %-20.20s  %s\n", dep->consumer->name,
+		       dep->supplier->name, dep->supplier->uclass->uc_drv->name);
+	}
+}
@@ -23,6 +23,7 @@
 #include <dm/of.h>
 #include <dm/of_access.h>
 #include <dm/platdata.h>
+#include <dm/probe-async.h>
 #include <dm/read.h>
 #include <dm/root.h>
 #include <dm/uclass.h>
@@ -106,6 +107,10 @@ int dm_init(bool of_live)
 		gd->uclass_root = &DM_UCLASS_ROOT_S_NON_CONST;
 		INIT_LIST_HEAD(DM_UCLASS_ROOT_NON_CONST);
 	}
+	/* Any existing table refers to the previous uclasses */
+	uclass_lookup_free();
+	/* Likewise any pending probes and dependencies refer to old devices */
+	dm_probe_free();
 
 	if (CONFIG_IS_ENABLED(OF_PLATDATA_INST)) {
 		ret = dm_setup_inst();
@@ -137,6 +142,8 @@ int dm_uninit(void)
 	device_remove(dm_root(), DM_REMOVE_NORMAL);
 	device_unbind(dm_root());
 	gd->dm_root = NULL;
+	uclass_lookup_free();
+	dm_probe_free();
 
 	return 0;
 }
@@ -144,6 +151,8 @@ int dm_uninit(void)
 #if CONFIG_IS_ENABLED(DM_DEVICE_REMOVE)
 int dm_remove_devices_flags(uint flags)
 {
+	/* The OS expects every device to be either up or off */
+	dm_probe_join_all();
 	device_remove(dm_root(), flags);
 
 	return 0;
@@ -293,7 +302,8 @@ static int dm_probe_devices(struct udevice *dev, bool pre_reloc_only)
 		goto probe_children;
 
 	if (dev_get_flags(dev) & DM_FLAG_PROBE_AFTER_BIND) {
-		ret = device_probe(dev);
+		/* Slow devices can finish in the background */
+		ret = device_probe_async(dev);
 		if (ret)
 			return ret;
 	}
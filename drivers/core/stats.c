@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Per-device cost accounting for driver model
+ *
+ * The probe and remove times are recorded by device_probe() and
+ * device_remove(); everything else is worked out from the device when asked.
+ */
+
+#define LOG_CATEGORY	LOGC_DM
+
+#include <common.h>
+#include <dm.h>
+#include <event.h>
+#include <log.h>
+#include <vsprintf.h>
+#include <dm/devres.h>
+#include <dm/ofnode.h>
+#include <dm/root.h>
+
+void dev_get_stats(const struct udevice *dev, struct dm_dev_stats *stats)
+{
+	struct devres_stats devres;
+	int i;
+
+	memset(stats, '\0', sizeof(*stats));
+	stats->probe_us = dev_get_probe_time(dev);
+	stats->remove_us = dev_get_remove_time(dev);
+
+	/* Only count what is actually allocated at present */
+	for (i = 0; i < DM_TAG_ATTACH_COUNT; i++) {
+		if (!dev_get_attach_ptr(dev, i))
+			continue;
+		stats->attach_size[i] = dev_get_attach_size(dev, i);
+		stats->attach_total += stats->attach_size[i];
+	}
+
+	if (CONFIG_IS_ENABLED(DEVRES)) {
+		devres_get_stats(dev, &devres);
+		stats->devres_count = devres.allocs;
+		stats->devres_size = devres.total_size;
+	}
+}
+
+#if CONFIG_IS_ENABLED(DM_DEVICE_STATS_FDT)
+static int dm_stats_add_devices(ofnode parent, struct udevice *dev,
+				int *indexp)
+{
+	struct dm_dev_stats stats;
+	struct udevice *child;
+	char name[12];
+	ofnode node;
+	int ret;
+
+	if (device_active(dev)) {
+		dev_get_stats(dev, &stats);
+		snprintf(name, sizeof(name), "%d", (*indexp)++);
+		ret = ofnode_add_subnode(parent, name, &node);
+		if (ret)
+			return log_msg_ret("add", ret);
+		ret = ofnode_write_string(node, "name", dev->name);
+		if (!ret)
+			ret = ofnode_write_string(node, "driver",
+						  dev->driver->name);
+		if (!ret)
+			ret = ofnode_write_u32(node, "probe-us", stats.probe_us);
+		if (!ret)
+			ret = ofnode_write_u32(node, "alloc-bytes",
+					       stats.attach_total);
+		if (!ret && stats.devres_count)
+			ret = ofnode_write_u32(node, "devres-bytes",
+					       stats.devres_size);
+		if (ret)
+			return log_msg_ret("prop", ret);
+	}
+
+	device_foreach_child(child, dev) {
+		ret = dm_stats_add_devices(parent, child, indexp);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int dm_stats_ft_fixup(void *ctx, struct event *event)
+{
+	oftree tree = event->data.ft_fixup.tree;
+	ofnode node;
+	int index = 0;
+	int ret;
+
+	ret = ofnode_add_subnode(oftree_root(tree), "dm-stats", &node);
+	if (!ret)
+		ret = dm_stats_add_devices(node, dm_root(), &index);
+
+	/* This is only for information, so do not stop the OS booting */
+	if (ret)
+		log_warning("Cannot add dm-stats to device tree (err=%d)\n",
+			    ret);
+
+	return 0;
+}
+EVENT_SPY_FULL(EVT_FT_FIXUP, dm_stats_ft_fixup);
+#endif
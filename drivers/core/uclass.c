@@ -13,6 +13,7 @@
 #include <errno.h>
 #include <log.h>
 #include <malloc.h>
+#include <slab.h>
 #include <asm/global_data.h>
 #include <dm/device.h>
 #include <dm/device-internal.h>
@@ -23,17 +24,124 @@
 
 DECLARE_GLOBAL_DATA_PTR;
 
+SLAB_CACHE(uclass, struct uclass);
+
+/* Number of devices cached per uclass for seq/ofnode/phandle lookups */
+#define UCLASS_DEV_CACHE_SIZE	32
+
+enum uclass_dev_key {
+	UCLASS_KEY_SEQ,
+	UCLASS_KEY_OFNODE,
+	UCLASS_KEY_PHANDLE,
+};
+
+/**
+ * struct uclass_lookup - Entry in the table of uclasses, indexed by ID
+ *
+ * @uc: uclass with this ID, or NULL if it does not exist (yet)
+ * @devs: cache of devices found by seq, ofnode or phandle, indexed by a hash
+ *	of the key, or NULL if no such lookup was done yet. Entries are
+ *	always checked against the device before use, and are dropped when
+ *	the device is unbound
+ */
+struct uclass_lookup {
+	struct uclass *uc;
+	struct udevice **devs;
+};
+
+/**
+ * uclass_lookup_table() - Get the table mapping IDs to uclasses
+ *
+ * The table is created from the list of uclasses on first use, then kept
+ * up to date as uclasses are added and destroyed. It is not created until
+ * the full malloc() pool is ready, since it is too large for the simple
+ * one.
+ *
+ * Return: table, or NULL if not enabled, not ready or out of memory
+ */
+static struct uclass_lookup *uclass_lookup_table(void)
+{
+	struct uclass_lookup *table = gd_uclass_lookup();
+	struct uclass *uc;
+
+	if (table || !CONFIG_IS_ENABLED(DM_UCLASS_LOOKUP) ||
+	    !(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return table;
+
+	table = calloc(UCLASS_COUNT, sizeof(*table));
+	if (!table)
+		return NULL;
+	list_for_each_entry(uc, gd->uclass_root, sibling_node) {
+		if (uc->uc_drv->id >= 0 && uc->uc_drv->id < UCLASS_COUNT)
+			table[uc->uc_drv->id].uc = uc;
+	}
+	gd_set_uclass_lookup(table);
+
+	return table;
+}
+
+void uclass_lookup_free(void)
+{
+	struct uclass_lookup *table = gd_uclass_lookup();
+	int i;
+
+	if (!table)
+		return;
+	for (i = 0; i < UCLASS_COUNT; i++)
+		free(table[i].devs);
+	free(table);
+	gd_set_uclass_lookup(NULL);
+}
+
+static struct udevice **uclass_dev_cache_slot(struct uclass *uc,
+					      enum uclass_dev_key type,
+					      ulong key)
+{
+	struct uclass_lookup *table = uclass_lookup_table();
+	struct uclass_lookup *entry;
+	uint hash;
+
+	if (!table)
+		return NULL;
+	entry = &table[uc->uc_drv->id];
+	if (!entry->devs) {
+		entry->devs = calloc(UCLASS_DEV_CACHE_SIZE,
+				     sizeof(struct udevice *));
+		if (!entry->devs)
+			return NULL;
+	}
+	hash = (key ^ (key >> 16)) * 0x9e3779b1 + type;
+
+	return &entry->devs[(hash >> 24) % UCLASS_DEV_CACHE_SIZE];
+}
+
+static void uclass_dev_cache_drop(struct udevice *dev)
+{
+	struct uclass_lookup *table = gd_uclass_lookup();
+	struct udevice **devs;
+	int i;
+
+	if (!table)
+		return;
+	devs = table[dev->uclass->uc_drv->id].devs;
+	for (i = 0; devs && i < UCLASS_DEV_CACHE_SIZE; i++) {
+		if (devs[i] == dev)
+			devs[i] = NULL;
+	}
+}
+
 struct uclass *uclass_find(enum uclass_id key)
 {
+	struct uclass_lookup *table;
 	struct uclass *uc;
 
 	if (!gd->dm_root)
 		return NULL;
-	/*
-	 * TODO(sjg@chromium.org): Optimise this, perhaps moving the found
-	 * node to the start of the list, or creating a linear array mapping
-	 * id to node.
-	 */
+
+	table = uclass_lookup_table();
+	if (table)
+		return key >= 0 && key < UCLASS_COUNT ? table[key].uc : NULL;
+
 	list_for_each_entry(uc, gd->uclass_root, sibling_node) {
 		if (uc->uc_drv->id == key)
 			return uc;
@@ -69,7 +177,7 @@ static int uclass_add(enum uclass_id id, struct uclass **ucp)
 		 */
 		return -EPFNOSUPPORT;
 	}
-	uc = calloc(1, sizeof(*uc));
+	uc = slab_alloc(SLAB_CACHE_GET(uclass));
 	if (!uc)
 		return -ENOMEM;
 	if (uc_drv->priv_auto) {
@@ -86,6 +194,8 @@ static int uclass_add(enum uclass_id id, struct uclass **ucp)
 	INIT_LIST_HEAD(&uc->sibling_node);
 	INIT_LIST_HEAD(&uc->dev_head);
 	list_add(&uc->sibling_node, DM_UCLASS_ROOT_NON_CONST);
+	if (gd_uclass_lookup())
+		gd_uclass_lookup()[id].uc = uc;
 
 	if (uc_drv->init) {
 		ret = uc_drv->init(uc);
@@ -102,8 +212,10 @@ fail:
 		uclass_set_priv(uc, NULL);
 	}
 	list_del(&uc->sibling_node);
+	if (gd_uclass_lookup())
+		gd_uclass_lookup()[id].uc = NULL;
 fail_mem:
-	free(uc);
+	slab_free(SLAB_CACHE_GET(uclass), uc);
 
 	return ret;
 }
@@ -135,9 +247,16 @@ int uclass_destroy(struct uclass *uc)
 	if (uc_drv->destroy)
 		uc_drv->destroy(uc);
 	list_del(&uc->sibling_node);
+	if (gd_uclass_lookup()) {
+		struct uclass_lookup *entry = &gd_uclass_lookup()[uc_drv->id];
+
+		free(entry->devs);
+		entry->devs = NULL;
+		entry->uc = NULL;
+	}
 	if (uc_drv->priv_auto)
 		free(uclass_get_priv(uc));
-	free(uc);
+	slab_free(SLAB_CACHE_GET(uclass), uc);
 
 	return 0;
 }
@@ -330,6 +449,7 @@ int uclass_find_next_free_seq(struct uclass *uc)
 
 int uclass_find_device_by_seq(enum uclass_id id, int seq, struct udevice **devp)
 {
+	struct udevice **slot;
 	struct uclass *uc;
 	struct udevice *dev;
 	int ret;
@@ -342,10 +462,18 @@ int uclass_find_device_by_seq(enum uclass_id id, int seq, struct udevice **devp)
 	if (ret)
 		return ret;
 
+	slot = uclass_dev_cache_slot(uc, UCLASS_KEY_SEQ, seq);
+	if (slot && *slot && (*slot)->seq_ == seq) {
+		*devp = *slot;
+		return 0;
+	}
+
 	uclass_foreach_dev(dev, uc) {
 		log_debug("   - %d '%s'\n", dev->seq_, dev->name);
 		if (dev->seq_ == seq) {
 			*devp = dev;
+			if (slot)
+				*slot = dev;
 			log_debug("   - found\n");
 			return 0;
 		}
@@ -382,6 +510,7 @@ int uclass_find_device_by_of_offset(enum uclass_id id, int node,
 int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 				 struct udevice **devp)
 {
+	struct udevice **slot;
 	struct uclass *uc;
 	struct udevice *dev;
 	int ret;
@@ -394,11 +523,19 @@ int uclass_find_device_by_ofnode(enum uclass_id id, ofnode node,
 	if (ret)
 		return ret;
 
+	slot = uclass_dev_cache_slot(uc, UCLASS_KEY_OFNODE, node.of_offset);
+	if (slot && *slot && ofnode_equal(dev_ofnode(*slot), node)) {
+		*devp = *slot;
+		goto done;
+	}
+
 	uclass_foreach_dev(dev, uc) {
 		log(LOGC_DM, LOGL_DEBUG_CONTENT, "      - checking %s\n",
 		    dev->name);
 		if (ofnode_equal(dev_ofnode(dev), node)) {
 			*devp = dev;
+			if (slot)
+				*slot = dev;
 			goto done;
 		}
 	}
@@ -415,7 +552,7 @@ static int uclass_find_device_by_phandle_id(enum uclass_id id,
 					    uint find_phandle,
 					    struct udevice **devp)
 {
-	struct udevice *dev;
+	struct udevice *dev, **slot;
 	struct uclass *uc;
 	int ret;
 
@@ -423,6 +560,12 @@ static int uclass_find_device_by_phandle_id(enum uclass_id id,
 	if (ret)
 		return ret;
 
+	slot = uclass_dev_cache_slot(uc, UCLASS_KEY_PHANDLE, find_phandle);
+	if (slot && *slot && dev_read_phandle(*slot) == find_phandle) {
+		*devp = *slot;
+		return 0;
+	}
+
 	uclass_foreach_dev(dev, uc) {
 		uint phandle;
 
@@ -430,6 +573,8 @@ static int uclass_find_device_by_phandle_id(enum uclass_id id,
 
 		if (phandle == find_phandle) {
 			*devp = dev;
+			if (slot)
+				*slot = dev;
 			return 0;
 		}
 	}
@@ -709,6 +854,7 @@ int uclass_bind_device(struct udevice *dev)
 err:
 	/* There is no need to undo the parent's post_bind call */
 	list_del(&dev->uclass_node);
+	uclass_dev_cache_drop(dev);
 
 	return ret;
 }
@@ -732,6 +878,7 @@ int uclass_pre_unbind_device(struct udevice *dev)
 int uclass_unbind_device(struct udevice *dev)
 {
 	list_del(&dev->uclass_node);
+	uclass_dev_cache_drop(dev);
 
 	return 0;
 }
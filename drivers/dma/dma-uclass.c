@@ -261,6 +261,34 @@ int dma_memcpy(void *dst, void *src, size_t len)
 	return ret;
 }
 
+int dma_memcpy_large(void *dst, const void *src, size_t len)
+{
+	size_t head, mid;
+	int ret;
+
+	if (!IS_ENABLED(CONFIG_DMA_MEMCPY_OFFLOAD))
+		return -ENOSYS;
+	if (len < CONFIG_DMA_MEMCPY_THRESHOLD || len < ARCH_DMA_MINALIGN * 2 ||
+	    (dst < src + len && src < dst + len))
+		return -EINVAL;
+
+	/*
+	 * The cache is invalidated over the destination, so only whole cache
+	 * lines are copied by DMA; the CPU does any partial lines at the ends
+	 */
+	head = PTR_ALIGN(dst, ARCH_DMA_MINALIGN) - dst;
+	mid = ALIGN_DOWN(len - head, ARCH_DMA_MINALIGN);
+	ret = dma_memcpy(dst + head, (void *)src + head, mid);
+	if (ret) {
+		log_debug("DMA copy failed (err=%d)\n", ret);
+		return ret;
+	}
+	memcpy(dst, src, head);
+	memcpy(dst + head + mid, src + head + mid, len - head - mid);
+
+	return 0;
+}
+
 UCLASS_DRIVER(dma) = {
 	.id		= UCLASS_DMA,
 	.name		= "dma",
@@ -0,0 +1,372 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * ARM PrimeCell PL330 DMA controller
+ *
+ * Only memory-to-memory copies are supported. Each copy is done by writing a
+ * short microcode program for channel 0 and starting it from the manager
+ * thread through the debug registers, then polling until the channel stops.
+ *
+ * Based on the Linux driver: drivers/dma/pl330.c
+ */
+
+#define LOG_CATEGORY	UCLASS_DMA
+
+#include <common.h>
+#include <clk.h>
+#include <cpu_func.h>
+#include <dm.h>
+#include <dma-uclass.h>
+#include <log.h>
+#include <time.h>
+#include <watchdog.h>
+#include <asm/cache.h>
+#include <asm/io.h>
+#include <asm/unaligned.h>
+#include <linux/bitops.h>
+#include <linux/errno.h>
+#include <linux/log2.h>
+#include <linux/sizes.h>
+
+/* Registers */
+#define PL330_FTC(ch)		(0x040 + (ch) * 4)
+#define PL330_CS(ch)		(0x100 + (ch) * 8)
+#define PL330_CPC(ch)		(0x104 + (ch) * 8)
+#define PL330_DBGSTATUS		0xd00
+#define PL330_DBGCMD		0xd04
+#define PL330_DBGINST0		0xd08
+#define PL330_DBGINST1		0xd0c
+#define PL330_CR0		0xe00
+#define PL330_CRD		0xe14
+
+#define CR0_BOOT_MNGR_NS	BIT(2)
+#define CR0_NUM_CHANS_SHIFT	4
+#define CR0_NUM_CHANS_MASK	0x7
+#define CRD_DATA_WIDTH_MASK	0x7
+
+#define CS_STATUS_MASK		0xf
+#define CS_STOPPED		0x0
+#define CS_FAULTING		0xf
+#define CS_FAULT_COMPLETING	0xe
+
+#define DBGSTATUS_BUSY		BIT(0)
+#define DBGINST0_CHANNEL	BIT(0)
+
+/* Instructions */
+#define CMD_DMAEND		0x00
+#define CMD_DMAKILL		0x01
+#define CMD_DMALD		0x04
+#define CMD_DMAST		0x08
+#define CMD_DMAWMB		0x13
+#define CMD_DMALP		0x20
+#define CMD_DMALPEND		0x28
+#define CMD_DMAGO		0xa0
+#define CMD_DMAMOV		0xbc
+
+#define LP_LC1			BIT(1)
+#define LPEND_LC1		BIT(2)
+#define LPEND_NOT_FOREVER	BIT(4)
+#define GO_NS			BIT(1)
+
+enum pl330_mov_reg {
+	MOV_SAR,
+	MOV_CCR,
+	MOV_DAR,
+};
+
+/* Channel control register */
+#define CC_SRCINC		BIT(0)
+#define CC_SRCBRSTSIZE_SHIFT	1
+#define CC_SRCBRSTLEN_SHIFT	4
+#define CC_SRCPRI		BIT(8)
+#define CC_SRCNS		BIT(9)
+#define CC_DSTINC		BIT(14)
+#define CC_DSTBRSTSIZE_SHIFT	15
+#define CC_DSTBRSTLEN_SHIFT	18
+#define CC_DSTPRI		BIT(22)
+#define CC_DSTNS		BIT(23)
+
+enum {
+	/* Largest number of beats in a burst */
+	PL330_MAX_BURST_LEN	= 16,
+
+	/* Largest count for one loop */
+	PL330_MAX_LOOP		= 256,
+
+	/* Space for the longest program */
+	PL330_PROG_SIZE		= 64,
+
+	/* Channel used for copies */
+	PL330_CHAN		= 0,
+
+	PL330_TIMEOUT_MS	= 1000,
+};
+
+/**
+ * struct pl330_priv - Information about the controller
+ *
+ * @base: Base address of the registers
+ * @clks: Clocks used by the controller
+ * @ns: true if the manager thread is non-secure, in which case channel
+ *	threads must be too
+ * @bus_bytes: Width of the AXI data bus in bytes
+ * @prog: Microcode buffer, which the controller reads from memory
+ */
+struct pl330_priv {
+	void __iomem *base;
+	struct clk_bulk clks;
+	bool ns;
+	uint bus_bytes;
+	u8 prog[PL330_PROG_SIZE] __aligned(ARCH_DMA_MINALIGN);
+};
+
+static u8 *pl330_mov(u8 *p, enum pl330_mov_reg reg, u32 val)
+{
+	*p++ = CMD_DMAMOV;
+	*p++ = reg;
+	put_unaligned_le32(val, p);
+
+	return p + 4;
+}
+
+static u8 *pl330_lp(u8 *p, bool lc1, uint count)
+{
+	*p++ = CMD_DMALP | (lc1 ? LP_LC1 : 0);
+	*p++ = count - 1;
+
+	return p;
+}
+
+static u8 *pl330_lpend(u8 *p, bool lc1, const u8 *start)
+{
+	uint jump = p - start;
+
+	*p++ = CMD_DMALPEND | LPEND_NOT_FOREVER | (lc1 ? LPEND_LC1 : 0);
+	*p++ = jump;
+
+	return p;
+}
+
+static u32 pl330_ccr(struct pl330_priv *priv, uint size_log2, uint len)
+{
+	u32 ccr;
+
+	ccr = CC_SRCINC | CC_DSTINC | CC_SRCPRI | CC_DSTPRI;
+	ccr |= size_log2 << CC_SRCBRSTSIZE_SHIFT;
+	ccr |= size_log2 << CC_DSTBRSTSIZE_SHIFT;
+	ccr |= (len - 1) << CC_SRCBRSTLEN_SHIFT;
+	ccr |= (len - 1) << CC_DSTBRSTLEN_SHIFT;
+	if (priv->ns)
+		ccr |= CC_SRCNS | CC_DSTNS;
+
+	return ccr;
+}
+
+static int pl330_wait_dbg(struct pl330_priv *priv)
+{
+	ulong start = get_timer(0);
+
+	while (readl(priv->base + PL330_DBGSTATUS) & DBGSTATUS_BUSY) {
+		if (get_timer(start) > PL330_TIMEOUT_MS)
+			return -ETIMEDOUT;
+	}
+
+	return 0;
+}
+
+/*
+ * Execute an instruction through the debug registers, waiting until the
+ * controller has taken it, as the Linux driver does with _until_dmac_idle()
+ */
+static int pl330_exec(struct pl330_priv *priv, bool channel, const u8 *insn)
+{
+	u32 val;
+	int ret;
+
+	ret = pl330_wait_dbg(priv);
+	if (ret)
+		return log_msg_ret("dbg", ret);
+
+	val = insn[0] << 16 | insn[1] << 24;
+	if (channel)
+		val |= DBGINST0_CHANNEL | PL330_CHAN << 8;
+	writel(val, priv->base + PL330_DBGINST0);
+	writel(get_unaligned_le32(insn + 2), priv->base + PL330_DBGINST1);
+	writel(0, priv->base + PL330_DBGCMD);
+
+	ret = pl330_wait_dbg(priv);
+	if (ret)
+		return log_msg_ret("exe", ret);
+
+	return 0;
+}
+
+static void pl330_kill(struct pl330_priv *priv)
+{
+	u8 insn[6] = { CMD_DMAKILL };
+
+	if (pl330_exec(priv, true, insn))
+		log_warning("Cannot stop channel %d\n", PL330_CHAN);
+}
+
+static int pl330_run(struct pl330_priv *priv)
+{
+	u8 insn[6];
+	ulong start;
+	u32 status;
+	int ret;
+
+	flush_dcache_range((ulong)priv->prog,
+			   (ulong)priv->prog + sizeof(priv->prog));
+
+	insn[0] = CMD_DMAGO | (priv->ns ? GO_NS : 0);
+	insn[1] = PL330_CHAN;
+	put_unaligned_le32((ulong)priv->prog, insn + 2);
+	ret = pl330_exec(priv, false, insn);
+	if (ret)
+		return ret;
+
+	start = get_timer(0);
+	do {
+		status = readl(priv->base + PL330_CS(PL330_CHAN)) &
+			CS_STATUS_MASK;
+		if (status == CS_FAULTING || status == CS_FAULT_COMPLETING) {
+			log_err("Channel fault %x at pc %x\n",
+				readl(priv->base + PL330_FTC(PL330_CHAN)),
+				readl(priv->base + PL330_CPC(PL330_CHAN)));
+			pl330_kill(priv);
+			return -EIO;
+		}
+		if (get_timer(start) > PL330_TIMEOUT_MS) {
+			pl330_kill(priv);
+			return log_msg_ret("run", -ETIMEDOUT);
+		}
+		schedule();
+	} while (status != CS_STOPPED);
+
+	return 0;
+}
+
+/*
+ * Copy up to @count bursts of @len beats of 1 << @size_log2 bytes each, as
+ * many as two nested loops allow. The number of bytes copied is returned in
+ * @copiedp.
+ */
+static int pl330_copy(struct pl330_priv *priv, dma_addr_t dst, dma_addr_t src,
+		      uint size_log2, uint len, ulong count, ulong *copiedp)
+{
+	uint inner, outer;
+	u8 *p, *lp0, *lp1;
+	int ret;
+
+	inner = min(count, (ulong)PL330_MAX_LOOP);
+	outer = min(count / inner, (ulong)PL330_MAX_LOOP);
+
+	p = priv->prog;
+	p = pl330_mov(p, MOV_SAR, src);
+	p = pl330_mov(p, MOV_DAR, dst);
+	p = pl330_mov(p, MOV_CCR, pl330_ccr(priv, size_log2, len));
+	p = pl330_lp(p, true, outer);
+	lp1 = p;
+	p = pl330_lp(p, false, inner);
+	lp0 = p;
+	*p++ = CMD_DMALD;
+	*p++ = CMD_DMAST;
+	p = pl330_lpend(p, false, lp0);
+	p = pl330_lpend(p, true, lp1);
+	*p++ = CMD_DMAWMB;
+	*p++ = CMD_DMAEND;
+
+	ret = pl330_run(priv);
+	if (ret)
+		return ret;
+	*copiedp = (ulong)inner * outer * len << size_log2;
+
+	return 0;
+}
+
+static int pl330_transfer(struct udevice *dev, int direction, dma_addr_t dst,
+			  dma_addr_t src, size_t len)
+{
+	struct pl330_priv *priv = dev_get_priv(dev);
+	uint size_log2, beats;
+	ulong copied;
+	int ret;
+
+	if (direction != DMA_MEM_TO_MEM)
+		return -EINVAL;
+	/* The address registers are only 32 bits */
+	if (max(dst, src) + len > SZ_4G)
+		return -EINVAL;
+
+	/* Whole bursts as wide as the bus, then narrower ones */
+	while (len) {
+		size_log2 = 0;
+		beats = 1;
+		if (!((dst | src) & (priv->bus_bytes - 1)) &&
+		    len >= priv->bus_bytes * PL330_MAX_BURST_LEN) {
+			size_log2 = ilog2(priv->bus_bytes);
+			beats = PL330_MAX_BURST_LEN;
+		} else if (len >= PL330_MAX_BURST_LEN) {
+			beats = PL330_MAX_BURST_LEN;
+		}
+		ret = pl330_copy(priv, dst, src, size_log2, beats,
+				 len / (beats << size_log2), &copied);
+		if (ret)
+			return ret;
+		dst += copied;
+		src += copied;
+		len -= copied;
+	}
+
+	return 0;
+}
+
+static const struct dma_ops pl330_ops = {
+	.transfer	= pl330_transfer,
+};
+
+static int pl330_probe(struct udevice *dev)
+{
+	struct dma_dev_priv *uc_priv = dev_get_uclass_priv(dev);
+	struct pl330_priv *priv = dev_get_priv(dev);
+	u32 cr0, crd;
+	int ret;
+
+	priv->base = dev_read_addr_ptr(dev);
+	if (!priv->base)
+		return -EINVAL;
+
+	/* The clocks are normally already running */
+	ret = clk_get_bulk(dev, &priv->clks);
+	if (!ret) {
+		ret = clk_enable_bulk(&priv->clks);
+		if (ret && ret != -ENOSYS)
+			return log_msg_ret("clk", ret);
+	}
+
+	cr0 = readl(priv->base + PL330_CR0);
+	crd = readl(priv->base + PL330_CRD);
+	priv->ns = cr0 & CR0_BOOT_MNGR_NS;
+	priv->bus_bytes = 1 << (crd & CRD_DATA_WIDTH_MASK);
+	log_debug("%d channels, %d-byte bus%s\n",
+		  ((cr0 >> CR0_NUM_CHANS_SHIFT) & CR0_NUM_CHANS_MASK) + 1,
+		  priv->bus_bytes, priv->ns ? ", non-secure" : "");
+
+	uc_priv->supported = DMA_SUPPORTS_MEM_TO_MEM;
+
+	return 0;
+}
+
+static const struct udevice_id pl330_ids[] = {
+	{ .compatible = "arm,pl330" },
+	{ }
+};
+
+U_BOOT_DRIVER(pl330) = {
+	.name		= "pl330",
+	.id		= UCLASS_DMA,
+	.of_match	= pl330_ids,
+	.ops		= &pl330_ops,
+	.probe		= pl330_probe,
+	.priv_auto	= sizeof(struct pl330_priv),
+};
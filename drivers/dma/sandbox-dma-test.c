@@ -16,6 +16,7 @@
 #include <dt-structs.h>
 #include <errno.h>
 #include <linux/printk.h>
+#include <asm/test.h>
 
 #define SANDBOX_DMA_CH_CNT 3
 #define SANDBOX_DMA_BUF_SIZE 1024
@@ -37,16 +38,27 @@ struct sandbox_dma_dev {
 	uchar	*buf_rx;
 	size_t	data_len;
 	u32	meta;
+	uint	transfers;
 };
 
 static int sandbox_dma_transfer(struct udevice *dev, int direction,
 				dma_addr_t dst, dma_addr_t src, size_t len)
 {
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
 	memcpy((void *)dst, (void *)src, len);
+	ud->transfers++;
 
 	return 0;
 }
 
+uint sandbox_dma_get_transfers(struct udevice *dev)
+{
+	struct sandbox_dma_dev *ud = dev_get_priv(dev);
+
+	return ud->transfers;
+}
+
 static int sandbox_dma_of_xlate(struct dma *dma,
 				struct ofnode_phandle_args *args)
 {
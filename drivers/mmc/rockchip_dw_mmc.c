@@ -32,6 +32,8 @@ struct rockchip_dwmmc_priv {
 	struct dwmci_host host;
 	int fifo_depth;
 	bool fifo_mode;
+	bool use_cdetect;
+	struct gpio_desc cd_gpio;
 	u32 minmax[2];
 };
 
@@ -78,6 +80,11 @@ static int rockchip_dwmmc_of_to_plat(struct udevice *dev)
 	else
 		host->dev_index = 1;
 
+	/* Card detect is only wired to the controller if nothing says otherwise */
+	priv->use_cdetect = !dev_read_bool(dev, "non-removable") &&
+			    !dev_read_bool(dev, "broken-cd") &&
+			    !dev_read_bool(dev, "cd-gpios");
+
 	priv->fifo_depth = dev_read_u32_default(dev, "fifo-depth", 0);
 
 	if (priv->fifo_depth < 0)
@@ -109,6 +116,21 @@ static int rockchip_dwmmc_of_to_plat(struct udevice *dev)
 	return 0;
 }
 
+static int rockchip_dwmmc_get_cd(struct udevice *dev)
+{
+	struct rockchip_dwmmc_priv *priv = dev_get_priv(dev);
+
+	if (dm_gpio_is_valid(&priv->cd_gpio))
+		return dm_gpio_get_value(&priv->cd_gpio);
+	if (priv->use_cdetect)
+		return !(dwmci_readl(&priv->host, DWMCI_CDETECT) & 1);
+
+	/* Without a card-detect line, the card may or may not be there */
+	return -ENOSYS;
+}
+
+static struct dm_mmc_ops rockchip_dwmmc_ops;
+
 static int rockchip_dwmmc_probe(struct udevice *dev)
 {
 	struct rockchip_mmc_plat *plat = dev_get_plat(dev);
@@ -138,7 +160,19 @@ static int rockchip_dwmmc_probe(struct udevice *dev)
 	ret = clk_get_by_index(dev, 1, &priv->clk);
 	if (ret < 0)
 		return ret;
+
+	/* This is optional */
+	if (CONFIG_IS_ENABLED(DM_GPIO))
+		gpio_request_by_name(dev, "cd-gpios", 0, &priv->cd_gpio,
+				     GPIOD_IS_IN);
 #endif
+	/*
+	 * Extend generic 'dm_dwmci_ops' with card detect, so that an empty
+	 * slot fails straight away rather than timing out
+	 */
+	memcpy(&rockchip_dwmmc_ops, &dm_dwmci_ops, sizeof(struct dm_mmc_ops));
+	rockchip_dwmmc_ops.get_cd = rockchip_dwmmc_get_cd;
+
 	host->fifoth_val = MSIZE(0x2) |
 		RX_WMARK(priv->fifo_depth / 2 - 1) |
 		TX_WMARK(priv->fifo_depth / 2);
@@ -181,7 +215,7 @@ U_BOOT_DRIVER(rockchip_rk3288_dw_mshc) = {
 	.id		= UCLASS_MMC,
 	.of_match	= rockchip_dwmmc_ids,
 	.of_to_plat = rockchip_dwmmc_of_to_plat,
-	.ops		= &dm_dwmci_ops,
+	.ops		= &rockchip_dwmmc_ops,
 	.bind		= rockchip_dwmmc_bind,
 	.probe		= rockchip_dwmmc_probe,
 	.priv_auto	= sizeof(struct rockchip_dwmmc_priv),
@@ -546,6 +546,77 @@ static int spinand_read_page(struct spinand_device *spinand,
 	return spinand_check_ecc_status(spinand, status);
 }
 
+static int spinand_read_cache_seq_op(struct spinand_device *spinand,
+				     bool last)
+{
+	struct spi_mem_op seq_op = SPINAND_PAGE_READ_CACHE_SEQ_OP;
+	struct spi_mem_op end_op = SPINAND_PAGE_READ_CACHE_END_OP;
+
+	return spi_mem_exec_op(spinand->slave, last ? &end_op : &seq_op);
+}
+
+/*
+ * Read a page as part of a PAGE READ CACHE SEQUENTIAL sequence. The page is
+ * moved from the data register to the cache and, unless @last is set, the
+ * chip loads the next page from the array while the cache is read out, so
+ * that only the first page of the sequence pays the full tR.
+ */
+static int spinand_read_page_seq(struct spinand_device *spinand,
+				 const struct nand_page_io_req *req,
+				 bool first, bool last, bool ecc_enabled)
+{
+	u8 status;
+	int ret;
+
+	if (first) {
+		ret = spinand_load_page_op(spinand, req);
+		if (ret)
+			return ret;
+
+		ret = spinand_wait(spinand, NULL);
+		if (ret < 0)
+			return ret;
+	}
+
+	ret = spinand_read_cache_seq_op(spinand, last);
+	if (ret)
+		return ret;
+
+	/* The ECC status bits now describe the page in the cache */
+	ret = spinand_wait(spinand, &status);
+	if (ret < 0)
+		return ret;
+
+	ret = spinand_read_from_cache_op(spinand, req);
+	if (ret)
+		return ret;
+
+	if (!ecc_enabled)
+		return 0;
+
+	return spinand_check_ecc_status(spinand, status);
+}
+
+/*
+ * Whether the page after the current one should be loaded while the current
+ * one is read out: it has to be part of the request and, as cache reads do
+ * not cross block boundaries, in the same eraseblock.
+ */
+static bool spinand_read_seq_next(struct spinand_device *spinand,
+				  const struct nand_io_iter *iter)
+{
+	struct nand_device *nand = spinand_to_nand(spinand);
+
+	if (!(spinand->flags & SPINAND_HAS_READ_CACHE_SEQ))
+		return false;
+
+	if (iter->dataleft <= iter->req.datalen &&
+	    iter->oobleft <= iter->req.ooblen)
+		return false;
+
+	return iter->req.pos.page + 1 < nand->memorg.pages_per_eraseblock;
+}
+
 static int spinand_write_page(struct spinand_device *spinand,
 			      const struct nand_page_io_req *req)
 {
@@ -580,6 +651,7 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 	struct nand_io_iter iter;
 	bool enable_ecc = false;
 	bool ecc_failed = false;
+	bool seq = false, next;
 	int ret = 0;
 
 	if (ops->mode != MTD_OPS_RAW && spinand->eccinfo.ooblayout)
@@ -599,7 +671,14 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 		if (ret)
 			break;
 
-		ret = spinand_read_page(spinand, &iter.req, enable_ecc);
+		next = spinand_read_seq_next(spinand, &iter);
+		if (seq || next) {
+			ret = spinand_read_page_seq(spinand, &iter.req, !seq,
+						    !next, enable_ecc);
+			seq = next;
+		} else {
+			ret = spinand_read_page(spinand, &iter.req, enable_ecc);
+		}
 		if (ret < 0 && ret != -EBADMSG)
 			break;
 
@@ -616,6 +695,10 @@ static int spinand_mtd_read(struct mtd_info *mtd, loff_t from,
 		ops->oobretlen += iter.req.ooblen;
 	}
 
+	/* Don't leave the chip in the middle of a cache read sequence */
+	if (ret && seq && !spinand_read_cache_seq_op(spinand, true))
+		spinand_wait(spinand, NULL);
+
 #ifndef __UBOOT__
 	mutex_unlock(&spinand->lock);
 #endif
@@ -1274,6 +1357,22 @@ MODULE_AUTHOR("Peter Pan<peterpandong@micron.com>");
 MODULE_LICENSE("GPL v2");
 #endif /* __UBOOT__ */
 
+static int spinand_remove(struct udevice *dev)
+{
+	struct spinand_device *spinand = dev_get_priv(dev);
+	struct mtd_info *mtd = dev_get_uclass_priv(dev);
+	int ret;
+
+	ret = del_mtd_device(mtd);
+	if (ret)
+		return ret;
+
+	spinand_cleanup(spinand);
+	free(mtd->name);
+
+	return 0;
+}
+
 static const struct udevice_id spinand_ids[] = {
 	{ .compatible = "spi-nand" },
 	{ /* sentinel */ },
@@ -1285,4 +1384,5 @@ U_BOOT_DRIVER(spinand) = {
 	.of_match = spinand_ids,
 	.priv_auto	= sizeof(struct spinand_device),
 	.probe = spinand_probe,
+	.remove = spinand_remove,
 };
@@ -179,7 +179,7 @@ static const struct spinand_info micron_spinand_table[] = {
 		     SPINAND_INFO_OP_VARIANTS(&quadio_read_cache_variants,
 					      &x4_write_cache_variants,
 					      &x4_update_cache_variants),
-		     0,
+		     SPINAND_HAS_READ_CACHE_SEQ,
 		     SPINAND_ECCINFO(&micron_8_ooblayout,
 				     micron_8_ecc_get_status)),
 	/* M79A 2Gb 1.8V */
@@ -190,7 +190,7 @@ static const struct spinand_info micron_spinand_table[] = {
 		     SPINAND_INFO_OP_VARIANTS(&quadio_read_cache_variants,
 					      &x4_write_cache_variants,
 					      &x4_update_cache_variants),
-		     0,
+		     SPINAND_HAS_READ_CACHE_SEQ,
 		     SPINAND_ECCINFO(&micron_8_ooblayout,
 				     micron_8_ecc_get_status)),
 	/* M78A 1Gb 3.3V */
@@ -201,7 +201,7 @@ static const struct spinand_info micron_spinand_table[] = {
 		     SPINAND_INFO_OP_VARIANTS(&quadio_read_cache_variants,
 					      &x4_write_cache_variants,
 					      &x4_update_cache_variants),
-		     0,
+		     SPINAND_HAS_READ_CACHE_SEQ,
 		     SPINAND_ECCINFO(&micron_8_ooblayout,
 				     micron_8_ecc_get_status)),
 	/* M78A 1Gb 1.8V */
@@ -212,7 +212,7 @@ static const struct spinand_info micron_spinand_table[] = {
 		     SPINAND_INFO_OP_VARIANTS(&quadio_read_cache_variants,
 					      &x4_write_cache_variants,
 					      &x4_update_cache_variants),
-		     0,
+		     SPINAND_HAS_READ_CACHE_SEQ,
 		     SPINAND_ECCINFO(&micron_8_ooblayout,
 				     micron_8_ecc_get_status)),
 	/* M79A 4Gb 3.3V */
@@ -223,7 +223,7 @@ static const struct spinand_info micron_spinand_table[] = {
 		     SPINAND_INFO_OP_VARIANTS(&quadio_read_cache_variants,
 					      &x4_write_cache_variants,
 					      &x4_update_cache_variants),
-		     0,
+		     SPINAND_HAS_READ_CACHE_SEQ,
 		     SPINAND_ECCINFO(&micron_8_ooblayout,
 				     micron_8_ecc_get_status),
 		     SPINAND_SELECT_TARGET(micron_select_target)),
@@ -0,0 +1,282 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Simulate a SPI NAND flash
+ *
+ * This emulates enough of a Micron MT29F2G01ABAGD to probe it and read from
+ * it, so that the operations issued by the SPI NAND core can be checked. The
+ * contents are generated rather than stored: every byte in the data area of a
+ * page holds the bottom eight bits of the page number and the spare area is
+ * erased. Program and erase operations are not supported.
+ */
+
+#define LOG_CATEGORY UCLASS_SPI_EMUL
+
+#include <common.h>
+#include <dm.h>
+#include <log.h>
+#include <spi.h>
+#include <asm/test.h>
+#include <linux/mtd/spinand.h>
+
+enum {
+	SB_SPINAND_PAGE_SIZE		= 2048,
+	SB_SPINAND_OOB_SIZE		= 128,
+	SB_SPINAND_PAGES_PER_BLOCK	= 64,
+	SB_SPINAND_PAGES		= SB_SPINAND_PAGES_PER_BLOCK * 2048,
+	/* Column bits, above which the plane is selected */
+	SB_SPINAND_COLUMN_MASK		= (SB_SPINAND_PAGE_SIZE << 1) - 1,
+	SB_SPINAND_MAX_OPS		= 64,
+};
+
+/* The ID follows a single address or dummy byte */
+static const u8 sandbox_spinand_id[] = { 0x00, 0x2c, 0x24 };
+
+/**
+ * struct sandbox_spinand - State of the emulated SPI NAND
+ *
+ * @opcode: Opcode of the operation in progress
+ * @addr: Address sent with the opcode. For READ ID this counts the bytes
+ *	clocked out so far.
+ * @lock: Block lock register
+ * @cfg: Configuration register
+ * @busy: Number of status reads which still report the chip as busy
+ * @data_page: Page in the data register, or -1 if none
+ * @cache_page: Page in the cache, or -1 if none
+ * @flip_page: Page which has bitflips corrected by the on-die ECC, or -1
+ * @ops: Operations seen since the log was last cleared
+ * @op_count: Number of operations seen, which may be more than were recorded
+ *	in @ops
+ */
+struct sandbox_spinand {
+	u8 opcode;
+	uint addr;
+	u8 lock;
+	u8 cfg;
+	int busy;
+	int data_page;
+	int cache_page;
+	int flip_page;
+	struct sandbox_spinand_op ops[SB_SPINAND_MAX_OPS];
+	int op_count;
+};
+
+static void sandbox_spinand_reset(struct sandbox_spinand *priv)
+{
+	priv->lock = 0x38;
+	priv->cfg = CFG_ECC_ENABLE;
+	priv->busy = 0;
+	priv->data_page = -1;
+	priv->cache_page = -1;
+}
+
+/* Start loading a page from the array, which takes one status poll */
+static void sandbox_spinand_load(struct sandbox_spinand *priv, int page)
+{
+	priv->data_page = page;
+	priv->busy = 1;
+}
+
+static int sandbox_spinand_addr_bytes(u8 opcode)
+{
+	switch (opcode) {
+	case 0x0f:	/* GET FEATURE */
+	case 0x1f:	/* SET FEATURE */
+		return 1;
+	case 0x03:	/* READ FROM CACHE */
+	case 0x0b:	/* FAST READ FROM CACHE */
+		return 2;
+	case 0x13:	/* PAGE READ */
+		return 3;
+	default:
+		return 0;
+	}
+}
+
+/* Handle the opcode and address phase of an operation */
+static int sandbox_spinand_start(struct sandbox_spinand *priv, const u8 *tx,
+				 uint len)
+{
+	struct sandbox_spinand_op *op;
+	int naddr, i;
+
+	if (!tx || !len)
+		return -EINVAL;
+	priv->opcode = tx[0];
+	naddr = sandbox_spinand_addr_bytes(priv->opcode);
+	if (len < 1 + naddr)
+		return -EINVAL;
+	priv->addr = 0;
+	for (i = 0; i < naddr; i++)
+		priv->addr = priv->addr << 8 | tx[1 + i];
+
+	if (priv->op_count < SB_SPINAND_MAX_OPS) {
+		op = &priv->ops[priv->op_count];
+		op->opcode = priv->opcode;
+		op->addr = priv->addr;
+	}
+	priv->op_count++;
+
+	switch (priv->opcode) {
+	case 0xff:	/* RESET */
+		sandbox_spinand_reset(priv);
+		break;
+	case 0x9f:	/* READ ID */
+		priv->addr = len - 1;
+		break;
+	case 0x13:	/* PAGE READ */
+		if (priv->addr >= SB_SPINAND_PAGES)
+			return -EINVAL;
+		sandbox_spinand_load(priv, priv->addr);
+		priv->cache_page = priv->addr;
+		break;
+	case 0x31:	/* PAGE READ CACHE SEQUENTIAL */
+		/* The next page is loaded only within the same block */
+		priv->cache_page = priv->data_page;
+		if (priv->data_page >= 0 &&
+		    (priv->data_page + 1) % SB_SPINAND_PAGES_PER_BLOCK)
+			sandbox_spinand_load(priv, priv->data_page + 1);
+		else
+			sandbox_spinand_load(priv, -1);
+		break;
+	case 0x3f:	/* PAGE READ CACHE LAST */
+		priv->cache_page = priv->data_page;
+		sandbox_spinand_load(priv, -1);
+		break;
+	case 0x0f:	/* GET FEATURE */
+	case 0x1f:	/* SET FEATURE */
+	case 0x03:	/* READ FROM CACHE */
+	case 0x0b:	/* FAST READ FROM CACHE */
+	case 0x06:	/* WRITE ENABLE */
+	case 0x04:	/* WRITE DISABLE */
+		break;
+	default:
+		log_err("Unsupported opcode %02x\n", priv->opcode);
+		return -EPROTONOSUPPORT;
+	}
+
+	return 0;
+}
+
+static u8 sandbox_spinand_get_feature(struct sandbox_spinand *priv, u8 reg)
+{
+	u8 val = 0;
+
+	switch (reg) {
+	case REG_BLOCK_LOCK:
+		return priv->lock;
+	case REG_CFG:
+		return priv->cfg;
+	case REG_STATUS:
+		if (priv->busy) {
+			priv->busy--;
+			return STATUS_BUSY;
+		}
+		if ((priv->cfg & CFG_ECC_ENABLE) && priv->cache_page >= 0 &&
+		    priv->cache_page == priv->flip_page)
+			val |= STATUS_ECC_HAS_BITFLIPS;
+		return val;
+	default:
+		return 0;
+	}
+}
+
+/* Handle the data phase of an operation */
+static int sandbox_spinand_data(struct sandbox_spinand *priv, const u8 *tx,
+				u8 *rx, uint len)
+{
+	uint i, col;
+
+	switch (priv->opcode) {
+	case 0x9f:
+		for (i = 0; i < len; i++, priv->addr++)
+			rx[i] = priv->addr < ARRAY_SIZE(sandbox_spinand_id) ?
+				sandbox_spinand_id[priv->addr] : 0;
+		break;
+	case 0x0f:
+		memset(rx, sandbox_spinand_get_feature(priv, priv->addr), len);
+		break;
+	case 0x1f:
+		if (priv->addr == REG_BLOCK_LOCK)
+			priv->lock = tx[0];
+		else if (priv->addr == REG_CFG)
+			priv->cfg = tx[0];
+		break;
+	case 0x03:
+	case 0x0b:
+		col = priv->addr & SB_SPINAND_COLUMN_MASK;
+		for (i = 0; i < len; i++, col++) {
+			if (priv->cache_page < 0 || col >= SB_SPINAND_PAGE_SIZE)
+				rx[i] = 0xff;
+			else
+				rx[i] = priv->cache_page;
+		}
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int sandbox_spinand_xfer(struct udevice *dev, unsigned int bitlen,
+				const void *dout, void *din, unsigned long flags)
+{
+	struct sandbox_spinand *priv = dev_get_priv(dev);
+
+	if (flags & SPI_XFER_BEGIN)
+		return sandbox_spinand_start(priv, dout, bitlen / 8);
+
+	return sandbox_spinand_data(priv, dout, din, bitlen / 8);
+}
+
+int sandbox_spinand_get_ops(struct udevice *dev,
+			    const struct sandbox_spinand_op **opsp)
+{
+	struct sandbox_spinand *priv = dev_get_priv(dev);
+
+	*opsp = priv->ops;
+
+	return priv->op_count;
+}
+
+void sandbox_spinand_clear_ops(struct udevice *dev)
+{
+	struct sandbox_spinand *priv = dev_get_priv(dev);
+
+	priv->op_count = 0;
+}
+
+void sandbox_spinand_set_flip_page(struct udevice *dev, int page)
+{
+	struct sandbox_spinand *priv = dev_get_priv(dev);
+
+	priv->flip_page = page;
+}
+
+static int sandbox_spinand_probe(struct udevice *dev)
+{
+	struct sandbox_spinand *priv = dev_get_priv(dev);
+
+	sandbox_spinand_reset(priv);
+	priv->flip_page = -1;
+
+	return 0;
+}
+
+static const struct dm_spi_emul_ops sandbox_spinand_emul_ops = {
+	.xfer		= sandbox_spinand_xfer,
+};
+
+static const struct udevice_id sandbox_spinand_ids[] = {
+	{ .compatible = "sandbox,spi-nand" },
+	{ }
+};
+
+U_BOOT_DRIVER(sandbox_spinand_emul) = {
+	.name		= "sandbox_spinand_emul",
+	.id		= UCLASS_SPI_EMUL,
+	.of_match	= sandbox_spinand_ids,
+	.probe		= sandbox_spinand_probe,
+	.priv_auto	= sizeof(struct sandbox_spinand),
+	.ops		= &sandbox_spinand_emul_ops,
+};
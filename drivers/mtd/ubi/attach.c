@@ -79,6 +79,7 @@
 #include <u-boot/crc.h>
 #else
 #include <div64.h>
+#include <time.h>
 #include <linux/bug.h>
 #include <linux/err.h>
 #include <linux/printk.h>
@@ -833,6 +834,9 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		return 0;
 	}
 
+	ubi_io_prefetch_hdrs(ubi, pnum);
+	ubi->attach_stats.scanned_pebs += 1;
+
 	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
 	if (err < 0)
 		return err;
@@ -1214,6 +1218,26 @@ static void destroy_ai(struct ubi_attach_info *ai)
 	kfree(ai);
 }
 
+/**
+ * alloc_hdrs_buf - allocate the buffer used to prefetch PEB headers.
+ * @ubi: UBI device description object
+ *
+ * Failing to allocate it is not fatal, headers are then read one by one.
+ */
+static void alloc_hdrs_buf(struct ubi_device *ubi)
+{
+	ubi->hdrs_pnum = -1;
+	ubi->hdrs_buf = kmalloc(ubi->vid_hdr_aloffset + ubi->vid_hdr_alsize,
+				GFP_KERNEL);
+}
+
+static void free_hdrs_buf(struct ubi_device *ubi)
+{
+	kfree(ubi->hdrs_buf);
+	ubi->hdrs_buf = NULL;
+	ubi->hdrs_pnum = -1;
+}
+
 /**
  * scan_all - scan entire MTD device.
  * @ubi: UBI device description object
@@ -1242,6 +1266,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	if (!vidh)
 		goto out_ech;
 
+	alloc_hdrs_buf(ubi);
 	for (pnum = start; pnum < ubi->peb_count; pnum++) {
 		cond_resched();
 
@@ -1250,6 +1275,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		if (err < 0)
 			goto out_vidh;
 	}
+	free_hdrs_buf(ubi);
 
 	ubi_msg(ubi, "scanning is finished");
 
@@ -1294,6 +1320,7 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	return 0;
 
 out_vidh:
+	free_hdrs_buf(ubi);
 	ubi_free_vid_hdr(ubi, vidh);
 out_ech:
 	kfree(ech);
@@ -1351,6 +1378,7 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 	if (!vidh)
 		goto out_ech;
 
+	alloc_hdrs_buf(ubi);
 	for (pnum = 0; pnum < UBI_FM_MAX_START; pnum++) {
 		int vol_id = -1;
 		unsigned long long sqnum = -1;
@@ -1367,6 +1395,7 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 		}
 	}
 
+	free_hdrs_buf(ubi);
 	ubi_free_vid_hdr(ubi, vidh);
 	kfree(ech);
 
@@ -1381,6 +1410,7 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info **ai)
 	return ubi_scan_fastmap(ubi, *ai, fm_anchor);
 
 out_vidh:
+	free_hdrs_buf(ubi);
 	ubi_free_vid_hdr(ubi, vidh);
 out_ech:
 	kfree(ech);
@@ -1400,9 +1430,14 @@ out:
  */
 int ubi_attach(struct ubi_device *ubi, int force_scan)
 {
+	struct ubi_attach_stats *stats = &ubi->attach_stats;
+	unsigned long start, step;
 	int err;
 	struct ubi_attach_info *ai;
 
+	memset(stats, 0, sizeof(*stats));
+	start = timer_get_us();
+
 	ai = alloc_ai();
 	if (!ai)
 		return -ENOMEM;
@@ -1444,17 +1479,26 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 	ubi->mean_ec = ai->mean_ec;
 	dbg_gen("max. sequence number:       %llu", ai->max_sqnum);
 
+	step = timer_get_us();
+	stats->fastmap = !!ubi->fm;
+	stats->scan_us = step - start;
+
 	err = ubi_read_volume_table(ubi, ai);
 	if (err)
 		goto out_ai;
+	stats->vtbl_us = timer_get_us() - step;
 
+	step = timer_get_us();
 	err = ubi_wl_init(ubi, ai);
 	if (err)
 		goto out_vtbl;
+	stats->wl_us = timer_get_us() - step;
 
+	step = timer_get_us();
 	err = ubi_eba_init(ubi, ai);
 	if (err)
 		goto out_wl;
+	stats->eba_us = timer_get_us() - step;
 
 #ifdef CONFIG_MTD_UBI_FASTMAP
 	if (ubi->fm && ubi_dbg_chk_fastmap(ubi)) {
@@ -1481,6 +1525,7 @@ int ubi_attach(struct ubi_device *ubi, int force_scan)
 #endif
 
 	destroy_ai(ai);
+	stats->total_us = timer_get_us() - start;
 	return 0;
 
 out_wl:
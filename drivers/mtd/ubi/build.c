@@ -1061,6 +1061,17 @@ int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num,
 
 	spin_unlock(&ubi->wl_lock);
 
+	/*
+	 * Without a fastmap the next attach has to scan the whole device
+	 * again, unless one gets written at detach time. Don't rely on the
+	 * latter, the OS may well be booted without detaching.
+	 */
+	if (IS_ENABLED(CONFIG_MTD_UBI_FASTMAP_WRITE_ON_SCAN) && !ubi->fm) {
+		err = ubi_update_fastmap(ubi);
+		if (err)
+			ubi_warn(ubi, "unable to write a fastmap: %d", err);
+	}
+
 	ubi_devices[ubi_num] = ubi;
 	ubi_notify_all(ubi, UBI_VOLUME_ADDED, NULL);
 	return ubi_num;
@@ -136,6 +136,12 @@ int ubi_io_read(const struct ubi_device *ubi, void *buf, int pnum, int offset,
 	if (err)
 		return err;
 
+	if (ubi->hdrs_buf && pnum == ubi->hdrs_pnum &&
+	    offset + len <= ubi->vid_hdr_aloffset + ubi->vid_hdr_alsize) {
+		memcpy(buf, ubi->hdrs_buf + offset, len);
+		return 0;
+	}
+
 	/*
 	 * Deliberately corrupt the buffer to improve robustness. Indeed, if we
 	 * do not do this, the following may happen:
@@ -211,6 +217,39 @@ retry:
 	return err;
 }
 
+/**
+ * ubi_io_prefetch_hdrs - read the EC and VID headers of a PEB at once.
+ * @ubi: UBI device description object
+ * @pnum: physical eraseblock number to read from
+ *
+ * When attaching by scanning, the EC and VID headers of every PEB are read
+ * one after the other. This function fetches the area holding both of them
+ * with a single MTD read into @ubi->hdrs_buf, so that the following
+ * ubi_io_read_ec_hdr() and ubi_io_read_vid_hdr() calls for @pnum are served
+ * from memory. Nothing is kept if the read fails or reports bitflips. The
+ * MTD layer does not say which header the bitflips were in, so the headers
+ * are then read separately and each one gets its own result. This avoids
+ * scrubbing a PEB because of bitflips in the other header's page.
+ */
+void ubi_io_prefetch_hdrs(struct ubi_device *ubi, int pnum)
+{
+	int len = ubi->vid_hdr_aloffset + ubi->vid_hdr_alsize;
+	size_t read = 0;
+	loff_t addr;
+	int err;
+
+	ubi->hdrs_pnum = -1;
+	if (!ubi->hdrs_buf)
+		return;
+
+	addr = (loff_t)pnum * ubi->peb_size;
+	err = mtd_read(ubi->mtd, addr, len, &read, ubi->hdrs_buf);
+	if (err || read != len)
+		return;
+
+	ubi->hdrs_pnum = pnum;
+}
+
 /**
  * ubi_io_write - write data to a physical eraseblock.
  * @ubi: UBI device description object
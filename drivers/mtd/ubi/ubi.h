@@ -416,6 +416,26 @@ struct ubi_debug_info {
 	struct dentry *dfs_power_cut_max;
 };
 
+/**
+ * struct ubi_attach_stats - where the time went while attaching a device.
+ * @fastmap: non-zero if the device was attached from a fastmap
+ * @scanned_pebs: number of PEBs whose headers were read
+ * @scan_us: time spent looking for a fastmap and scanning PEBs
+ * @vtbl_us: time spent reading the volume table
+ * @wl_us: time spent initializing the wear-leveling sub-system
+ * @eba_us: time spent initializing the EBA sub-system
+ * @total_us: total time spent in ubi_attach()
+ */
+struct ubi_attach_stats {
+	int fastmap;
+	int scanned_pebs;
+	unsigned long scan_us;
+	unsigned long vtbl_us;
+	unsigned long wl_us;
+	unsigned long eba_us;
+	unsigned long total_us;
+};
+
 /**
  * struct ubi_device - UBI device description structure
  * @dev: UBI device object to use the the Linux device model
@@ -529,6 +549,10 @@ struct ubi_debug_info {
  * @buf_mutex: protects @peb_buf
  * @ckvol_mutex: serializes static volume checking when opening
  *
+ * @hdrs_buf: EC and VID headers of PEB @hdrs_pnum, prefetched while attaching
+ * @hdrs_pnum: PEB whose headers are in @hdrs_buf, %-1 if none
+ * @attach_stats: time spent in the different steps of attaching
+ *
  * @dbg: debugging information for this UBI device
  */
 struct ubi_device {
@@ -628,6 +652,10 @@ struct ubi_device {
 	struct mutex buf_mutex;
 	struct mutex ckvol_mutex;
 
+	void *hdrs_buf;
+	int hdrs_pnum;
+	struct ubi_attach_stats attach_stats;
+
 	struct ubi_debug_info dbg;
 };
 
@@ -886,6 +914,7 @@ int ubi_ensure_anchor_pebs(struct ubi_device *ubi);
 /* io.c */
 int ubi_io_read(const struct ubi_device *ubi, void *buf, int pnum, int offset,
 		int len);
+void ubi_io_prefetch_hdrs(struct ubi_device *ubi, int pnum);
 int ubi_io_write(struct ubi_device *ubi, const void *buf, int pnum, int offset,
 		 int len);
 int ubi_io_sync_erase(struct ubi_device *ubi, int pnum, int torture);
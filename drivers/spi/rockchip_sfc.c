@@ -9,6 +9,7 @@
  */
 
 #include <asm/io.h>
+#include <asm/cache.h>
 #include <bouncebuf.h>
 #include <clk.h>
 #include <dm.h>
@@ -531,7 +532,8 @@ static int rockchip_sfc_xfer_data_dma(struct rockchip_sfc *sfc,
 		return ret;
 
 	ret = rockchip_sfc_fifo_transfer_dma(sfc, (dma_addr_t)bb.bounce_buffer, len);
-	rockchip_sfc_wait_for_dma_finished(sfc, len * 10);
+	if (rockchip_sfc_wait_for_dma_finished(sfc, len * 10))
+		ret = -ETIMEDOUT;
 	bounce_buffer_stop(&bb);
 
 	return ret;
@@ -589,6 +591,49 @@ static int rockchip_sfc_adjust_op_size(struct spi_slave *mem, struct spi_mem_op
 	return 0;
 }
 
+static int rockchip_sfc_dirmap_create(struct spi_mem_dirmap_desc *desc)
+{
+	struct rockchip_sfc *sfc = dev_get_plat(desc->slave->dev->parent);
+
+	/* Only reads are streamed, writes are page sized anyway */
+	if (!sfc->use_dma || desc->info.op_tmpl.data.dir != SPI_MEM_DATA_IN)
+		return -EOPNOTSUPP;
+
+	return 0;
+}
+
+static ssize_t rockchip_sfc_dirmap_read(struct spi_mem_dirmap_desc *desc,
+					u64 offs, size_t len, void *buf)
+{
+	struct rockchip_sfc *sfc = dev_get_plat(desc->slave->dev->parent);
+	struct spi_mem_op op = desc->info.op_tmpl;
+	ulong start = (ulong)buf;
+	u32 nbytes;
+	int ret;
+
+	/*
+	 * Read an unaligned head or a short tail through the FIFO and let
+	 * the controller DMA everything in between straight into @buf, so
+	 * that large reads never end up in a bounce buffer.
+	 */
+	nbytes = min_t(size_t, len, sfc->max_iosize);
+	if (!IS_ALIGNED(start, ARCH_DMA_MINALIGN))
+		nbytes = min_t(u32, nbytes,
+			       ALIGN(start, ARCH_DMA_MINALIGN) - start);
+	else if (nbytes >= ARCH_DMA_MINALIGN)
+		nbytes = ALIGN_DOWN(nbytes, ARCH_DMA_MINALIGN);
+
+	op.addr.val = desc->info.offset + offs;
+	op.data.buf.in = buf;
+	op.data.nbytes = nbytes;
+
+	ret = rockchip_sfc_exec_op(desc->slave, &op);
+	if (ret)
+		return ret;
+
+	return nbytes;
+}
+
 static int rockchip_sfc_set_speed(struct udevice *bus, uint speed)
 {
 	struct rockchip_sfc *sfc = dev_get_plat(bus);
@@ -622,6 +667,8 @@ static int rockchip_sfc_set_mode(struct udevice *bus, uint mode)
 static const struct spi_controller_mem_ops rockchip_sfc_mem_ops = {
 	.adjust_op_size	= rockchip_sfc_adjust_op_size,
 	.exec_op	= rockchip_sfc_exec_op,
+	.dirmap_create	= rockchip_sfc_dirmap_create,
+	.dirmap_read	= rockchip_sfc_dirmap_read,
 };
 
 static const struct dm_spi_ops rockchip_sfc_ops = {
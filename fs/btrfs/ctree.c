@@ -684,6 +684,9 @@ int btrfs_next_sibling_tree_block(struct btrfs_fs_info *fs_info,
 			continue;
 		}
 
+		/* Walking leaves in order, pull in the following ones too */
+		if (level == 1)
+			readahead_tree_blocks(fs_info, c, slot);
 		next = read_node_slot(fs_info, c, slot);
 		if (!extent_buffer_uptodate(next))
 			return -EIO;
@@ -698,6 +701,8 @@ int btrfs_next_sibling_tree_block(struct btrfs_fs_info *fs_info,
 		path->slots[level] = 0;
 		if (level == path->lowest_level)
 			break;
+		if (level == 1)
+			readahead_tree_blocks(fs_info, next, 0);
 		next = read_node_slot(fs_info, next, 0);
 		if (!extent_buffer_uptodate(next))
 			return -EIO;
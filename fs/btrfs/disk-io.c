@@ -534,10 +534,99 @@ struct extent_buffer* read_tree_block(struct btrfs_fs_info *fs_info, u64 bytenr,
 	 * We failed to read this tree block, it be should deleted right now
 	 * to avoid stale cache populate the cache.
 	 */
-	free_extent_buffer(eb);
+	free_extent_buffer_nocache(eb);
 	return ERR_PTR(ret);
 }
 
+/*
+ * Read the tree blocks pointed to by @parent, starting from @slot, with a
+ * single device read as long as they are contiguous on disk, and put the
+ * good ones into the extent buffer cache.
+ *
+ * This is only a hint to speed up walking leaves in key order: any block
+ * which can't be read or verified here is left for read_tree_block().
+ */
+void readahead_tree_blocks(struct btrfs_fs_info *fs_info,
+			   struct extent_buffer *parent, int slot)
+{
+	u16 csum_size = btrfs_super_csum_size(fs_info->super_copy);
+	u16 csum_type = btrfs_super_csum_type(fs_info->super_copy);
+	u32 nodesize = fs_info->nodesize;
+	int nritems = btrfs_header_nritems(parent);
+	struct btrfs_multi_bio *multi = NULL;
+	struct btrfs_device *device;
+	struct extent_buffer *eb;
+	char *buf = NULL;
+	u64 bytenr;
+	u64 len;
+	int nr;
+	int i;
+
+	if (!btrfs_header_level(parent) || slot < 0 || slot >= nritems)
+		return;
+
+	/* Already cached, most likely by a previous readahead */
+	bytenr = btrfs_node_blockptr(parent, slot);
+	eb = btrfs_find_tree_block(fs_info, bytenr, nodesize);
+	if (eb) {
+		i = extent_buffer_uptodate(eb);
+		free_extent_buffer(eb);
+		if (i)
+			return;
+	}
+
+	for (nr = 1; nr < BTRFS_READAHEAD_BLOCKS && slot + nr < nritems; nr++) {
+		if (btrfs_node_blockptr(parent, slot + nr) !=
+		    bytenr + nr * nodesize)
+			break;
+	}
+	if (nr < 2)
+		return;
+
+	len = nr * nodesize;
+	if (btrfs_map_block(fs_info, READ, bytenr, &len, &multi, 1, NULL))
+		goto out;
+	nr = min_t(u64, len, nr * nodesize) / nodesize;
+	device = multi->stripes[0].dev;
+	if (nr < 2 || !device->desc || !device->part)
+		goto out;
+
+	buf = malloc_cache_aligned(nr * nodesize);
+	if (!buf)
+		goto out;
+	if (__btrfs_devread(device->desc, device->part, buf, nr * nodesize,
+			    multi->stripes[0].physical) != nr * nodesize)
+		goto out;
+
+	for (i = 0; i < nr; i++) {
+		u64 generation = btrfs_node_ptr_generation(parent, slot + i);
+
+		eb = btrfs_find_create_tree_block(fs_info, bytenr + i * nodesize);
+		if (!eb)
+			break;
+		if (extent_buffer_uptodate(eb) || eb->refs > 1) {
+			free_extent_buffer(eb);
+			continue;
+		}
+		write_extent_buffer(eb, buf + i * nodesize, 0, nodesize);
+		if (__csum_tree_block_size(eb, csum_size, 1, 1, csum_type) ||
+		    check_tree_block(fs_info, eb) ||
+		    btrfs_header_generation(eb) != generation ||
+		    btrfs_header_level(eb) != btrfs_header_level(parent) - 1 ||
+		    (btrfs_header_level(eb) ?
+		     btrfs_check_node(fs_info, NULL, eb) :
+		     btrfs_check_leaf(fs_info, NULL, eb))) {
+			free_extent_buffer_nocache(eb);
+			continue;
+		}
+		btrfs_set_buffer_uptodate(eb);
+		free_extent_buffer(eb);
+	}
+out:
+	free(buf);
+	kfree(multi);
+}
+
 int read_extent_data(struct btrfs_fs_info *fs_info, char *data, u64 logical,
 		     u64 *len, int mirror)
 {
@@ -10,10 +10,15 @@
 #define BTRFS_SUPER_INFO_OFFSET SZ_64K
 #define BTRFS_SUPER_INFO_SIZE	SZ_4K
 
+/* Max number of tree blocks read in one go by readahead_tree_blocks() */
+#define BTRFS_READAHEAD_BLOCKS	8
+
 /* From btrfs-progs */
 int read_whole_eb(struct btrfs_fs_info *info, struct extent_buffer *eb, int mirror);
 struct extent_buffer* read_tree_block(struct btrfs_fs_info *fs_info, u64 bytenr,
 		u64 parent_transid);
+void readahead_tree_blocks(struct btrfs_fs_info *fs_info,
+			   struct extent_buffer *parent, int slot);
 
 int read_extent_data(struct btrfs_fs_info *fs_info, char *data, u64 logical,
 		     u64 *len, int mirror);
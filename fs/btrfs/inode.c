@@ -478,7 +478,15 @@ int btrfs_read_extent_reg(struct btrfs_path *path,
 	num_copies = btrfs_num_copies(fs_info, disk_bytenr, csize);
 
 	cbuf = malloc_cache_aligned(csize);
-	dbuf = malloc_cache_aligned(dsize);
+	/*
+	 * If the whole decompressed extent is wanted, decompress straight into
+	 * @dest instead of going through a bounce buffer.
+	 */
+	if (btrfs_file_extent_offset(leaf, fi) + offset == key.offset &&
+	    len == dsize)
+		dbuf = dest;
+	else
+		dbuf = malloc_cache_aligned(dsize);
 	if (!cbuf || !dbuf) {
 		ret = -ENOMEM;
 		goto out;
@@ -511,13 +519,14 @@ int btrfs_read_extent_reg(struct btrfs_path *path,
 	if (ret < dsize)
 		memset(dbuf + ret, 0, dsize - ret);
 	/* Then copy the needed part */
-	memcpy(dest,
-	       dbuf + btrfs_file_extent_offset(leaf, fi) + offset - key.offset,
-	       len);
+	if (dbuf != dest)
+		memcpy(dest, dbuf + btrfs_file_extent_offset(leaf, fi) +
+		       offset - key.offset, len);
 	ret = len;
 out:
 	free(cbuf);
-	free(dbuf);
+	if (dbuf != dest)
+		free(dbuf);
 	return ret;
 }
 
@@ -26,6 +26,7 @@
 #include <malloc.h>
 #include <memalign.h>
 #include <part.h>
+#include <slab.h>
 #include <stddef.h>
 #include <linux/stat.h>
 #include <linux/time.h>
@@ -47,6 +48,8 @@ int ext4fs_indir3_blkno = -1;
 struct ext2_inode *g_parent_inode;
 static int symlinknest;
 
+SLAB_CACHE(ext4_node, struct ext2fs_node);
+
 #if defined(CONFIG_EXT4_WRITE)
 struct ext2_block_group *ext4fs_get_group_descriptor
 	(const struct ext_filesystem *fs, uint32_t bg_idx)
@@ -2092,7 +2095,7 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 			if (status < 0)
 				return 0;
 
-			fdiro = zalloc(sizeof(struct ext2fs_node));
+			fdiro = slab_alloc(SLAB_CACHE_GET(ext4_node));
 			if (!fdiro)
 				return 0;
 
@@ -2116,7 +2119,7 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 							   (dirent.inode),
 							   &fdiro->inode);
 				if (status == 0) {
-					free(fdiro);
+					slab_free(SLAB_CACHE_GET(ext4_node), fdiro);
 					return 0;
 				}
 				fdiro->inode_read = 1;
@@ -2152,7 +2155,8 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 								 dirent.inode),
 								 &fdiro->inode);
 					if (status == 0) {
-						free(fdiro);
+						slab_free(SLAB_CACHE_GET(ext4_node),
+							  fdiro);
 						return 0;
 					}
 					fdiro->inode_read = 1;
@@ -2175,7 +2179,7 @@ int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 				       le32_to_cpu(fdiro->inode.size),
 					filename);
 			}
-			free(fdiro);
+			slab_free(SLAB_CACHE_GET(ext4_node), fdiro);
 		}
 		fpos += le16_to_cpu(dirent.direntlen);
 	}
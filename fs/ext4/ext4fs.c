@@ -28,6 +28,7 @@
 #include <div64.h>
 #include <malloc.h>
 #include <part.h>
+#include <slab.h>
 #include <uuid.h>
 
 int ext4fs_symlinknest;
@@ -41,7 +42,7 @@ struct ext_filesystem *get_fs(void)
 void ext4fs_free_node(struct ext2fs_node *node, struct ext2fs_node *currroot)
 {
 	if ((node != &ext4fs_root->diropen) && (node != currroot))
-		free(node);
+		slab_free(SLAB_CACHE_GET(ext4_node), node);
 }
 
 /*
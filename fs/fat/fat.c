@@ -11,6 +11,7 @@
 #define LOG_CATEGORY	LOGC_FS
 
 #include <common.h>
+#include <arena.h>
 #include <blk.h>
 #include <config.h>
 #include <exports.h>
@@ -1170,7 +1171,7 @@ int fat_exists(const char *filename)
 	fat_itr *itr;
 	int ret;
 
-	itr = malloc_cache_aligned(sizeof(fat_itr));
+	itr = arena_alloc(sizeof(fat_itr));
 	if (!itr)
 		return 0;
 	ret = fat_itr_root(itr, &fsdata);
@@ -1180,7 +1181,7 @@ int fat_exists(const char *filename)
 	ret = fat_itr_resolve(itr, filename, TYPE_ANY);
 	free(fsdata.fatbuf);
 out:
-	free(itr);
+	arena_free(itr);
 	return ret == 0;
 }
 
@@ -1212,7 +1213,7 @@ int fat_size(const char *filename, loff_t *size)
 	fat_itr *itr;
 	int ret;
 
-	itr = malloc_cache_aligned(sizeof(fat_itr));
+	itr = arena_alloc(sizeof(fat_itr));
 	if (!itr)
 		return -ENOMEM;
 	ret = fat_itr_root(itr, &fsdata);
@@ -1239,7 +1240,7 @@ int fat_size(const char *filename, loff_t *size)
 out_free_both:
 	free(fsdata.fatbuf);
 out_free_itr:
-	free(itr);
+	arena_free(itr);
 	return ret;
 }
 
@@ -1250,7 +1251,7 @@ int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 	fat_itr *itr;
 	int ret;
 
-	itr = malloc_cache_aligned(sizeof(fat_itr));
+	itr = arena_alloc(sizeof(fat_itr));
 	if (!itr)
 		return -ENOMEM;
 	ret = fat_itr_root(itr, &fsdata);
@@ -1271,7 +1272,7 @@ int fat_read_file(const char *filename, void *buf, loff_t offset, loff_t len,
 out_free_both:
 	free(fsdata.fatbuf);
 out_free_itr:
-	free(itr);
+	arena_free(itr);
 	return ret;
 }
 
@@ -1338,7 +1338,7 @@ int file_fat_write_at(const char *filename, loff_t pos, void *buffer,
 		goto exit;
 	}
 
-	itr = malloc_cache_aligned(sizeof(fat_itr));
+	itr = arena_alloc(sizeof(fat_itr));
 	if (!itr) {
 		ret = -ENOMEM;
 		goto exit;
@@ -1432,7 +1432,7 @@ int file_fat_write_at(const char *filename, loff_t pos, void *buffer,
 exit:
 	free(filename_copy);
 	free(mydata->fatbuf);
-	free(itr);
+	arena_free(itr);
 	return ret;
 }
 
@@ -1571,7 +1571,7 @@ int fat_unlink(const char *filename)
 	char *filename_copy, *dirname, *basename;
 
 	filename_copy = strdup(filename);
-	itr = malloc_cache_aligned(sizeof(fat_itr));
+	itr = arena_alloc(sizeof(fat_itr));
 	if (!itr || !filename_copy) {
 		printf("Error: out of memory\n");
 		ret = -ENOMEM;
@@ -1622,7 +1622,7 @@ int fat_unlink(const char *filename)
 
 exit:
 	free(fsdata.fatbuf);
-	free(itr);
+	arena_free(itr);
 	free(filename_copy);
 
 	return ret;
@@ -1657,7 +1657,7 @@ int fat_mkdir(const char *dirname)
 		goto exit;
 	}
 
-	itr = malloc_cache_aligned(sizeof(fat_itr));
+	itr = arena_alloc(sizeof(fat_itr));
 	if (!itr) {
 		ret = -ENOMEM;
 		goto exit;
@@ -1766,7 +1766,7 @@ int fat_mkdir(const char *dirname)
 exit:
 	free(dirname_copy);
 	free(mydata->fatbuf);
-	free(itr);
+	arena_free(itr);
 	free(dotdent);
 	return ret;
 }
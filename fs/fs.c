@@ -5,6 +5,7 @@
 
 #define LOG_CATEGORY LOGC_CORE
 
+#include <bootstage.h>
 #include <command.h>
 #include <config.h>
 #include <display_options.h>
@@ -25,6 +26,7 @@
 #include <btrfs.h>
 #include <asm/global_data.h>
 #include <asm/io.h>
+#include <dm/device.h>
 #include <div64.h>
 #include <linux/math64.h>
 #include <linux/sizes.h>
@@ -553,7 +555,9 @@ static int fs_read_lmb_check(const char *filename, ulong addr, loff_t offset,
 	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
 	lmb_dump_all(&lmb);
 
-	if (lmb_alloc_addr(&lmb, addr, read_len) == addr)
+	ret = lmb_alloc_addr(&lmb, addr, read_len) == addr;
+	lmb_uninit(&lmb);
+	if (ret)
 		return 0;
 
 	log_err("** Reading file would overwrite reserved memory **\n");
@@ -561,12 +565,49 @@ static int fs_read_lmb_check(const char *filename, ulong addr, loff_t offset,
 }
 #endif
 
+#if defined(ENABLE_BOOTSTAGE_SPANS) && CONFIG_IS_ENABLED(BLK)
+/*
+ * Names of the block devices read from. Bootstage keeps the name of a span's
+ * device until it is relocated or stashed, by which time the device may have
+ * been unbound, so the names are copied here.
+ */
+static char fs_dev_names[8][32];
+
+/* Get the name of the block device in use, for bootstage */
+static const char *fs_dev_name(void)
+{
+	const char *name;
+	int i;
+
+	if (!fs_dev_desc || !fs_dev_desc->bdev)
+		return NULL;
+	name = fs_dev_desc->bdev->name;
+
+	for (i = 0; i < ARRAY_SIZE(fs_dev_names); i++) {
+		char *buf = fs_dev_names[i];
+
+		if (!*buf)
+			strlcpy(buf, name, sizeof(fs_dev_names[i]));
+		if (!strncmp(buf, name, sizeof(fs_dev_names[i]) - 1))
+			return buf;
+	}
+
+	/* Too many devices; the span just has no device name */
+	return NULL;
+}
+#else
+static const char *fs_dev_name(void)
+{
+	return NULL;
+}
+#endif
+
 static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 		    int do_lmb_check, loff_t *actread)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
 	void *buf;
-	int ret;
+	int ret, span;
 
 #ifdef CONFIG_LMB
 	if (do_lmb_check) {
@@ -581,7 +622,9 @@ static int _fs_read(const char *filename, ulong addr, loff_t offset, loff_t len,
 	 * means read the whole file.
 	 */
 	buf = map_sysmem(addr, len);
+	span = bootstage_span_begin("fs_read", fs_dev_name());
 	ret = info->read(filename, buf, offset, len, actread);
+	bootstage_span_end(span, ret ? 0 : *actread);
 	unmap_sysmem(buf);
 
 	/* If we requested a specific number of bytes, check we got it */
@@ -2299,6 +2299,8 @@ static int ubifs_fill_super(struct super_block *sb, void *data, int silent)
 	sb->s_op = &ubifs_super_operations;
 #ifndef __UBOOT__
 	sb->s_xattr = ubifs_xattr_handlers;
+#else
+	c->bulk_read = IS_ENABLED(CONFIG_UBIFS_BULK_READ);
 #endif
 
 	mutex_lock(&c->umount_mutex);
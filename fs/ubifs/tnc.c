@@ -30,6 +30,7 @@
 #include <linux/compat.h>
 #include <linux/err.h>
 #include <linux/stat.h>
+#include <sort.h>
 #endif
 #include "ubifs.h"
 
@@ -1177,7 +1178,11 @@ int ubifs_lookup_level0(struct ubifs_info *c, const union ubifs_key *key,
 {
 	int err, exact;
 	struct ubifs_znode *znode;
+#ifndef __UBOOT__
 	unsigned long time = get_seconds();
+#else
+	unsigned long time = ++c->tnc_stamp;
+#endif
 
 	dbg_tnck(key, "search key ");
 	ubifs_assert(key_type(c, key) < UBIFS_INVALID_KEY);
@@ -1194,6 +1199,10 @@ int ubifs_lookup_level0(struct ubifs_info *c, const union ubifs_key *key,
 	while (1) {
 		struct ubifs_zbranch *zbr;
 
+#ifdef __UBOOT__
+		/* The shrinker frees the least recently used znodes first */
+		znode->time = time;
+#endif
 		exact = ubifs_search_zbranch(c, znode, key, n);
 
 		if (znode->level == 0)
@@ -1313,7 +1322,11 @@ static int lookup_level0_dirty(struct ubifs_info *c, const union ubifs_key *key,
 {
 	int err, exact;
 	struct ubifs_znode *znode;
+#ifndef __UBOOT__
 	unsigned long time = get_seconds();
+#else
+	unsigned long time = ++c->tnc_stamp;
+#endif
 
 	dbg_tnck(key, "search and dirty key ");
 
@@ -2895,6 +2908,98 @@ void ubifs_tnc_close(struct ubifs_info *c)
 	destroy_old_idx(c);
 }
 
+#ifdef __UBOOT__
+/**
+ * tnc_evictable - check whether a znode may be dropped from the TNC.
+ * @zn: znode to check
+ *
+ * The root, dirty znodes and znodes with children in the TNC are kept.
+ */
+static int tnc_evictable(struct ubifs_znode *zn)
+{
+	int n;
+
+	if (!zn->parent || zn->cnext || ubifs_zn_dirty(zn))
+		return 0;
+	if (zn->level == 0)
+		return 1;
+	for (n = 0; n < zn->child_cnt; n++)
+		if (zn->zbranch[n].znode)
+			return 0;
+
+	return 1;
+}
+
+static int tnc_cmp_time(const void *a, const void *b)
+{
+	const struct ubifs_znode *za = *(struct ubifs_znode **)a;
+	const struct ubifs_znode *zb = *(struct ubifs_znode **)b;
+
+	if (za->time == zb->time)
+		return 0;
+
+	return za->time < zb->time ? -1 : 1;
+}
+
+/**
+ * ubifs_shrink_tnc - free the least recently used clean znodes.
+ * @c: UBIFS file-system description object
+ * @max_size: maximum amount of memory clean znodes may use, in bytes
+ *
+ * Once clean znodes use more than @max_size, free the least recently used
+ * ones until they use no more than three quarters of it, so that this does
+ * not happen again on the next lookup. Only znodes with no children in the
+ * TNC are freed. Their parents may be freed by a later pass if that is not
+ * enough. Freed znodes are read from the flash again when needed.
+ * Returns the number of freed znodes.
+ */
+long ubifs_shrink_tnc(struct ubifs_info *c, unsigned long max_size)
+{
+	unsigned long target = max_size / 4 * 3 / c->max_znode_sz;
+	struct ubifs_znode **list, *zn;
+	long total_freed = 0;
+	long cnt, i;
+
+	if (!c->zroot.znode ||
+	    atomic_long_read(&c->clean_zn_cnt) * c->max_znode_sz <= max_size)
+		return 0;
+
+	while (atomic_long_read(&c->clean_zn_cnt) > target) {
+		cnt = 0;
+		zn = ubifs_tnc_postorder_first(c->zroot.znode);
+		for (; zn; zn = ubifs_tnc_postorder_next(zn))
+			cnt += tnc_evictable(zn);
+		if (!cnt)
+			break;
+
+		list = malloc(cnt * sizeof(*list));
+		if (!list)
+			break;
+		i = 0;
+		zn = ubifs_tnc_postorder_first(c->zroot.znode);
+		for (; zn; zn = ubifs_tnc_postorder_next(zn))
+			if (tnc_evictable(zn))
+				list[i++] = zn;
+		qsort(list, cnt, sizeof(*list), tnc_cmp_time);
+
+		for (i = 0; i < cnt &&
+		     atomic_long_read(&c->clean_zn_cnt) > target; i++) {
+			long freed;
+
+			zn = list[i];
+			zn->parent->zbranch[zn->iip].znode = NULL;
+			freed = ubifs_destroy_tnc_subtree(zn);
+			atomic_long_sub(freed, &ubifs_clean_zn_cnt);
+			atomic_long_sub(freed, &c->clean_zn_cnt);
+			total_freed += freed;
+		}
+		free(list);
+	}
+
+	return total_freed;
+}
+#endif
+
 /**
  * left_znode - get the znode to the left.
  * @c: UBIFS file-system description object
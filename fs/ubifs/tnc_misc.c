@@ -428,7 +428,11 @@ struct ubifs_znode *ubifs_load_znode(struct ubifs_info *c,
 
 	zbr->znode = znode;
 	znode->parent = parent;
+#ifndef __UBOOT__
 	znode->time = get_seconds();
+#else
+	znode->time = c->tnc_stamp;
+#endif
 	znode->iip = iip;
 
 	return znode;
@@ -826,6 +826,68 @@ error:
 	return err;
 }
 
+/*
+ * Read up to @nblocks full data blocks of @inode, starting at @block, into
+ * @addr with a single UBI read of the data nodes which follow each other in
+ * the same LEB. Holes are zeroed.
+ *
+ * Returns the number of blocks filled in, or 0 if nothing could be read in
+ * bulk, in which case the caller falls back to reading one block at a time.
+ */
+static int do_bulk_read(struct ubifs_info *c, struct inode *inode, void *addr,
+			unsigned int block, unsigned int nblocks)
+{
+	struct bu_info *bu = &c->bu;
+	int i, nn = 0, err, offs;
+
+	bu->buf_len = c->max_bu_buf_len;
+	data_key_init(c, &bu->key, inode->i_ino, block);
+	err = ubifs_tnc_get_bu_keys(c, bu);
+	if (err || !bu->cnt)
+		goto out;
+
+	err = ubifs_tnc_bulk_read(c, bu);
+	if (err)
+		goto out;
+
+	nblocks = min_t(unsigned int, nblocks, bu->blk_cnt);
+	offs = bu->zbranch[0].offs;
+	for (i = 0; i < nblocks; i++, addr += UBIFS_BLOCK_SIZE) {
+		struct ubifs_data_node *dn;
+		int len, out_len, dlen;
+
+		if (nn >= bu->cnt ||
+		    key_block(c, &bu->zbranch[nn].key) != block + i) {
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+			continue;
+		}
+
+		dn = bu->buf + (bu->zbranch[nn++].offs - offs);
+		len = le32_to_cpu(dn->size);
+		if (len <= 0 || len > UBIFS_BLOCK_SIZE)
+			return i;
+
+		dlen = le32_to_cpu(dn->ch.len) - UBIFS_DATA_NODE_SZ;
+		out_len = UBIFS_BLOCK_SIZE;
+		err = ubifs_decompress(c, &dn->data, dlen, addr, &out_len,
+				       le16_to_cpu(dn->compr_type));
+		/* Let the regular path report broken nodes */
+		if (err || len != out_len)
+			return i;
+
+		if (len < UBIFS_BLOCK_SIZE)
+			memset(addr + len, 0, UBIFS_BLOCK_SIZE - len);
+	}
+
+	return nblocks;
+
+out:
+	if (err)
+		ubifs_warn(c, "ignoring error %d and skipping bulk-read", err);
+	return 0;
+}
+
 int ubifs_read(const char *filename, void *buf, loff_t offset,
 	       loff_t size, loff_t *actread)
 {
@@ -847,6 +909,8 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 	}
 
 	c->ubi = ubi_open_volume(c->vi.ubi_num, c->vi.vol_id, UBI_READONLY);
+	if (CONFIG_UBIFS_TNC_CACHE_SIZE)
+		ubifs_shrink_tnc(c, CONFIG_UBIFS_TNC_CACHE_SIZE);
 	/* ubifs_findfile will resolve symlinks, so we know that we get
 	 * the real file here */
 	inum = ubifs_findfile(ubifs_sb, (char *)filename);
@@ -891,6 +955,23 @@ int ubifs_read(const char *filename, void *buf, loff_t offset,
 		if (((i + 1) == count) && (size < inode->i_size))
 			last_block_size = size - (i * PAGE_SIZE);
 
+		/*
+		 * Read full pages in bulk when possible, the last one is
+		 * always left to do_readpage() so as not to write past the
+		 * requested size.
+		 */
+		if (c->bulk_read && (i + 1) < count) {
+			int n = do_bulk_read(c, inode, page.addr, page.index,
+					     count - i - 1);
+
+			if (n) {
+				i += n - 1;
+				page.addr += n * PAGE_SIZE;
+				page.index += n;
+				continue;
+			}
+		}
+
 		err = do_readpage(c, inode, &page, last_block_size);
 		if (err)
 			break;
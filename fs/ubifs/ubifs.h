@@ -1354,7 +1354,7 @@ struct ubifs_zbranch {
  * @parent: parent znode or NULL if it is the root
  * @cnext: next znode to commit
  * @flags: znode flags (%DIRTY_ZNODE, %COW_ZNODE or %OBSOLETE_ZNODE)
- * @time: last access time (seconds)
+ * @time: last access time (seconds, or value of @c->tnc_stamp in U-Boot)
  * @level: level of the entry in the TNC tree
  * @child_cnt: count of child znodes
  * @iip: index in parent's zbranch array
@@ -1701,6 +1701,8 @@ struct ubifs_debug_info;
  * @dirty_pg_cnt: number of dirty pages (not used)
  * @dirty_zn_cnt: number of dirty znodes
  * @clean_zn_cnt: number of clean znodes
+ * @tnc_stamp: access counter used as the @time of znodes in U-Boot, which
+ *             has no clock for them
  *
  * @space_lock: protects @bi and @lst
  * @lst: lprops statistics
@@ -1938,6 +1940,9 @@ struct ubifs_info {
 	atomic_long_t dirty_pg_cnt;
 	atomic_long_t dirty_zn_cnt;
 	atomic_long_t clean_zn_cnt;
+#ifdef __UBOOT__
+	unsigned long tnc_stamp;
+#endif
 
 	spinlock_t space_lock;
 	struct ubifs_lp_stats lst;
@@ -2217,6 +2222,9 @@ int is_idx_node_in_tnc(struct ubifs_info *c, union ubifs_key *key, int level,
 int insert_old_idx_znode(struct ubifs_info *c, struct ubifs_znode *znode);
 int ubifs_tnc_get_bu_keys(struct ubifs_info *c, struct bu_info *bu);
 int ubifs_tnc_bulk_read(struct ubifs_info *c, struct bu_info *bu);
+#ifdef __UBOOT__
+long ubifs_shrink_tnc(struct ubifs_info *c, unsigned long max_size);
+#endif
 
 /* tnc_misc.c */
 struct ubifs_znode *ubifs_tnc_levelorder_next(struct ubifs_znode *zr,
@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Scoped arena for short-lived allocations
+ *
+ * Buffers which only live for the length of an operation, such as a command
+ * or one step of a bootflow scan, can be taken from the arena rather than the
+ * malloc() heap. They are carved out of a few large chunks which are all
+ * released when the scope is popped, so they do not leave holes in the heap
+ * between longer-lived allocations.
+ *
+ * Outside any scope, arena_alloc() and arena_free() are the same as
+ * malloc_cache_aligned() and free(), so code can use them without knowing
+ * whether its caller has pushed a scope.
+ */
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <malloc.h>
+#include <memalign.h>
+#include <linux/string.h>
+#include <linux/types.h>
+
+/**
+ * struct arena_stats - Information about the arena
+ *
+ * @depth: Number of scopes currently pushed
+ * @chunks: Number of chunks held
+ * @size: Total size of the chunks in bytes
+ * @used: Bytes handed out from the chunks
+ * @peak: Largest value of @size so far
+ */
+struct arena_stats {
+	uint depth;
+	uint chunks;
+	ulong size;
+	ulong used;
+	ulong peak;
+};
+
+#if CONFIG_IS_ENABLED(ARENA)
+/**
+ * arena_push() - Start a new scope
+ *
+ * Return: depth of the new scope, to pass to arena_pop(), or -EAGAIN if the
+ *	full malloc() heap is not ready yet, -ENOSPC if too many scopes are
+ *	pushed. In either case allocations go to the current scope (if any) and
+ *	arena_pop() does nothing.
+ */
+int arena_push(void);
+
+/**
+ * arena_pop() - End a scope, releasing everything allocated in it
+ *
+ * Any scopes pushed inside this one which are still open are ended too
+ *
+ * @depth: Value returned by arena_push()
+ */
+void arena_pop(int depth);
+
+/**
+ * arena_alloc() - Allocate memory which lasts until the end of the scope
+ *
+ * @size: Number of bytes needed
+ * Return: pointer to memory aligned to ARCH_DMA_MINALIGN, or NULL if out of
+ *	memory
+ */
+void *arena_alloc(size_t size);
+
+/**
+ * arena_free() - Free memory from arena_alloc()
+ *
+ * If @ptr is the most recent allocation in the current scope, its space is
+ * given back so it can be used again. Other memory inside the arena is left
+ * alone until arena_pop(). Memory from outside the arena is passed to free().
+ *
+ * @ptr: Pointer to free, or NULL
+ */
+void arena_free(void *ptr);
+
+/**
+ * arena_get_stats() - Get information about the arena
+ *
+ * @stats: Returns the information
+ */
+void arena_get_stats(struct arena_stats *stats);
+#else
+static inline int arena_push(void)
+{
+	return 0;
+}
+
+static inline void arena_pop(int depth)
+{
+}
+
+static inline void *arena_alloc(size_t size)
+{
+	return malloc_cache_aligned(size);
+}
+
+static inline void arena_free(void *ptr)
+{
+	free(ptr);
+}
+
+static inline void arena_get_stats(struct arena_stats *stats)
+{
+	memset(stats, '\0', sizeof(*stats));
+}
+#endif
+
+#endif
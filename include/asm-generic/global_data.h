@@ -29,6 +29,7 @@
 #include <asm-offsets.h>
 
 struct acpi_ctx;
+struct malloc_profile;
 struct driver_rt;
 
 typedef struct global_data gd_t;
@@ -217,6 +218,18 @@ struct global_data {
 	 * @uclass_root_s.
 	 */
 	struct list_head *uclass_root;
+# if CONFIG_IS_ENABLED(DM_UCLASS_LOOKUP)
+	/** @uclass_lookup: Table of uclasses indexed by ID, see uclass_find() */
+	struct uclass_lookup *uclass_lookup;
+# endif
+# if CONFIG_IS_ENABLED(DM_COMPAT_INDEX)
+	/** @dm_compat_index: Hash index of driver compatible strings */
+	struct dm_compat_index *dm_compat_index;
+# endif
+# if CONFIG_IS_ENABLED(DM_PROBE_ASYNC)
+	/** @dm_probe_sched: State of the probe scheduler, see probe-async.h */
+	struct dm_probe_sched *dm_probe_sched;
+# endif
 # if CONFIG_IS_ENABLED(OF_PLATDATA_DRIVER_RT)
 	/** @dm_driver_rt: Dynamic info about the driver */
 	struct driver_rt *dm_driver_rt;
@@ -242,6 +255,12 @@ struct global_data {
 	 * @fdt_blob: U-Boot's own device tree, NULL if none
 	 */
 	const void *fdt_blob;
+#if CONFIG_IS_ENABLED(OF_FLAT_INDEX)
+	/**
+	 * @fdt_index: index of phandles and paths in @fdt_blob, or NULL
+	 */
+	struct fdtdec_index *fdt_index;
+#endif
 	/**
 	 * @new_fdt: relocated device tree
 	 */
@@ -321,6 +340,12 @@ struct global_data {
 	 */
 	unsigned long malloc_ptr;
 #endif
+#if CONFIG_IS_ENABLED(MALLOC_PROFILE)
+	/**
+	 * @malloc_profile: heap profiler state, or NULL if not set up yet
+	 */
+	struct malloc_profile *malloc_profile;
+#endif
 #ifdef CONFIG_PCI
 	/**
 	 * @hose: PCI hose for early use
@@ -385,6 +410,22 @@ struct global_data {
 	 */
 	struct bootstage_data *new_bootstage;
 #endif
+#if CONFIG_IS_ENABLED(INITCALL_STATS)
+	/**
+	 * @initcall_stats: time taken by each initcall, see initcall.h
+	 */
+	struct initcall_stats *initcall_stats;
+	/**
+	 * @new_initcall_stats: relocated time taken by each initcall
+	 */
+	struct initcall_stats *new_initcall_stats;
+#endif
+#if CONFIG_IS_ENABLED(INITCALL_DEFER)
+	/**
+	 * @initcall_run: state of the initcall list being run, or NULL
+	 */
+	struct initcall_run *initcall_run;
+#endif
 #ifdef CONFIG_LOG
 	/**
 	 * @log_drop_count: number of dropped log messages
@@ -522,6 +563,30 @@ static_assert(sizeof(struct global_data) == GD_SIZE);
 #define gd_set_of_root(_root)
 #endif
 
+#if CONFIG_IS_ENABLED(DM_UCLASS_LOOKUP)
+#define gd_set_uclass_lookup(table)	gd->uclass_lookup = table
+#define gd_uclass_lookup()		gd->uclass_lookup
+#else
+#define gd_set_uclass_lookup(table)
+#define gd_uclass_lookup()		((struct uclass_lookup *)NULL)
+#endif
+
+#if CONFIG_IS_ENABLED(DM_COMPAT_INDEX)
+#define gd_set_dm_compat_index(idx)	gd->dm_compat_index = idx
+#define gd_dm_compat_index()		gd->dm_compat_index
+#else
+#define gd_set_dm_compat_index(idx)
+#define gd_dm_compat_index()		NULL
+#endif
+
+#if CONFIG_IS_ENABLED(DM_PROBE_ASYNC)
+#define gd_set_dm_probe_sched(sched)	gd->dm_probe_sched = sched
+#define gd_dm_probe_sched()		gd->dm_probe_sched
+#else
+#define gd_set_dm_probe_sched(sched)
+#define gd_dm_probe_sched()		((struct dm_probe_sched *)NULL)
+#endif
+
 #if CONFIG_IS_ENABLED(OF_PLATDATA_DRIVER_RT)
 #define gd_set_dm_driver_rt(dyn)	gd->dm_driver_rt = dyn
 #define gd_dm_driver_rt()		gd->dm_driver_rt
@@ -568,7 +633,31 @@ static_assert(sizeof(struct global_data) == GD_SIZE);
 #define gd_set_multi_dtb_fit(_dtb)
 #endif
 
-#if CONFIG_IS_ENABLED(EVENT_DYNAMIC)
+#if CONFIG_IS_ENABLED(OF_FLAT_INDEX)
+#define gd_fdt_index()		gd->fdt_index
+#define gd_set_fdt_index(_idx)	gd->fdt_index = (_idx)
+#else
+#define gd_fdt_index()		NULL
+#define gd_set_fdt_index(_idx)
+#endif
+
+#if CONFIG_IS_ENABLED(INITCALL_STATS)
+#define gd_initcall_stats()		gd->initcall_stats
+#define gd_set_initcall_stats(_stats)	gd->initcall_stats = (_stats)
+#else
+#define gd_initcall_stats()		((struct initcall_stats *)NULL)
+#define gd_set_initcall_stats(_stats)
+#endif
+
+#if CONFIG_IS_ENABLED(INITCALL_DEFER)
+#define gd_initcall_run()		gd->initcall_run
+#define gd_set_initcall_run(_run)	gd->initcall_run = (_run)
+#else
+#define gd_initcall_run()		((struct initcall_run *)NULL)
+#define gd_set_initcall_run(_run)
+#endif
+
+#if CONFIG_IS_ENABLED(EVENT)
 #define gd_event_state()	((struct event_state *)&gd->event_state)
 #else
 #define gd_event_state()	NULL
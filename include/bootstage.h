@@ -241,6 +241,9 @@ void show_boot_progress(int val);
 #if CONFIG_IS_ENABLED(BOOTSTAGE)
 #define ENABLE_BOOTSTAGE
 #endif
+#if CONFIG_IS_ENABLED(BOOTSTAGE_SPANS)
+#define ENABLE_BOOTSTAGE_SPANS
+#endif
 #endif
 
 #ifdef ENABLE_BOOTSTAGE
@@ -337,6 +340,20 @@ uint32_t bootstage_accum(enum bootstage_id id);
 /* Print a report about boot time */
 void bootstage_report(void);
 
+/**
+ * bootstage_export() - Write the boot timing in Chrome trace-event format
+ *
+ * This produces JSON which can be loaded into chrome://tracing or Perfetto.
+ * Marks become instant events and spans become complete events, with spans
+ * which have a device shown on a separate track from the others.
+ *
+ * @buf: Buffer to write to, or NULL to just find the size needed
+ * @size: Size of @buf in bytes
+ * Return: number of bytes needed, not including the terminator. If this is
+ *	not less than @size, the output is truncated
+ */
+int bootstage_export(char *buf, int size);
+
 /**
  * Add bootstage information to the device tree
  *
@@ -455,6 +472,39 @@ static inline int bootstage_init(bool first)
 
 #endif /* ENABLE_BOOTSTAGE */
 
+#ifdef ENABLE_BOOTSTAGE_SPANS
+/**
+ * bootstage_span_begin() - Start a span of time
+ *
+ * Spans may be nested: a span started before the current one has ended
+ * becomes its child. The strings are copied when bootstage is relocated or
+ * stashed, but must remain valid until then.
+ *
+ * @name: Name of the span
+ * @dev_name: Name of the device being used, or NULL if none
+ * Return: ID of the span, to pass to bootstage_span_end(), or -ENOSPC if
+ *	there is no space for it (which bootstage_span_end() ignores)
+ */
+int bootstage_span_begin(const char *name, const char *dev_name);
+
+/**
+ * bootstage_span_end() - End a span of time
+ *
+ * @span: ID of the span, as returned by bootstage_span_begin()
+ * @bytes: Number of bytes transferred, or 0 if not relevant
+ */
+void bootstage_span_end(int span, uint64_t bytes);
+#else
+static inline int bootstage_span_begin(const char *name, const char *dev_name)
+{
+	return 0;
+}
+
+static inline void bootstage_span_end(int span, uint64_t bytes)
+{
+}
+#endif
+
 /* helpers for SPL */
 int _bootstage_stash_default(void);
 int _bootstage_unstash_default(void);
@@ -192,6 +192,28 @@ int device_of_to_plat(struct udevice *dev);
  */
 int device_probe(struct udevice *dev);
 
+/**
+ * device_probe_complete() - Finish probing a device
+ *
+ * This runs the uclass post-probe method and sends the EVT_DM_POST_PROBE
+ * event, once the driver's probe() method (and anything it handed to
+ * dev_probe_async()) has finished. If @ret is an error, or either step fails,
+ * the device is deactivated and its memory freed instead.
+ *
+ * @dev: Device being probed
+ * @ret: Result of the probe so far
+ * Return: 0 if OK, -ve on error
+ */
+int device_probe_complete(struct udevice *dev, int ret);
+
+/**
+ * device_time_us() - Get the time for recording device stats
+ *
+ * Return: current time in microseconds, or 0 if the timer is not available
+ *	(it is not yet probed, or has been removed)
+ */
+ulong device_time_us(void);
+
 /**
  * device_remove() - Remove a device, de-activating it
  *
@@ -201,8 +223,10 @@ int device_probe(struct udevice *dev);
  * @dev: Pointer to device to remove
  * @flags: Flags for selective device removal (DM_REMOVE_...)
  * Return: 0 if OK, -EKEYREJECTED if not removed due to flags, -EPROBE_DEFER if
- *	this is a vital device and flags is DM_REMOVE_NON_VITAL, other -ve on
- *	error (such an error here is normally a very bad thing)
+ *	this is a vital device and flags is DM_REMOVE_NON_VITAL, -EDEADLK if the
+ *	device is still probing and this is called from its poll function (see
+ *	dev_probe_async()), other -ve on error (such an error here is normally a
+ *	very bad thing)
  */
 #if CONFIG_IS_ENABLED(DM_DEVICE_REMOVE)
 int device_remove(struct udevice *dev, uint flags);
@@ -84,6 +84,15 @@ struct driver_info;
 /* Device must be probed after it was bound */
 #define DM_FLAG_PROBE_AFTER_BIND	(1 << 15)
 
+/*
+ * Device has been probed but is still finishing in the background, see
+ * dev_probe_async(). The device is joined by device_probe().
+ */
+#define DM_FLAG_PROBE_PENDING		(1 << 16)
+
+/* The time taken by the last probe has been recorded, see DM_PROBE_TIME */
+#define DM_FLAG_PROBE_TIME_VALID	(1 << 17)
+
 /*
  * One or multiple of these flags are passed to device_remove() so that
  * a selective device removal as specified by the remove-stage and the
@@ -166,6 +175,11 @@ enum {
  * @dma_offset: Offset between the physical address space (CPU's) and the
  *		device's bus address space
  * @iommu: IOMMU device associated with this device
+ * @probe_time_us: Time taken by the last probe of this device in
+ *		microseconds, kept after the device is removed. While the
+ *		device is being probed this holds the time the probe started
+ * @remove_time_us: Time taken by the last removal of this device in
+ *		microseconds, 0 if it has not been removed
  */
 struct udevice {
 	const struct driver *driver;
@@ -198,6 +212,12 @@ struct udevice {
 #if CONFIG_IS_ENABLED(IOMMU)
 	struct udevice *iommu;
 #endif
+#if CONFIG_IS_ENABLED(DM_PROBE_TIME)
+	u32 probe_time_us;
+#endif
+#if CONFIG_IS_ENABLED(DM_DEVICE_STATS)
+	u32 remove_time_us;
+#endif
 };
 
 static inline int dm_udevice_size(void)
@@ -269,6 +289,41 @@ static inline __attribute_const__ ofnode dev_ofnode(const struct udevice *dev)
 /* Returns non-zero if the device is active (probed and not removed) */
 #define device_active(dev)	(dev_get_flags(dev) & DM_FLAG_ACTIVATED)
 
+/**
+ * dev_get_probe_time() - Get the time taken to probe a device
+ *
+ * The time is kept after the device is removed, until it is probed again.
+ *
+ * @dev:	Device to check
+ * Return: time taken by the last successful probe of @dev in microseconds,
+ *	or 0 if it has not finished probing (or failed), the time could not
+ *	be measured or CONFIG_DM_PROBE_TIME is disabled
+ */
+static inline u32 dev_get_probe_time(const struct udevice *dev)
+{
+#if CONFIG_IS_ENABLED(DM_PROBE_TIME)
+	if (dev_get_flags(dev) & DM_FLAG_PROBE_TIME_VALID)
+		return dev->probe_time_us;
+#endif
+	return 0;
+}
+
+/**
+ * dev_get_remove_time() - Get the time taken to remove a device
+ *
+ * @dev:	Device to check
+ * Return: time taken by the last removal of @dev in microseconds, or 0 if it
+ *	has not been removed or CONFIG_DM_DEVICE_STATS is disabled
+ */
+static inline u32 dev_get_remove_time(const struct udevice *dev)
+{
+#if CONFIG_IS_ENABLED(DM_DEVICE_STATS)
+	return dev->remove_time_us;
+#else
+	return 0;
+#endif
+}
+
 #if CONFIG_IS_ENABLED(DM_DMA)
 #define dev_set_dma_offset(_dev, _offset)	_dev->dma_offset = _offset
 #define dev_get_dma_offset(_dev)		_dev->dma_offset
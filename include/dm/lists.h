@@ -23,6 +23,20 @@
  */
 struct driver *lists_driver_lookup_name(const char *name);
 
+/**
+ * lists_driver_match_compat() - Find the driver for a compatible string
+ *
+ * This returns the first driver, in linker-list order, with a matching
+ * entry in its of_match table. With CONFIG_DM_COMPAT_INDEX this is looked up
+ * in a hash table built on first use, otherwise all drivers are scanned.
+ *
+ * @compat: Compatible string to look up
+ * @idp: Returns the matching of_match entry of the driver
+ * Return: pointer to driver, or NULL if not found
+ */
+struct driver *lists_driver_match_compat(const char *compat,
+					 const struct udevice_id **idp);
+
 /**
  * lists_uclass_lookup() - Return uclass_driver based on ID of the class
  *
@@ -42,9 +42,19 @@ struct property {
  * @properties pointers to the first one, with struct property->@next pointing
  * to the next one.
  *
+ * With CONFIG_OF_LIVE_LAZY the tree built from the control FDT only creates
+ * nodes and properties when they are first looked at, so @child and
+ * @properties must be read with of_node_child() and of_node_props(), which
+ * fill them in as needed. Once a node exists, its siblings do too.
+ *
  * @name: Node name, "" for the root node
  * @type: Node type (value of device_type property) or "<NULL>" if none
  * @phandle: Phandle value of this none, or 0 if none
+ * @offset: Offset of this node in the flat tree it came from, only used by a
+ *	lazy tree. It shares a word with @lazy, which limits the tree to
+ *	OF_LAZY_MAX_OFFSET bytes.
+ * @lazy: Flags indicating what is still to be built (OF_LAZY_...), 0 for a
+ *	node which is fully built or is not part of a lazy tree
  * @full_name: Full path to node, e.g. "/bus@1/spi@1100" ("/" for the root node)
  * @properties: Pointer to head of list of properties, or NULL if none
  * @parent: Pointer to parent node, or NULL if this is the root node
@@ -55,6 +65,10 @@ struct device_node {
 	const char *name;
 	const char *type;
 	phandle phandle;
+#if CONFIG_IS_ENABLED(OF_LIVE_LAZY)
+	uint offset : 29;
+	uint lazy : 3;
+#endif
 	const char *full_name;
 
 	struct property *properties;
@@ -63,6 +77,70 @@ struct device_node {
 	struct device_node *sibling;
 };
 
+/* Flags for struct device_node->lazy */
+enum {
+	OF_LAZY_CHILDREN	= 1 << 0,	/* child nodes not built yet */
+	OF_LAZY_PROPS		= 1 << 1,	/* properties not built yet */
+	OF_LAZY_ROOT		= 1 << 2,	/* root node of a lazy tree */
+};
+
+/* Size limit for a flat tree built lazily, see device_node->offset */
+#define OF_LAZY_MAX_OFFSET	(1U << 29)
+
+#if CONFIG_IS_ENABLED(OF_LIVE_LAZY)
+/**
+ * of_live_expand_children() - Create the child nodes of a lazy node
+ *
+ * @np: Node to update
+ */
+void of_live_expand_children(struct device_node *np);
+
+/**
+ * of_live_expand_props() - Create the properties of a lazy node
+ *
+ * @np: Node to update
+ */
+void of_live_expand_props(struct device_node *np);
+
+/**
+ * of_node_child() - Get the first child of a node
+ *
+ * @np: Node to check
+ * Return: first child node, or NULL if none
+ */
+static inline struct device_node *of_node_child(const struct device_node *np)
+{
+	if (np->lazy & OF_LAZY_CHILDREN)
+		of_live_expand_children((struct device_node *)np);
+
+	return np->child;
+}
+
+/**
+ * of_node_props() - Get the first property of a node
+ *
+ * @np: Node to check
+ * Return: first property, or NULL if none
+ */
+static inline struct property *of_node_props(const struct device_node *np)
+{
+	if (np->lazy & OF_LAZY_PROPS)
+		of_live_expand_props((struct device_node *)np);
+
+	return np->properties;
+}
+#else
+static inline struct device_node *of_node_child(const struct device_node *np)
+{
+	return np->child;
+}
+
+static inline struct property *of_node_props(const struct device_node *np)
+{
+	return np->properties;
+}
+#endif
+
 #define BAD_OF_ROOT	0xdead11e3
 
 #define OF_MAX_PHANDLE_ARGS 16
@@ -611,7 +611,7 @@ static inline ofnode ofnode_first_subnode(ofnode node)
 {
 	assert(ofnode_valid(node));
 	if (ofnode_is_np(node))
-		return np_to_ofnode(node.np->child);
+		return np_to_ofnode(of_node_child(node.np));
 
 	return offset_to_ofnode(
 		fdt_first_subnode(gd->fdt_blob, ofnode_to_offset(node)));
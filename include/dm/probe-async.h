@@ -0,0 +1,219 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Background completion of device probing
+ *
+ * Some devices take a long time to become ready after their probe() method
+ * has started them: a PCIe link must train, a USB hub must power its ports,
+ * a PHY must finish auto-negotiation. Rather than wait for each in turn, a
+ * driver can start the hardware in probe() and call dev_probe_async() with a
+ * function that checks whether it is ready. The device stays in the
+ * DM_FLAG_PROBE_PENDING state until it is joined (waited for) and that
+ * function says it is done, after which the uclass post-probe and the
+ * EVT_DM_POST_PROBE event run as usual.
+ *
+ * Pending devices are polled from schedule() when CONFIG_CYCLIC is enabled,
+ * but polling only records the result. A device is joined by device_probe()
+ * of the device or of a device which needs it, by device_remove(), by
+ * dm_probe_join_all() and before booting an OS, so code that uses the device
+ * never sees it half-probed and its post-probe never runs from schedule().
+ */
+
+#ifndef _DM_PROBE_ASYNC_H
+#define _DM_PROBE_ASYNC_H
+
+#include <dm/device-internal.h>
+#include <linux/types.h>
+
+struct udevice;
+
+/**
+ * typedef dev_probe_poll_t - Check whether a device has finished probing
+ *
+ * @dev: Device to check
+ * Return: 0 if the device is ready, -EAGAIN if it is still busy, other -ve
+ *	on error, in which case the probe fails as if probe() had returned it
+ */
+typedef int (*dev_probe_poll_t)(struct udevice *dev);
+
+/**
+ * dev_probe_wait() - Wait for a device to become ready
+ *
+ * This calls @poll until it returns something other than -EAGAIN, or until
+ * @timeout_us has passed.
+ *
+ * @dev: Device being probed
+ * @poll: Function to call to check whether @dev is ready
+ * @timeout_us: Time to allow @dev to become ready, in microseconds
+ * Return: 0 if the device is ready, -ETIMEDOUT if it did not become ready in
+ *	time, other -ve error from @poll
+ */
+int dev_probe_wait(struct udevice *dev, dev_probe_poll_t poll,
+		   ulong timeout_us);
+
+#if CONFIG_IS_ENABLED(DM_PROBE_ASYNC)
+/**
+ * dev_probe_async() - Let a device finish probing in the background
+ *
+ * This is called by a driver's probe() method, after it has started the
+ * hardware, typically as its return value. If the device is being probed
+ * with device_probe_async() the device is queued and this returns
+ * immediately. Otherwise (including before relocation) this waits for the
+ * device with dev_probe_wait(), so drivers do not need to handle both cases.
+ *
+ * @dev: Device being probed
+ * @poll: Function to call to check whether @dev is ready
+ * @timeout_us: Time to allow @dev to become ready, in microseconds
+ * Return: 0 if the device is ready or has been queued, -ETIMEDOUT if it did
+ *	not become ready in time, other -ve error from @poll
+ */
+int dev_probe_async(struct udevice *dev, dev_probe_poll_t poll,
+		    ulong timeout_us);
+
+/**
+ * device_probe_async() - Probe a device without waiting for it
+ *
+ * This is like device_probe() except that if the driver hands its probe to
+ * dev_probe_async(), the device is left pending rather than waited for.
+ * Parents, and any devices needed by the driver's probe() method, are still
+ * probed (and joined) as normal.
+ *
+ * @dev: Device to probe
+ * Return: 0 if OK (the device may still be pending), -ve on error
+ */
+int device_probe_async(struct udevice *dev);
+
+/**
+ * dm_probe_join() - Wait for a device to finish probing
+ *
+ * Other pending devices are polled while waiting, so they make progress too.
+ * Once @dev is done its probe is finished; if it failed, the device is
+ * removed.
+ *
+ * @dev: Device to wait for
+ * Return: 0 if the device is ready (or was not pending), -EDEADLK if called
+ *	from the poll function of @dev (directly or via another join), other -ve
+ *	if its probe failed, in which case the device is no longer active
+ */
+int dm_probe_join(struct udevice *dev);
+
+/**
+ * dm_probe_join_all() - Wait for all pending devices to finish probing
+ *
+ * Return: 0 if OK, -ve error of the last device that failed to probe
+ */
+int dm_probe_join_all(void);
+
+/**
+ * dm_probe_poll() - Poll all pending devices once
+ *
+ * This only records which devices are ready or have failed. They stay
+ * pending until joined. This is called from schedule() when CONFIG_CYCLIC is
+ * enabled.
+ */
+void dm_probe_poll(void);
+
+/**
+ * dm_probe_pending() - Get the number of devices still probing
+ *
+ * Return: number of devices in the DM_FLAG_PROBE_PENDING state
+ */
+int dm_probe_pending(void);
+
+/**
+ * dm_probe_enter() - Note that a device's probe is starting
+ *
+ * While a device is being probed, any other device probed (or found still
+ * pending) is recorded as a dependency of it.
+ *
+ * @dev: Device being probed
+ * Return: the device that was being probed before, to pass to
+ *	dm_probe_leave()
+ */
+struct udevice *dm_probe_enter(struct udevice *dev);
+
+/**
+ * dm_probe_leave() - Note that a device's probe has finished
+ *
+ * @prev: Value returned by the matching dm_probe_enter()
+ */
+void dm_probe_leave(struct udevice *prev);
+
+/**
+ * dm_probe_add_dep() - Record that the current probe needs a device
+ *
+ * Devices which have already finished probing are ignored, so this is cheap
+ * for the common case of looking up a device which is already up.
+ *
+ * @supplier: Device being probed or looked up
+ */
+void dm_probe_add_dep(struct udevice *supplier);
+
+/**
+ * dm_probe_forget() - Drop everything the scheduler knows about a device
+ *
+ * This is called when a device is unbound.
+ *
+ * @dev: Device being unbound
+ */
+void dm_probe_forget(struct udevice *dev);
+
+/**
+ * dm_probe_free() - Free the scheduler state
+ *
+ * This is called by dm_uninit(), once all devices have been removed.
+ */
+void dm_probe_free(void);
+#else
+static inline int dev_probe_async(struct udevice *dev, dev_probe_poll_t poll,
+				  ulong timeout_us)
+{
+	return dev_probe_wait(dev, poll, timeout_us);
+}
+
+static inline int device_probe_async(struct udevice *dev)
+{
+	return device_probe(dev);
+}
+
+static inline int dm_probe_join(struct udevice *dev)
+{
+	return 0;
+}
+
+static inline int dm_probe_join_all(void)
+{
+	return 0;
+}
+
+static inline void dm_probe_poll(void)
+{
+}
+
+static inline int dm_probe_pending(void)
+{
+	return 0;
+}
+
+static inline struct udevice *dm_probe_enter(struct udevice *dev)
+{
+	return NULL;
+}
+
+static inline void dm_probe_leave(struct udevice *prev)
+{
+}
+
+static inline void dm_probe_add_dep(struct udevice *supplier)
+{
+}
+
+static inline void dm_probe_forget(struct udevice *dev)
+{
+}
+
+static inline void dm_probe_free(void)
+{
+}
+#endif
+
+#endif
@@ -52,6 +52,25 @@ struct dm_stats {
 	int attach_size[DM_TAG_ATTACH_COUNT];
 };
 
+/**
+ * struct dm_dev_stats - Information about the cost of a single device
+ *
+ * @probe_us: Time taken to probe the device, see dev_get_probe_time()
+ * @remove_us: Time taken by its last removal, see dev_get_remove_time()
+ * @attach_size: Bytes of attached data currently allocated, for each type
+ * @attach_total: Total of @attach_size
+ * @devres_count: Number of devres allocations held by the device
+ * @devres_size: Total size of those allocations in bytes
+ */
+struct dm_dev_stats {
+	u32 probe_us;
+	u32 remove_us;
+	int attach_size[DM_TAG_ATTACH_COUNT];
+	int attach_total;
+	int devres_count;
+	int devres_size;
+};
+
 /**
  * dm_root() - Return pointer to the top of the driver tree
  *
@@ -186,4 +205,14 @@ void dm_get_stats(int *device_countp, int *uclass_countp);
  */
 void dm_get_mem(struct dm_stats *stats);
 
+/**
+ * dev_get_stats() - Get information about the cost of a device
+ *
+ * This needs CONFIG_DM_DEVICE_STATS
+ *
+ * @dev: Device to check
+ * @stats: Place to put the information
+ */
+void dev_get_stats(const struct udevice *dev, struct dm_dev_stats *stats);
+
 #endif
@@ -347,4 +347,12 @@ struct uclass *uclass_find(enum uclass_id key);
  */
 int uclass_destroy(struct uclass *uc);
 
+/**
+ * uclass_lookup_free() - Free the table used to look up uclasses
+ *
+ * This is called when driver model is shut down. The table is created again
+ * from the list of uclasses when needed.
+ */
+void uclass_lookup_free(void);
+
 #endif
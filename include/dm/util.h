@@ -30,8 +30,9 @@ int list_count_items(struct list_head *head);
  * @dev_name: udevice name
  * @extended: true if forword-matching expected
  * @sort: Sort by uclass name
+ * @show_time: Show the time taken to probe each device
  */
-void dm_dump_tree(char *dev_name, bool extended, bool sort);
+void dm_dump_tree(char *dev_name, bool extended, bool sort, bool show_time);
 
 /*
  * Dump out a list of uclasses and their devices
@@ -59,6 +60,25 @@ void dm_dump_driver_compat(void);
 /* Dump out a list of drivers with static platform data */
 void dm_dump_static_driver_info(void);
 
+#if CONFIG_IS_ENABLED(DM_PROBE_ASYNC)
+/* Dump out the dependencies recorded while probing devices */
+void dm_dump_probe_deps(void);
+#else
+static inline void dm_dump_probe_deps(void)
+{
+}
+#endif
+
+/**
+ * dm_dump_stats() - Dump the probe time and memory usage of each device
+ *
+ * Only devices which have been probed are shown. This needs
+ * CONFIG_DM_DEVICE_STATS
+ *
+ * @sort: Sort by probe time, slowest first, rather than in tree order
+ */
+void dm_dump_stats(bool sort);
+
 /**
  * dm_dump_mem() - Dump stats on memory usage in driver model
  *
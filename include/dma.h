@@ -11,6 +11,7 @@
 
 #include <linux/bitops.h>
 #include <linux/errno.h>
+#include <linux/string.h>
 #include <linux/types.h>
 
 struct udevice;
@@ -331,6 +332,21 @@ int dma_get_device(u32 transfer_type, struct udevice **devp);
 	     transferred and on failure return error code.
  */
 int dma_memcpy(void *dst, void *src, size_t len);
+
+/**
+ * dma_memcpy_large() - Copy memory, using DMA if the copy is large
+ *
+ * With CONFIG_DMA_MEMCPY_OFFLOAD, a copy of at least
+ * CONFIG_DMA_MEMCPY_THRESHOLD bytes is done with dma_memcpy(). Nothing is
+ * copied if this fails, so the caller must then do the copy itself.
+ *
+ * @dst: Destination pointer
+ * @src: Source pointer
+ * @len: Number of bytes to copy
+ * Return: 0 if OK, -ENOSYS if offload is not enabled, -EINVAL if the copy is
+ * too small or the areas overlap, other -ve error if the DMA transfer failed
+ */
+int dma_memcpy_large(void *dst, const void *src, size_t len);
 #else
 static inline int dma_get_device(u32 transfer_type, struct udevice **devp)
 {
@@ -341,5 +357,10 @@ static inline int dma_memcpy(void *dst, void *src, size_t len)
 {
 	return -ENOSYS;
 }
+
+static inline int dma_memcpy_large(void *dst, const void *src, size_t len)
+{
+	return -ENOSYS;
+}
 #endif /* CONFIG_DMA */
 #endif	/* _DMA_H_ */
@@ -216,6 +216,18 @@ struct event {
 	union event_data data;
 };
 
+/**
+ * struct event_stats - statistics for an event type
+ *
+ * @count: Number of times the event has been sent
+ * @time_us: Total time spent sending the event, in microseconds. This only
+ *	starts counting once the timer is running
+ */
+struct event_stats {
+	uint count;
+	ulong time_us;
+};
+
 /* Flags for event spy */
 enum evspy_flags {
 	EVSPYF_SIMPLE	= 1 << 0,
@@ -337,6 +349,16 @@ int event_register(const char *id, enum event_t type, event_handler_t func,
 /** event_show_spy_list( - Show a list of event spies */
 void event_show_spy_list(void);
 
+/**
+ * event_get_stats() - Get the statistics for an event type
+ *
+ * @type: Event type to check
+ * @stats: Returns the statistics
+ * Return: 0 if OK, -EINVAL if @type is not valid, -ENOSYS if statistics are
+ *	not recorded (CONFIG_EVENT_DEBUG is not enabled)
+ */
+int event_get_stats(enum event_t type, struct event_stats *stats);
+
 /**
  * event_type_name() - Get the name of an event type
  *
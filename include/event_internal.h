@@ -28,8 +28,31 @@ struct event_spy {
 	void *ctx;
 };
 
+/**
+ * struct event_state - the state of the event system
+ *
+ * Static spies are held in a linker list, which is sorted by entry name. Since
+ * the name starts with the event type, the spies for each type sit together,
+ * so @spy_first and @spy_end give the (small) range to search for each type.
+ * The index is built on the first event and holds list positions rather than
+ * addresses, so it remains valid after relocation.
+ *
+ * @spy_head: List of dynamic spies (struct event_spy) for each event type
+ * @spy_first: Position of the first static spy for each event type
+ * @spy_end: Position after the last static spy for each event type, 0 if none
+ * @indexed: true once @spy_first and @spy_end have been set up
+ * @stats: Number of times each event type has been sent and the time taken
+ */
 struct event_state {
-	struct list_head spy_head;
+#if CONFIG_IS_ENABLED(EVENT_DYNAMIC)
+	struct list_head spy_head[EVT_COUNT];
+#endif
+	u16 spy_first[EVT_COUNT];
+	u16 spy_end[EVT_COUNT];
+	bool indexed;
+#if CONFIG_IS_ENABLED(EVENT_DEBUG)
+	struct event_stats stats[EVT_COUNT];
+#endif
 };
 
 #endif
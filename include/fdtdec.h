@@ -990,6 +990,57 @@ int fdtdec_setup_memory_banksize(void);
  */
 int fdtdec_set_ethernet_mac_address(void *fdt, const u8 *mac, size_t size);
 
+#if CONFIG_IS_ENABLED(OF_FLAT_INDEX)
+/**
+ * fdtdec_phandle_offset() - Find a node by its phandle
+ *
+ * This is the same as fdt_node_offset_by_phandle() but uses an index for the
+ * control FDT, once relocation is done.
+ *
+ * @blob: FDT blob
+ * @phandle: Phandle to look up
+ * Return: offset of node, or -ve FDT_ERR_... value on error
+ */
+int fdtdec_phandle_offset(const void *blob, uint phandle);
+
+/**
+ * fdtdec_path_offset() - Find a node by its path
+ *
+ * This is the same as fdt_path_offset() but remembers recently used paths
+ * (not aliases) in the control FDT, once relocation is done.
+ *
+ * @blob: FDT blob
+ * @path: Path to look up
+ * Return: offset of node, or -ve FDT_ERR_... value on error
+ */
+int fdtdec_path_offset(const void *blob, const char *path);
+
+/**
+ * fdtdec_index_invalidate() - Drop the index for a tree that is being changed
+ *
+ * This must be called when nodes or properties are added to or removed from
+ * the control FDT, other than through the ofnode and fdtdec functions, which
+ * call it already. Nothing happens if @blob is not the control FDT.
+ *
+ * @blob: FDT blob being changed
+ */
+void fdtdec_index_invalidate(const void *blob);
+#else
+static inline int fdtdec_phandle_offset(const void *blob, uint phandle)
+{
+	return fdt_node_offset_by_phandle(blob, phandle);
+}
+
+static inline int fdtdec_path_offset(const void *blob, const char *path)
+{
+	return fdt_path_offset(blob, path);
+}
+
+static inline void fdtdec_index_invalidate(const void *blob)
+{
+}
+#endif
+
 /**
  * fdtdec_set_phandle() - sets the phandle of a given node
  *
@@ -1001,6 +1052,8 @@ int fdtdec_set_ethernet_mac_address(void *fdt, const u8 *mac, size_t size);
  */
 static inline int fdtdec_set_phandle(void *blob, int node, uint32_t phandle)
 {
+	fdtdec_index_invalidate(blob);
+
 	return fdt_setprop_u32(blob, node, "phandle", phandle);
 }
 
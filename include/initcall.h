@@ -8,6 +8,7 @@
 
 #include <asm/types.h>
 #include <event.h>
+#include <linux/types.h>
 
 _Static_assert(EVT_COUNT < 256, "Can only support 256 event types with 8 bits");
 
@@ -24,6 +25,62 @@ typedef int (*init_fnc_t)(void);
 
 #define INITCALL_EVENT(_type)	(void *)((_type) | INITCALL_IS_EVENT)
 
+/*
+ * Wait for work handed to initcall_defer() by earlier initcalls in the list.
+ * Place this before the first initcall which needs that work to be done.
+ */
+#define INITCALL_SYNC		INITCALL_EVENT(EVT_NONE)
+
+/**
+ * initcall_done_t - Function to finish the work of an initcall
+ *
+ * @ctx: Context pointer passed to initcall_defer()
+ * Return: 0 if OK -ve on error
+ */
+typedef int (*initcall_done_t)(void *ctx);
+
+/**
+ * enum initcall_stat_flags - Flags for a record of an initcall
+ *
+ * @INITCALLF_RELOC: Ran after relocation
+ * @INITCALLF_EVENT: This is an event; @func in &struct initcall_stat is the
+ *	event type
+ * @INITCALLF_DEFERRED: This is work handed to initcall_defer(); @func in
+ *	&struct initcall_stat is the function which did it
+ */
+enum initcall_stat_flags {
+	INITCALLF_RELOC		= 1 << 0,
+	INITCALLF_EVENT		= 1 << 1,
+	INITCALLF_DEFERRED	= 1 << 2,
+};
+
+/**
+ * struct initcall_stat - Record of the time taken by an initcall
+ *
+ * @func: Address of the function, before relocation, so it can be found in
+ *	u-boot.map
+ * @time_us: Time taken in microseconds
+ * @flags: Flags for this record (enum initcall_stat_flags)
+ */
+struct initcall_stat {
+	ulong func;
+	u32 time_us;
+	u32 flags;
+};
+
+/**
+ * struct initcall_stats - Records of the initcalls run so far
+ *
+ * @count: Number of records in @rec
+ * @dropped: Number of initcalls not recorded because @rec was full
+ * @rec: Records in the order the initcalls ran
+ */
+struct initcall_stats {
+	int count;
+	int dropped;
+	struct initcall_stat rec[];
+};
+
 /**
  * initcall_run_list() - Run through a list of function calls
  *
@@ -35,4 +92,86 @@ typedef int (*init_fnc_t)(void);
  */
 int initcall_run_list(const init_fnc_t init_sequence[]);
 
+#if CONFIG_IS_ENABLED(INITCALL_DEFER)
+/**
+ * initcall_defer() - Finish the work of an initcall later
+ *
+ * An initcall which starts some slow hardware (e.g. a PHY coming out of
+ * reset, or a regulator ramping up) can call this rather than waiting, so
+ * that the following initcalls run in the meantime. @done is called at the
+ * next INITCALL_SYNC in the list, at the end of the list, or when the last
+ * initcall calls initcall_finish(). If there is no room to remember @done,
+ * or no list is running, @done is called now.
+ *
+ * @done: Function to call to finish the work
+ * @ctx: Context pointer to pass to @done
+ * Return: 0 if OK, else the error returned by @done if it was called
+ */
+int initcall_defer(initcall_done_t done, void *ctx);
+
+/**
+ * initcall_sync() - Finish all work handed to initcall_defer()
+ *
+ * This is the same as INITCALL_SYNC but can be called from an initcall.
+ *
+ * Return: 0 if OK, else the error returned by the first deferred function
+ *	which failed
+ */
+int initcall_sync(void);
+
+/**
+ * initcall_finish() - Finish all deferred work and stop deferring
+ *
+ * An initcall which does not return, such as run_main_loop(), must call this
+ * first, since the end of its list is never reached. Work deferred after this
+ * is done straight away.
+ *
+ * Return: 0 if OK, else the error returned by the first deferred function
+ *	which failed
+ */
+int initcall_finish(void);
+#else
+static inline int initcall_defer(initcall_done_t done, void *ctx)
+{
+	return done(ctx);
+}
+
+static inline int initcall_sync(void)
+{
+	return 0;
+}
+
+static inline int initcall_finish(void)
+{
+	return 0;
+}
+#endif
+
+#if CONFIG_IS_ENABLED(INITCALL_STATS)
+/**
+ * initcall_stats_size() - Get the size of the initcall records
+ *
+ * This is used to reserve space for the records before relocation.
+ *
+ * Return: size in bytes
+ */
+int initcall_stats_size(void);
+
+/**
+ * initcall_show_stats() - Show the time taken by each initcall
+ *
+ * The initcalls are listed slowest first.
+ */
+void initcall_show_stats(void);
+#else
+static inline int initcall_stats_size(void)
+{
+	return 0;
+}
+
+static inline void initcall_show_stats(void)
+{
+}
+#endif
+
 #endif
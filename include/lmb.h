@@ -5,6 +5,7 @@
 
 #include <asm/types.h>
 #include <asm/u-boot.h>
+#include <linux/types.h>
 
 /*
  * Logical memory blocks.
@@ -40,34 +41,43 @@ struct lmb_property {
  * all the #if test are done with CONFIG_LMB_USE_MAX_REGIONS (boolean)
  *
  * case 1. CONFIG_LMB_USE_MAX_REGIONS is defined (legacy mode)
- *         => CONFIG_LMB_MAX_REGIONS is used to configure the region size,
- *         directly in the array lmb_region.region[], with the same
- *         configuration for memory and reserved regions.
+ *         => CONFIG_LMB_MAX_REGIONS is used to configure the initial size of
+ *         both struct lmb.memory_regions and struct lmb.reserved_regions
  *
  * case 2. CONFIG_LMB_USE_MAX_REGIONS is not defined, the size of each
  *         region is configurated *independently* with
  *         => CONFIG_LMB_MEMORY_REGIONS: struct lmb.memory_regions
  *         => CONFIG_LMB_RESERVED_REGIONS: struct lmb.reserved_regions
- *         lmb_region.region is only a pointer to the correct buffer,
- *         initialized in lmb_init(). This configuration is useful to manage
- *         more reserved memory regions with CONFIG_LMB_RESERVED_REGIONS.
+ *
+ * In both cases lmb_region.region initially points to the buffer inside
+ * struct lmb, set up by lmb_init(). Once that is full, the regions are moved
+ * to a buffer allocated with malloc(), which doubles in size each time it
+ * fills up. This buffer must be freed with lmb_uninit().
  */
+#if IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS)
+#define LMB_MEMORY_REGIONS	CONFIG_LMB_MAX_REGIONS
+#define LMB_RESERVED_REGIONS	CONFIG_LMB_MAX_REGIONS
+#else
+#define LMB_MEMORY_REGIONS	CONFIG_LMB_MEMORY_REGIONS
+#define LMB_RESERVED_REGIONS	CONFIG_LMB_RESERVED_REGIONS
+#endif
 
 /**
  * struct lmb_region - Description of a set of region.
  *
+ * Regions are kept sorted by base address and do not overlap, so they can be
+ * searched with a binary search.
+ *
  * @cnt: Number of regions.
  * @max: Size of the region array, max value of cnt.
  * @region: Array of the region properties
+ * @alloced: true if @region was allocated with malloc()
  */
 struct lmb_region {
 	unsigned long cnt;
 	unsigned long max;
-#if IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS)
-	struct lmb_property region[CONFIG_LMB_MAX_REGIONS];
-#else
 	struct lmb_property *region;
-#endif
+	bool alloced;
 };
 
 /**
@@ -80,19 +90,28 @@ struct lmb_region {
  *
  * @memory: Description of memory regions.
  * @reserved: Description of reserved regions.
- * @memory_regions: Array of the memory regions (statically allocated)
- * @reserved_regions: Array of the reserved regions (statically allocated)
+ * @memory_regions: Initial array of the memory regions
+ * @reserved_regions: Initial array of the reserved regions
  */
 struct lmb {
 	struct lmb_region memory;
 	struct lmb_region reserved;
-#if !IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS)
-	struct lmb_property memory_regions[CONFIG_LMB_MEMORY_REGIONS];
-	struct lmb_property reserved_regions[CONFIG_LMB_RESERVED_REGIONS];
-#endif
+	struct lmb_property memory_regions[LMB_MEMORY_REGIONS];
+	struct lmb_property reserved_regions[LMB_RESERVED_REGIONS];
 };
 
 void lmb_init(struct lmb *lmb);
+
+/**
+ * lmb_uninit() - Free any memory allocated for the regions
+ *
+ * The struct lmb can be set up again with lmb_init() afterwards. This does
+ * nothing if the regions never outgrew the arrays in struct lmb, or if @lmb
+ * is zeroed.
+ *
+ * @lmb:	the logical memory block struct
+ */
+void lmb_uninit(struct lmb *lmb);
 void lmb_init_and_reserve(struct lmb *lmb, struct bd_info *bd, void *fdt_blob);
 void lmb_init_and_reserve_range(struct lmb *lmb, phys_addr_t base,
 				phys_size_t size, void *fdt_blob);
@@ -143,6 +162,30 @@ int lmb_is_reserved_flags(struct lmb *lmb, phys_addr_t addr, int flags);
 
 long lmb_free(struct lmb *lmb, phys_addr_t base, phys_size_t size);
 
+/**
+ * lmb_efi_map_update() - Record a change to the EFI memory map
+ *
+ * The EFI loader calls this each time it sets the type of an area of memory,
+ * so that a copy of the reserved areas is kept ready for
+ * lmb_init_and_reserve() and lmb_init_and_reserve_range(). Memory of any type
+ * other than EFI_CONVENTIONAL_MEMORY is reserved, with LMB_NOMAP for
+ * EFI_RESERVED_MEMORY_TYPE. If this fails, the EFI memory map is read instead
+ * from then on.
+ *
+ * @start:	start address of the area, as held in the EFI memory map
+ * @size:	size of the area in bytes
+ * @memory_type: new EFI memory type of the area
+ * Return:	0 if OK, -ENOMEM if the copy could not be updated
+ */
+#if IS_ENABLED(CONFIG_LMB) && CONFIG_IS_ENABLED(EFI_LOADER)
+int lmb_efi_map_update(u64 start, u64 size, int memory_type);
+#else
+static inline int lmb_efi_map_update(u64 start, u64 size, int memory_type)
+{
+	return 0;
+}
+#endif
+
 void lmb_dump_all(struct lmb *lmb);
 void lmb_dump_all_force(struct lmb *lmb);
 
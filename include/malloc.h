@@ -999,6 +999,32 @@ extern ulong mem_malloc_brk;
 
 void mem_malloc_init(ulong start, ulong size);
 
+/**
+ * struct malloc_info - Information about the malloc() heap
+ *
+ * @size: Size of the heap in bytes
+ * @in_use: Bytes in allocated blocks, including their headers
+ * @peak: Largest part of the heap used so far, in bytes from its start
+ * @free_blocks: Number of free blocks, counting the space never used as one
+ * @largest_free: Size of the largest free block, which limits the size of
+ *	an allocation. The difference between this and the free space shows
+ *	how fragmented the heap is.
+ */
+struct malloc_info {
+	ulong size;
+	ulong in_use;
+	ulong peak;
+	uint free_blocks;
+	ulong largest_free;
+};
+
+/**
+ * malloc_get_info() - Get information about the full malloc() heap
+ *
+ * @info: Returns the information
+ */
+void malloc_get_info(struct malloc_info *info);
+
 #ifdef __cplusplus
 };  /* end of extern "C" */
 #endif
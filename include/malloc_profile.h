@@ -0,0 +1,140 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Heap profiler, recording which code allocates memory
+ *
+ * Each allocation is charged to the address it was called from. Before the
+ * full heap is ready only totals are kept, since the simple malloc() never
+ * frees. Once it is ready, live allocations are tracked too, so the memory
+ * still held by each caller is known.
+ */
+
+#ifndef __MALLOC_PROFILE_H
+#define __MALLOC_PROFILE_H
+
+#include <linux/types.h>
+
+struct malloc_live;
+
+/**
+ * struct malloc_site - Allocations made from one place in the code
+ *
+ * @caller: Return address of the call to malloc(), etc.
+ * @count: Number of allocations still held
+ * @peak_count: Largest value of @count so far
+ * @bytes: Number of bytes still held
+ * @peak_bytes: Largest value of @bytes so far
+ * @total: Number of allocations made
+ */
+struct malloc_site {
+	ulong caller;
+	uint count;
+	uint peak_count;
+	ulong bytes;
+	ulong peak_bytes;
+	uint total;
+};
+
+/**
+ * struct malloc_profile - State of the heap profiler
+ *
+ * @sites: Hash table of call sites, indexed by caller
+ * @num_sites: Number of entries in @sites, a power of two
+ * @used_sites: Number of entries in use in @sites
+ * @early: Call sites from before the full heap was ready, or NULL
+ * @num_early: Number of entries in @early
+ * @live: Hash table of allocations still held, indexed by address, or NULL
+ *	if frees are not tracked
+ * @num_live: Number of entries in @live, a power of two
+ * @used_live: Number of entries in use in @live
+ * @dropped: Number of allocations which could not be recorded because a
+ *	table was full
+ */
+struct malloc_profile {
+	struct malloc_site *sites;
+	uint num_sites;
+	uint used_sites;
+	struct malloc_site *early;
+	uint num_early;
+	struct malloc_live *live;
+	uint num_live;
+	uint used_live;
+	uint dropped;
+};
+
+#if CONFIG_IS_ENABLED(MALLOC_PROFILE)
+/**
+ * malloc_profile_setup() - Set up the profiler in a buffer
+ *
+ * Any profile already in use is copied into @early
+ *
+ * @buf: Buffer to use, which must be aligned to a word
+ * @size: Size of the buffer in bytes
+ * @num_sites: Number of call sites to allow for, a power of two
+ * @track_frees: true to track each allocation, using the rest of @buf
+ * Return: profile, or NULL if @buf is too small
+ */
+struct malloc_profile *malloc_profile_setup(void *buf, ulong size,
+					    uint num_sites, bool track_frees);
+
+/**
+ * malloc_profile_alloc() - Record an allocation
+ *
+ * @ptr: Memory allocated, or NULL if the allocation failed
+ * @size: Number of bytes requested
+ * @caller: Address the allocator was called from
+ */
+void malloc_profile_alloc(void *ptr, size_t size, ulong caller);
+
+/**
+ * malloc_profile_free() - Record that memory is freed
+ *
+ * @ptr: Memory being freed, or NULL
+ */
+void malloc_profile_free(void *ptr);
+
+/**
+ * malloc_profile_find() - Find the call site for a caller
+ *
+ * @caller: Return address of the call to malloc(), etc.
+ * Return: call site, or NULL if none
+ */
+struct malloc_site *malloc_profile_find(ulong caller);
+
+/**
+ * malloc_profile_dump() - Show the call sites holding the most memory
+ *
+ * Call sites are sorted by their peak usage, since that is what determines
+ * how large the heap must be.
+ *
+ * @count: Number of call sites to show
+ */
+void malloc_profile_dump(uint count);
+
+/**
+ * malloc_simple_profile() - Get the profile for the simple malloc()
+ *
+ * This sets up a profile in the simple malloc() pool if there is none yet
+ *
+ * Return: profile, or NULL if out of memory
+ */
+struct malloc_profile *malloc_simple_profile(void);
+#else
+static inline void malloc_profile_alloc(void *ptr, size_t size, ulong caller)
+{
+}
+
+static inline void malloc_profile_free(void *ptr)
+{
+}
+
+static inline struct malloc_site *malloc_profile_find(ulong caller)
+{
+	return NULL;
+}
+
+static inline void malloc_profile_dump(uint count)
+{
+}
+#endif
+
+#endif
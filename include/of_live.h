@@ -9,8 +9,9 @@
 #ifndef _OF_LIVE_H
 #define _OF_LIVE_H
 
+#include <dm/of.h>
+
 struct abuf;
-struct device_node;
 
 /**
  * of_live_build() - build a live (hierarchical) tree from a flat DT
@@ -37,6 +38,45 @@ int of_live_build(const void *fdt_blob, struct device_node **rootp);
  */
 int unflatten_device_tree(const void *blob, struct device_node **mynodes);
 
+/**
+ * unflatten_device_tree_lazy() - create a tree of device_nodes on demand
+ *
+ * This creates only the root node. Other nodes, and the properties of each
+ * node, are created from @blob when they are first used, so @blob must not
+ * change or be freed while the tree exists. Use of_live_free() to free the
+ * tree.
+ *
+ * @blob: The blob to expand
+ * @rootp: Returns the root node of the tree
+ * Return: 0 if OK, -EINVAL if @blob is not valid, -EPROTONOSUPPORT if it is
+ *	too old (version < 16), -EFBIG if it is larger than OF_LAZY_MAX_OFFSET,
+ *	-ENOMEM if out of memory
+ */
+int unflatten_device_tree_lazy(const void *blob, struct device_node **rootp);
+
+/**
+ * of_live_find_phandle() - Find a node in a lazy tree by its phandle
+ *
+ * This looks up the phandle in the flat tree, then creates only the nodes
+ * needed to reach it.
+ *
+ * @root: Root node of tree to search
+ * @handle: Phandle to look up
+ * @npp: Returns the node found, or NULL if none
+ * Return: 0 if OK, -ENOSYS if @root is not the root of a lazy tree
+ */
+int of_live_find_phandle(struct device_node *root, phandle handle,
+			 struct device_node **npp);
+
+/**
+ * of_live_lazy_size() - Get the memory used by a lazy tree
+ *
+ * @root: Root node of tree to check
+ * Return: number of bytes allocated for the tree so far, or 0 if @root is not
+ *	the root of a lazy tree
+ */
+ulong of_live_lazy_size(const struct device_node *root);
+
 /**
  * of_live_free() - Dispose of a livetree
  *
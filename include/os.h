@@ -517,6 +517,25 @@ int os_setup_signal_handlers(void);
  */
 void os_signal_action(int sig, unsigned long pc);
 
+/**
+ * os_profile_start() - start a periodic signal for the profiler
+ *
+ * This uses SIGPROF, which counts the CPU time used by U-Boot, so no samples
+ * are taken while it is waiting, e.g. in os_usleep().
+ *
+ * @period_us:	time between signals in microseconds
+ * @func:	function to call with the program counter and (if known) link
+ *		register each time
+ * Return:	0 for success, -1 on error
+ */
+int os_profile_start(unsigned long period_us,
+		     void (*func)(unsigned long pc, unsigned long caller));
+
+/**
+ * os_profile_stop() - stop the signals started by os_profile_start()
+ */
+void os_profile_stop(void);
+
 /**
  * os_get_time_offset() - get time offset
  *
@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Sampling profiler
+ *
+ * A periodic interrupt (the generic timer on arm64, SIGPROF on sandbox)
+ * records the program counter and link register of whatever U-Boot was doing
+ * at the time. This costs nothing in the image beyond the profiler itself, so
+ * unlike function tracing (CONFIG_TRACE) it can be used on production builds.
+ */
+
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#include <trace.h>
+#include <linux/types.h>
+
+/* Offset recorded for an address outside the U-Boot image */
+#define PROFILE_OUTSIDE		TRACE_SAMPLE_OUTSIDE
+
+/**
+ * struct profile_sample - A single sample
+ *
+ * Addresses are stored as offsets from the start of the U-Boot text, so that
+ * they can be looked up in System.map
+ *
+ * @pc: Offset of the program counter, or PROFILE_OUTSIDE
+ * @caller: Offset of the link register, or PROFILE_OUTSIDE. This is the
+ *	caller of the current function, unless it has been used since
+ */
+struct profile_sample {
+	u32 pc;
+	u32 caller;
+};
+
+/**
+ * struct profile_stats - Information about the samples taken
+ *
+ * @count: Number of samples taken since profile_start()
+ * @stored: Number of samples held in the buffer, the most recent ones
+ * @outside: Number of samples held whose PC is outside U-Boot
+ * @period_us: Time between samples in microseconds
+ * @running: true if the profiler is running
+ */
+struct profile_stats {
+	uint count;
+	uint stored;
+	uint outside;
+	ulong period_us;
+	bool running;
+};
+
+/**
+ * profile_start() - Start taking samples
+ *
+ * Any samples from a previous run are discarded
+ *
+ * @period_us: Time between samples in microseconds
+ * Return: 0 if OK, -EALREADY if already running, -ENOMEM if there is no
+ *	memory for the samples, -ENOSYS if not supported on this architecture,
+ *	other -ve on error
+ */
+int profile_start(ulong period_us);
+
+/**
+ * profile_stop() - Stop taking samples
+ *
+ * The samples taken are kept until the next profile_start(). This is called
+ * before booting an OS, so that the profiler's interrupt does not reach it.
+ */
+void profile_stop(void);
+
+/**
+ * profile_sample() - Record a sample
+ *
+ * This is called by the architecture's interrupt (or signal) handler
+ *
+ * @pc: Program counter at the time of the interrupt
+ * @caller: Link register at the time of the interrupt, or 0 if not known
+ */
+void profile_sample(ulong pc, ulong caller);
+
+/**
+ * profile_get_stats() - Get information about the samples taken
+ *
+ * @stats: Returns the information
+ */
+void profile_get_stats(struct profile_stats *stats);
+
+/**
+ * profile_show() - Show the most common places where samples were taken
+ *
+ * @max: Maximum number of places to show
+ */
+void profile_show(uint max);
+
+/**
+ * profile_list_samples() - Write the samples out for proftool
+ *
+ * The output is a struct trace_output_hdr of type TRACE_CHUNK_SAMPLES,
+ * followed by a struct trace_output_sample for each sample
+ *
+ * @buff: Buffer to write to
+ * @buff_size: Size of @buff in bytes
+ * @needed: Returns the number of bytes needed for all the samples
+ * Return: 0 if OK, -ENOSPC if @buff is too small, in which case it holds as
+ *	many samples as will fit
+ */
+int profile_list_samples(void *buff, size_t buff_size, size_t *needed);
+
+/**
+ * arch_profile_start() - Start the periodic interrupt
+ *
+ * @period_us: Time between interrupts in microseconds
+ * Return: 0 if OK, -ENOSYS if not supported, other -ve on error
+ */
+int arch_profile_start(ulong period_us);
+
+/**
+ * arch_profile_stop() - Stop the periodic interrupt
+ */
+void arch_profile_stop(void);
+
+#endif
@@ -0,0 +1,126 @@
+/* SPDX-License-Identifier: GPL-2.0+ */
+/*
+ * Slab caches for small fixed-size objects
+ *
+ * Objects which are allocated in large numbers, such as devices, are packed
+ * into pages holding many objects of the same size, with no per-object header
+ * and no rounding beyond 8 bytes. A cache is declared with SLAB_CACHE() and
+ * objects are taken from it with slab_alloc().
+ */
+
+#ifndef __SLAB_H
+#define __SLAB_H
+
+#include <linker_lists.h>
+#include <malloc.h>
+#include <linux/list.h>
+#include <linux/types.h>
+
+/**
+ * struct slab_cache - A cache of objects of one type
+ *
+ * Only @name and @size are set when the cache is declared. The rest is set up
+ * when the first page is allocated.
+ *
+ * @name: Name of the cache, for information
+ * @size: Size of each object in bytes
+ * @partial: Pages with at least one free object
+ * @full: Pages with no free objects
+ * @pages: Number of pages held
+ * @live: Number of objects allocated
+ * @peak: Largest value of @live so far
+ */
+struct slab_cache {
+	const char *name;
+	uint size;
+	struct list_head partial;
+	struct list_head full;
+	uint pages;
+	uint live;
+	uint peak;
+};
+
+/**
+ * SLAB_CACHE() - Declare a slab cache
+ *
+ * @_name: Name of the cache (an identifier)
+ * @_type: Type of the objects it holds
+ */
+#define SLAB_CACHE(_name, _type)					\
+	ll_entry_declare(struct slab_cache, _name, slab_cache) = {	\
+		.name	= #_name,					\
+		.size	= sizeof(_type),				\
+	}
+
+/**
+ * SLAB_CACHE_GET() - Get a slab cache declared with SLAB_CACHE()
+ *
+ * This can be used in any file, not just the one declaring the cache
+ *
+ * @_name: Name of the cache
+ */
+#define SLAB_CACHE_GET(_name)	ll_entry_get(struct slab_cache, _name, slab_cache)
+
+#if CONFIG_IS_ENABLED(SLAB)
+/**
+ * slab_alloc() - Allocate an object from a cache
+ *
+ * Until the full malloc() heap is ready this uses calloc(), since the simple
+ * malloc() already packs objects without a header.
+ *
+ * @cache: Cache to allocate from
+ * Return: pointer to the object, filled with zeroes, or NULL if out of memory
+ */
+void *slab_alloc(struct slab_cache *cache);
+
+/**
+ * slab_free() - Free an object allocated by slab_alloc()
+ *
+ * When the last object in a page is freed, the page is returned to the heap.
+ * Objects which did not come from a slab page are passed to free().
+ *
+ * @cache: Cache the object was allocated from
+ * @ptr: Object to free, or NULL
+ */
+void slab_free(struct slab_cache *cache, void *ptr);
+
+/**
+ * slab_heap_size() - Get the heap space used by a cache
+ *
+ * @cache: Cache to check
+ * Return: number of bytes in the cache's pages
+ */
+ulong slab_heap_size(struct slab_cache *cache);
+
+/**
+ * slab_malloc_size() - Get the heap space the objects would use with malloc()
+ *
+ * This is an estimate for comparison with slab_heap_size()
+ *
+ * @cache: Cache to check
+ * Return: number of bytes malloc() would use for the allocated objects
+ */
+ulong slab_malloc_size(struct slab_cache *cache);
+#else
+static inline void *slab_alloc(struct slab_cache *cache)
+{
+	return calloc(1, cache->size);
+}
+
+static inline void slab_free(struct slab_cache *cache, void *ptr)
+{
+	free(ptr);
+}
+
+static inline ulong slab_heap_size(struct slab_cache *cache)
+{
+	return 0;
+}
+
+static inline ulong slab_malloc_size(struct slab_cache *cache)
+{
+	return 0;
+}
+#endif
+
+#endif
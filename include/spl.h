@@ -997,6 +997,17 @@ struct legacy_img_hdr *spl_get_load_buffer(ssize_t offset, size_t size);
 int board_spl_fit_append_fdt_skip(const char *name);
 
 void board_boot_order(u32 *spl_boot_list);
+
+/**
+ * board_boot_order_record() - Record the device the next phase came from
+ *
+ * This is called once an image has been loaded, so that a board which can keep
+ * the outcome over a reset is able to try the same device first next time, in
+ * board_boot_order()
+ *
+ * @boot_device: Device which the image was loaded from (BOOT_DEVICE_...)
+ */
+void board_boot_order_record(u32 boot_device);
 void spl_save_restore_data(void);
 
 /**
@@ -34,6 +34,7 @@ enum {
 enum trace_chunk_type {
 	TRACE_CHUNK_FUNCS,
 	TRACE_CHUNK_CALLS,
+	TRACE_CHUNK_SAMPLES,
 };
 
 /* A trace record for a function, as written to the profile output file */
@@ -42,6 +43,15 @@ struct trace_output_func {
 	uint32_t call_count;		/* Number of times called */
 };
 
+/* Offset written for an address outside the U-Boot image */
+#define TRACE_SAMPLE_OUTSIDE	0xffffffffU
+
+/* A sample from the profiler, as written to the profile output file */
+struct trace_output_sample {
+	uint32_t pc;			/* Offset of PC into code */
+	uint32_t caller;		/* Offset of caller into code */
+};
+
 /* A header at the start of the trace output buffer */
 struct trace_output_hdr {
 	enum trace_chunk_type type;	/* Record type */
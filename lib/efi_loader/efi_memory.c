@@ -10,6 +10,7 @@
 #include <common.h>
 #include <efi_loader.h>
 #include <init.h>
+#include <lmb.h>
 #include <log.h>
 #include <malloc.h>
 #include <mapmem.h>
@@ -365,6 +366,9 @@ static efi_status_t efi_add_memory_map_pg(u64 start, u64 pages,
 	/* And make sure memory is listed in descending order */
 	efi_mem_sort();
 
+	/* Keep the reserved areas seen by LMB in step */
+	lmb_efi_map_update(start, pages << EFI_PAGE_SHIFT, memory_type);
+
 	/* Notify that the memory map was changed */
 	list_for_each_entry(evt, &efi_events, link) {
 		if (evt->group &&
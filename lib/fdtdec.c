@@ -642,7 +642,7 @@ int fdtdec_lookup_phandle(const void *blob, int node, const char *prop_name)
 	if (!phandle)
 		return -FDT_ERR_NOTFOUND;
 
-	lookup = fdt_node_offset_by_phandle(blob, fdt32_to_cpu(*phandle));
+	lookup = fdtdec_phandle_offset(blob, fdt32_to_cpu(*phandle));
 	return lookup;
 }
 
@@ -773,8 +773,7 @@ int fdtdec_parse_phandle_with_args(const void *blob, int src_node,
 			 * below.
 			 */
 			if (cells_name || cur_index == index) {
-				node = fdt_node_offset_by_phandle(blob,
-								  phandle);
+				node = fdtdec_phandle_offset(blob, phandle);
 				if (node < 0) {
 					debug("%s: could not find phandle\n",
 					      fdt_get_name(blob, src_node,
@@ -1336,6 +1335,8 @@ int fdtdec_add_reserved_memory(void *blob, const char *basename,
 	fdt_size_t size;
 	char name[64];
 
+	fdtdec_index_invalidate(blob);
+
 	/* create an empty /reserved-memory node if one doesn't exist */
 	parent = fdt_path_offset(blob, "/reserved-memory");
 	if (parent < 0) {
@@ -1496,7 +1497,7 @@ int fdtdec_get_carveout(const void *blob, const char *node,
 
 	phandle = fdt32_to_cpu(prop[index]);
 
-	offset = fdt_node_offset_by_phandle(blob, phandle);
+	offset = fdtdec_phandle_offset(blob, phandle);
 	if (offset < 0) {
 		debug("failed to find node for phandle %u\n", phandle);
 		return offset;
@@ -1597,6 +1598,7 @@ int fdtdec_set_carveout(void *blob, const char *node, const char *prop_name,
 	}
 
 	if ((index + 1) * sizeof(value) > len) {
+		fdtdec_index_invalidate(blob);
 		err = fdt_setprop_placeholder(blob, offset, prop_name,
 					      (index + 1) * sizeof(value),
 					      &prop);
@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Index of phandles and paths in the control FDT
+ *
+ * fdt_node_offset_by_phandle() and fdt_path_offset() scan the structure block
+ * from the start. The phandle table is built with a single scan the first time
+ * it is needed; paths are remembered as they are looked up. Both are thrown
+ * away when the tree changes, which is noticed by the size of the structure
+ * block changing or by a hit that points to the wrong node.
+ */
+
+#define LOG_CATEGORY	LOGC_DT
+
+#include <common.h>
+#include <fdtdec.h>
+#include <log.h>
+#include <malloc.h>
+#include <asm/global_data.h>
+#include <linux/libfdt.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+enum {
+	/* Number of paths to remember (must be a power of two) */
+	FDT_INDEX_PATHS		= 64,
+
+	/* Don't use a phandle table if most of it would be empty */
+	FDT_INDEX_SPARSE	= 4,
+};
+
+/**
+ * struct fdtdec_path_ent - A remembered path
+ *
+ * The path itself is not stored. A hit is checked against the name of the
+ * node and, if it has one, its phandle. This also catches a tree that has
+ * changed behind our back.
+ *
+ * @hash: Hash of the path, 0 if this entry is empty
+ * @len: Length of the path
+ * @offset: Offset of the node
+ * @phandle: Phandle of the node, 0 if none
+ */
+struct fdtdec_path_ent {
+	u32 hash;
+	int len;
+	int offset;
+	uint phandle;
+};
+
+/**
+ * struct fdtdec_index - Index of a flat tree
+ *
+ * @blob: Tree being indexed
+ * @struct_size: Size of the structure block of @blob when it was indexed
+ * @max_phandle: Largest phandle in @blob
+ * @phandle_offset: Offset of the node with each phandle, or -1 if none. This
+ *	has @max_phandle + 1 entries, or is NULL if the phandles are too sparse
+ * @paths: Paths recently looked up
+ */
+struct fdtdec_index {
+	const void *blob;
+	int struct_size;
+	uint max_phandle;
+	int *phandle_offset;
+	struct fdtdec_path_ent paths[FDT_INDEX_PATHS];
+};
+
+static void fdtdec_index_free(struct fdtdec_index *idx)
+{
+	free(idx->phandle_offset);
+	free(idx);
+}
+
+static void fdtdec_index_phandles(struct fdtdec_index *idx)
+{
+	const void *blob = idx->blob;
+	int offset, count = 0;
+	uint phandle;
+
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		phandle = fdt_get_phandle(blob, offset);
+		if (phandle) {
+			idx->max_phandle = max(idx->max_phandle, phandle);
+			count++;
+		}
+	}
+	if (!count || idx->max_phandle / FDT_INDEX_SPARSE > count)
+		return;
+
+	idx->phandle_offset = malloc((idx->max_phandle + 1) * sizeof(int));
+	if (!idx->phandle_offset)
+		return;
+	memset(idx->phandle_offset, '\xff', (idx->max_phandle + 1) * sizeof(int));
+
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		phandle = fdt_get_phandle(blob, offset);
+		if (phandle)
+			idx->phandle_offset[phandle] = offset;
+	}
+	log_debug("Indexed %d phandles, max %x\n", count, idx->max_phandle);
+}
+
+/* Get the index for a tree, building it if needed */
+static struct fdtdec_index *fdtdec_index_get(const void *blob)
+{
+	struct fdtdec_index *idx = gd_fdt_index();
+
+	/* Only the control FDT, and only once it is not going to move */
+	if (!blob || blob != gd->fdt_blob ||
+	    !(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return NULL;
+	if (idx) {
+		if (idx->blob == blob &&
+		    idx->struct_size == fdt_size_dt_struct(blob))
+			return idx;
+		fdtdec_index_free(idx);
+	}
+
+	idx = calloc(1, sizeof(*idx));
+	if (idx) {
+		idx->blob = blob;
+		idx->struct_size = fdt_size_dt_struct(blob);
+		fdtdec_index_phandles(idx);
+	}
+	gd_set_fdt_index(idx);
+
+	return idx;
+}
+
+void fdtdec_index_invalidate(const void *blob)
+{
+	struct fdtdec_index *idx = gd_fdt_index();
+
+	if (idx && idx->blob == blob) {
+		fdtdec_index_free(idx);
+		gd_set_fdt_index(NULL);
+	}
+}
+
+int fdtdec_phandle_offset(const void *blob, uint phandle)
+{
+	struct fdtdec_index *idx = fdtdec_index_get(blob);
+	int offset;
+
+	if (!idx || !idx->phandle_offset)
+		return fdt_node_offset_by_phandle(blob, phandle);
+	if (!phandle || phandle == -1)
+		return -FDT_ERR_BADPHANDLE;
+
+	/* A miss may be a phandle added without changing the size of the tree */
+	offset = phandle > idx->max_phandle ? -1 : idx->phandle_offset[phandle];
+	if (offset < 0 || fdt_get_phandle(blob, offset) != phandle) {
+		offset = fdt_node_offset_by_phandle(blob, phandle);
+		if (offset >= 0) {
+			log_debug("Stale index for phandle %x\n", phandle);
+			fdtdec_index_invalidate(blob);
+		}
+	}
+
+	return offset;
+}
+
+/* FNV-1a, never returning 0 since that marks an empty entry */
+static u32 fdtdec_path_hash(const char *path, int *lenp)
+{
+	const char *p;
+	u32 hash = 2166136261U;
+
+	for (p = path; *p; p++)
+		hash = (hash ^ (u8)*p) * 16777619;
+	*lenp = p - path;
+
+	return hash ? hash : 1;
+}
+
+/* Check that the node at @offset is still the one that @ent refers to */
+static bool fdtdec_path_check(const void *blob, const char *path,
+			      struct fdtdec_path_ent *ent)
+{
+	const char *name, *leaf;
+	int name_len;
+
+	name = fdt_get_name(blob, ent->offset, &name_len);
+	if (!name)
+		return false;
+	leaf = strrchr(path, '/') + 1;
+	if (name_len != path + ent->len - leaf || memcmp(name, leaf, name_len))
+		return false;
+
+	/* Phandles are unique, so this tells apart nodes with the same name */
+	return fdt_get_phandle(blob, ent->offset) == ent->phandle;
+}
+
+int fdtdec_path_offset(const void *blob, const char *path)
+{
+	struct fdtdec_index *idx = fdtdec_index_get(blob);
+	struct fdtdec_path_ent *ent;
+	int len, offset;
+	u32 hash;
+
+	/* Aliases are left to libfdt */
+	if (!idx || *path != '/' || !path[1])
+		return fdt_path_offset(blob, path);
+
+	hash = fdtdec_path_hash(path, &len);
+	ent = &idx->paths[hash & (FDT_INDEX_PATHS - 1)];
+	if (ent->hash == hash && ent->len == len) {
+		if (fdtdec_path_check(blob, path, ent))
+			return ent->offset;
+		log_debug("Stale index for path '%s'\n", path);
+		fdtdec_index_invalidate(blob);
+		return fdt_path_offset(blob, path);
+	}
+
+	offset = fdt_path_offset(blob, path);
+	if (offset >= 0) {
+		struct fdtdec_path_ent new = {
+			.hash = hash,
+			.len = len,
+			.offset = offset,
+			.phandle = fdt_get_phandle(blob, offset),
+		};
+
+		if (fdtdec_path_check(blob, path, &new))
+			*ent = new;
+	}
+
+	return offset;
+}
@@ -4,14 +4,38 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <efi.h>
 #include <initcall.h>
 #include <log.h>
+#include <malloc.h>
 #include <relocate.h>
+#include <sort.h>
 #include <asm/global_data.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
+/* Number of initcalls which can be waiting for initcall_sync() */
+#define INITCALL_MAX_DEFER	8
+
+/**
+ * struct initcall_run - State of an initcall list being run
+ *
+ * @prev: State of the list which was running when this one started, or NULL
+ * @reloc_ofs: Relocation offset of the functions in @pending
+ * @count: Number of entries in @pending
+ * @pending: Work handed to initcall_defer() which is not yet done
+ */
+struct initcall_run {
+	struct initcall_run *prev;
+	ulong reloc_ofs;
+	int count;
+	struct initcall_pending {
+		initcall_done_t done;
+		void *ctx;
+	} pending[INITCALL_MAX_DEFER];
+};
+
 static ulong calc_reloc_ofs(void)
 {
 #ifdef CONFIG_EFI_APP
@@ -43,6 +67,207 @@ static int initcall_is_event(init_fnc_t func)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(INITCALL_STATS)
+int initcall_stats_size(void)
+{
+	return sizeof(struct initcall_stats) +
+		CONFIG_INITCALL_STATS_MAX * sizeof(struct initcall_stat);
+}
+
+/* Get the records, allocating them once malloc() is available */
+static struct initcall_stats *initcall_get_stats(void)
+{
+	struct initcall_stats *stats = gd_initcall_stats();
+
+	if (stats)
+		return stats;
+#if CONFIG_IS_ENABLED(SYS_MALLOC_F)
+	if (!gd->malloc_limit && !(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return NULL;
+#else
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return NULL;
+#endif
+	stats = calloc(1, initcall_stats_size());
+	gd_set_initcall_stats(stats);
+
+	return stats;
+}
+
+static void initcall_record(ulong func, ulong start, uint flags)
+{
+	ulong time_us = timer_get_boot_us() - start;
+	struct initcall_stats *stats = initcall_get_stats();
+	struct initcall_stat *rec;
+
+	if (!stats)
+		return;
+	if (stats->count == CONFIG_INITCALL_STATS_MAX) {
+		stats->dropped++;
+		return;
+	}
+
+	rec = &stats->rec[stats->count++];
+	rec->func = func;
+	rec->time_us = time_us;
+	rec->flags = flags;
+	if (gd->flags & GD_FLG_RELOC)
+		rec->flags |= INITCALLF_RELOC;
+}
+
+static int h_cmp_time(const void *v1, const void *v2)
+{
+	const struct initcall_stat *rec1 = v1, *rec2 = v2;
+
+	if (rec1->time_us == rec2->time_us)
+		return 0;
+
+	return rec1->time_us < rec2->time_us ? 1 : -1;
+}
+
+void initcall_show_stats(void)
+{
+	struct initcall_stats *stats = gd_initcall_stats();
+	struct initcall_stat *recs, *rec;
+	ulong total = 0;
+	int i;
+
+	if (!stats || !stats->count) {
+		printf("No initcalls recorded\n");
+		return;
+	}
+
+	/* Show them in the order they ran if there is no memory to sort */
+	recs = malloc(stats->count * sizeof(*recs));
+	if (recs) {
+		memcpy(recs, stats->rec, stats->count * sizeof(*recs));
+		qsort(recs, stats->count, sizeof(*recs), h_cmp_time);
+	} else {
+		recs = stats->rec;
+	}
+
+	printf("    Time  Phase  Initcall\n");
+	for (i = 0; i < stats->count; i++) {
+		rec = &recs[i];
+		total += rec->time_us;
+		printf("%8u  %-5s  ", rec->time_us,
+		       rec->flags & INITCALLF_RELOC ? "r" : "f");
+		if (rec->flags & INITCALLF_EVENT)
+			printf("event %lu/%s\n", rec->func,
+			       event_type_name(rec->func));
+		else if (rec->flags & INITCALLF_DEFERRED)
+			printf("%08lx (deferred)\n", rec->func);
+		else
+			printf("%08lx\n", rec->func);
+	}
+	printf("%8lu  total of %d initcalls", total, stats->count);
+	if (stats->dropped)
+		printf(", %d not recorded", stats->dropped);
+	printf("\n");
+
+	if (recs != stats->rec)
+		free(recs);
+}
+#else
+static inline void initcall_record(ulong func, ulong start, uint flags)
+{
+}
+#endif
+
+#if CONFIG_IS_ENABLED(INITCALL_DEFER)
+int initcall_defer(initcall_done_t done, void *ctx)
+{
+	struct initcall_run *run = gd_initcall_run();
+	struct initcall_pending *pend;
+
+	if (!run || run->count == INITCALL_MAX_DEFER)
+		return done(ctx);
+
+	pend = &run->pending[run->count++];
+	pend->done = done;
+	pend->ctx = ctx;
+
+	return 0;
+}
+
+int initcall_sync(void)
+{
+	struct initcall_run *run = gd_initcall_run();
+	struct initcall_pending *pend;
+	ulong start = 0;
+	int i, ret, err = 0;
+
+	if (!run)
+		return 0;
+
+	/* Each may defer more work, which is also done here */
+	for (i = 0; i < run->count; i++) {
+		pend = &run->pending[i];
+		debug("initcall: deferred %p\n",
+		      (char *)pend->done - run->reloc_ofs);
+		if (CONFIG_IS_ENABLED(INITCALL_STATS))
+			start = timer_get_boot_us();
+		ret = pend->done(pend->ctx);
+		initcall_record((ulong)pend->done - run->reloc_ofs, start,
+				INITCALLF_DEFERRED);
+		if (ret) {
+			printf("initcall deferred call %p failed (err=%d)\n",
+			       (char *)pend->done - run->reloc_ofs, ret);
+			if (!err)
+				err = ret;
+		}
+	}
+	run->count = 0;
+
+	return err;
+}
+
+static void initcall_start_run(struct initcall_run *run, ulong reloc_ofs)
+{
+	run->prev = gd_initcall_run();
+	run->reloc_ofs = reloc_ofs;
+	run->count = 0;
+	gd_set_initcall_run(run);
+}
+
+/**
+ * initcall_end_run() - Stop deferring work for a list
+ *
+ * @run: State of the list
+ * @sync: true to finish the deferred work, false to drop it
+ * Return: 0 if OK, else the error from initcall_sync()
+ */
+static int initcall_end_run(struct initcall_run *run, bool sync)
+{
+	int ret = 0;
+
+	if (gd_initcall_run() != run)
+		return 0;
+	if (sync)
+		ret = initcall_sync();
+	gd_set_initcall_run(run->prev);
+
+	return ret;
+}
+
+int initcall_finish(void)
+{
+	struct initcall_run *run = gd_initcall_run();
+
+	return run ? initcall_end_run(run, true) : 0;
+}
+#else
+static inline void initcall_start_run(struct initcall_run *run,
+				      ulong reloc_ofs)
+{
+}
+
+static inline int initcall_end_run(struct initcall_run *run, bool sync)
+{
+	return 0;
+}
+#endif
+
 /*
  * To enable debugging. add #define DEBUG at the top of the including file.
  *
@@ -51,14 +276,22 @@ static int initcall_is_event(init_fnc_t func)
 int initcall_run_list(const init_fnc_t init_sequence[])
 {
 	ulong reloc_ofs = calc_reloc_ofs();
+	struct initcall_run run;
 	const init_fnc_t *ptr;
-	enum event_t type;
+	enum event_t type = EVT_NONE;
 	init_fnc_t func;
+	ulong start = 0;
 	int ret = 0;
 
+	initcall_start_run(&run, reloc_ofs);
 	for (ptr = init_sequence; func = *ptr, !ret && func; ptr++) {
+		if (func == INITCALL_SYNC) {
+			debug("initcall: sync\n");
+			type = EVT_NONE;
+			ret = initcall_sync();
+			continue;
+		}
 		type = initcall_is_event(func);
-
 		if (type) {
 			if (!CONFIG_IS_ENABLED(EVENT))
 				continue;
@@ -71,8 +304,18 @@ int initcall_run_list(const init_fnc_t init_sequence[])
 			debug("initcall: %p\n", (char *)func - reloc_ofs);
 		}
 
+		if (CONFIG_IS_ENABLED(INITCALL_STATS))
+			start = timer_get_boot_us();
 		ret = type ? event_notify_null(type) : func();
+		if (type)
+			initcall_record(type, start, INITCALLF_EVENT);
+		else
+			initcall_record((ulong)func - reloc_ofs, start, 0);
 	}
+	if (!ret)
+		ret = initcall_end_run(&run, true);
+	else
+		initcall_end_run(&run, false);
 
 	if (ret) {
 		if (CONFIG_IS_ENABLED(EVENT)) {
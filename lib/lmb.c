@@ -13,6 +13,7 @@
 #include <lmb.h>
 #include <log.h>
 #include <malloc.h>
+#include <linux/errno.h>
 
 #include <asm/global_data.h>
 #include <asm/sections.h>
@@ -21,6 +22,15 @@ DECLARE_GLOBAL_DATA_PTR;
 
 #define LMB_ALLOC_ANYWHERE	0
 
+/*
+ * Reserved areas of the EFI memory map. The EFI loader keeps this up to date
+ * with lmb_efi_map_update() as its map changes, so that each struct lmb can
+ * take the areas from here instead of building and walking the EFI map.
+ * If an update fails, lmb_efi_valid is cleared and the EFI map is used.
+ */
+static struct lmb lmb_efi;
+static bool lmb_efi_valid;
+
 static void lmb_dump_region(struct lmb_region *rgn, char *name)
 {
 	unsigned long long base, size, end;
@@ -96,14 +106,112 @@ static long lmb_regions_adjacent(struct lmb_region *rgn, unsigned long r1,
 
 static void lmb_remove_region(struct lmb_region *rgn, unsigned long r)
 {
+	memmove(&rgn->region[r], &rgn->region[r + 1],
+		(rgn->cnt - r - 1) * sizeof(struct lmb_property));
+	rgn->cnt--;
+}
+
+static phys_addr_t lmb_region_end(struct lmb_region *rgn, unsigned long r)
+{
+	return rgn->region[r].base + rgn->region[r].size - 1;
+}
+
+/**
+ * lmb_search() - Find the first region which ends at or above an address
+ *
+ * Since regions are sorted and do not overlap, this is the only region which
+ * can contain @addr, and no region before it can overlap anything at or above
+ * @addr
+ *
+ * @rgn:	regions to search
+ * @addr:	address to look for
+ * Return:	index of the region, or rgn->cnt if all regions end below @addr
+ */
+static unsigned long lmb_search(struct lmb_region *rgn, phys_addr_t addr)
+{
+	unsigned long lo = 0, hi = rgn->cnt, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (lmb_region_end(rgn, mid) < addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/* Make room for at least one more region, moving the regions to the heap */
+static int lmb_grow(struct lmb_region *rgn)
+{
+	struct lmb_property *region;
+	unsigned long max = rgn->max * 2;
+
+	if (!(gd->flags & GD_FLG_FULL_MALLOC_INIT))
+		return -ENOMEM;
+	if (rgn->alloced) {
+		region = realloc(rgn->region, max * sizeof(*region));
+		if (!region)
+			return -ENOMEM;
+	} else {
+		region = malloc(max * sizeof(*region));
+		if (!region)
+			return -ENOMEM;
+		memcpy(region, rgn->region, rgn->cnt * sizeof(*region));
+	}
+	rgn->region = region;
+	rgn->max = max;
+	rgn->alloced = true;
+
+	return 0;
+}
+
+/**
+ * lmb_remove_range() - Remove an address range from a set of regions
+ *
+ * Regions inside the range are removed and those which overlap it are cut
+ * back, splitting a region if the range lies inside it
+ *
+ * @rgn:	regions to update
+ * @base:	start of the range
+ * @size:	size of the range
+ * Return:	0 if OK, -ENOMEM if there was no room to split a region
+ */
+static int lmb_remove_range(struct lmb_region *rgn, phys_addr_t base,
+			    phys_size_t size)
+{
+	phys_addr_t end = base + size - 1;
+	phys_addr_t rgnbase, rgnend;
 	unsigned long i;
 
-	for (i = r; i < rgn->cnt - 1; i++) {
-		rgn->region[i].base = rgn->region[i + 1].base;
-		rgn->region[i].size = rgn->region[i + 1].size;
-		rgn->region[i].flags = rgn->region[i + 1].flags;
+	for (i = lmb_search(rgn, base);
+	     i < rgn->cnt && rgn->region[i].base <= end;) {
+		rgnbase = rgn->region[i].base;
+		rgnend = lmb_region_end(rgn, i);
+		if (rgnbase < base && rgnend > end) {
+			if (rgn->cnt >= rgn->max && lmb_grow(rgn))
+				return -ENOMEM;
+			memmove(&rgn->region[i + 2], &rgn->region[i + 1],
+				(rgn->cnt - i - 1) * sizeof(struct lmb_property));
+			rgn->region[i + 1].base = end + 1;
+			rgn->region[i + 1].size = rgnend - end;
+			rgn->region[i + 1].flags = rgn->region[i].flags;
+			rgn->region[i].size = base - rgnbase;
+			rgn->cnt++;
+			break;
+		} else if (rgnbase < base) {
+			rgn->region[i++].size = base - rgnbase;
+		} else if (rgnend > end) {
+			rgn->region[i].base = end + 1;
+			rgn->region[i].size = rgnend - end;
+			break;
+		} else {
+			lmb_remove_region(rgn, i);
+		}
 	}
-	rgn->cnt--;
+
+	return 0;
 }
 
 /* Assumption: base addr of region 1 < base addr of region 2 */
@@ -133,19 +241,25 @@ static void lmb_fix_over_lap_regions(struct lmb_region *rgn, unsigned long r1,
 
 void lmb_init(struct lmb *lmb)
 {
-#if IS_ENABLED(CONFIG_LMB_USE_MAX_REGIONS)
-	lmb->memory.max = CONFIG_LMB_MAX_REGIONS;
-	lmb->reserved.max = CONFIG_LMB_MAX_REGIONS;
-#else
-	lmb->memory.max = CONFIG_LMB_MEMORY_REGIONS;
-	lmb->reserved.max = CONFIG_LMB_RESERVED_REGIONS;
+	lmb->memory.max = LMB_MEMORY_REGIONS;
+	lmb->reserved.max = LMB_RESERVED_REGIONS;
 	lmb->memory.region = lmb->memory_regions;
 	lmb->reserved.region = lmb->reserved_regions;
-#endif
+	lmb->memory.alloced = false;
+	lmb->reserved.alloced = false;
 	lmb->memory.cnt = 0;
 	lmb->reserved.cnt = 0;
 }
 
+void lmb_uninit(struct lmb *lmb)
+{
+	if (lmb->memory.alloced)
+		free(lmb->memory.region);
+	if (lmb->reserved.alloced)
+		free(lmb->reserved.region);
+	lmb_init(lmb);
+}
+
 void arch_lmb_reserve_generic(struct lmb *lmb, ulong sp, ulong end, ulong align)
 {
 	ulong bank_end;
@@ -196,6 +310,14 @@ static __maybe_unused int efi_lmb_reserve(struct lmb *lmb)
 	efi_uintn_t i, map_size = 0;
 	efi_status_t ret;
 
+	if (lmb_efi_valid) {
+		for (i = 0; i < lmb_efi.reserved.cnt; i++)
+			lmb_reserve_flags(lmb, lmb_efi.reserved.region[i].base,
+					  lmb_efi.reserved.region[i].size,
+					  lmb_efi.reserved.region[i].flags);
+		return 0;
+	}
+
 	ret = efi_get_memory_map_alloc(&map_size, &memmap);
 	if (ret != EFI_SUCCESS)
 		return 1;
@@ -257,24 +379,25 @@ void lmb_init_and_reserve_range(struct lmb *lmb, phys_addr_t base,
 static long lmb_add_region_flags(struct lmb_region *rgn, phys_addr_t base,
 				 phys_size_t size, enum lmb_flags flags)
 {
+	phys_addr_t end = base + size - 1;
 	unsigned long coalesced = 0;
-	long adjacent, i;
+	phys_addr_t rgnbase, rgnend;
+	phys_size_t rgnsize;
+	enum lmb_flags rgnflags;
+	unsigned long i;
+	long adjacent;
 
-	if (rgn->cnt == 0) {
-		rgn->region[0].base = base;
-		rgn->region[0].size = size;
-		rgn->region[0].flags = flags;
-		rgn->cnt = 1;
-		return 0;
-	}
+	/*
+	 * Find the first region which overlaps or touches this one. Any region
+	 * before it lies entirely below, so cannot be coalesced.
+	 */
+	i = lmb_search(rgn, base ? base - 1 : 0);
+	if (i < rgn->cnt) {
+		rgnbase = rgn->region[i].base;
+		rgnsize = rgn->region[i].size;
+		rgnflags = rgn->region[i].flags;
+		rgnend = rgnbase + rgnsize - 1;
 
-	/* First try and coalesce this LMB with another. */
-	for (i = 0; i < rgn->cnt; i++) {
-		phys_addr_t rgnbase = rgn->region[i].base;
-		phys_size_t rgnsize = rgn->region[i].size;
-		phys_size_t rgnflags = rgn->region[i].flags;
-		phys_addr_t end = base + size - 1;
-		phys_addr_t rgnend = rgnbase + rgnsize - 1;
 		if (rgnbase <= base && end <= rgnend) {
 			if (flags == rgnflags)
 				/* Already have this region, so we're done */
@@ -284,26 +407,43 @@ static long lmb_add_region_flags(struct lmb_region *rgn, phys_addr_t base,
 		}
 
 		adjacent = lmb_addrs_adjacent(base, size, rgnbase, rgnsize);
+		if (adjacent < 0 && i < rgn->cnt - 1 &&
+		    lmb_addrs_overlap(base, size, rgn->region[i + 1].base,
+				      rgn->region[i + 1].size) &&
+		    (flags != rgnflags ||
+		     flags != rgn->region[i + 1].flags ||
+		     end > lmb_region_end(rgn, i + 1))) {
+			/* this would overlap the next region */
+			return -1;
+		}
 		if (adjacent > 0) {
-			if (flags != rgnflags)
-				break;
-			rgn->region[i].base -= size;
-			rgn->region[i].size += size;
-			coalesced++;
-			break;
+			if (flags == rgnflags) {
+				rgn->region[i].base -= size;
+				rgn->region[i].size += size;
+				coalesced++;
+			}
 		} else if (adjacent < 0) {
-			if (flags != rgnflags)
-				break;
-			rgn->region[i].size += size;
-			coalesced++;
-			break;
+			if (flags == rgnflags) {
+				rgn->region[i].size += size;
+				coalesced++;
+			} else if (++i < rgn->cnt &&
+				   rgn->region[i].flags == flags &&
+				   lmb_addrs_adjacent(base, size,
+						      rgn->region[i].base,
+						      rgn->region[i].size) > 0) {
+				/* coalesce with the next region instead */
+				rgn->region[i].base -= size;
+				rgn->region[i].size += size;
+				coalesced++;
+			}
 		} else if (lmb_addrs_overlap(base, size, rgnbase, rgnsize)) {
 			/* regions overlap */
 			return -1;
 		}
 	}
 
-	if (i < rgn->cnt - 1 && rgn->region[i].flags == rgn->region[i + 1].flags)  {
+	if (coalesced && i < rgn->cnt - 1 &&
+	    rgn->region[i].flags == rgn->region[i + 1].flags) {
 		if (lmb_regions_adjacent(rgn, i, i + 1)) {
 			lmb_coalesce_regions(rgn, i, i + 1);
 			coalesced++;
@@ -316,29 +456,15 @@ static long lmb_add_region_flags(struct lmb_region *rgn, phys_addr_t base,
 
 	if (coalesced)
 		return coalesced;
-	if (rgn->cnt >= rgn->max)
+	if (rgn->cnt >= rgn->max && lmb_grow(rgn))
 		return -1;
 
 	/* Couldn't coalesce the LMB, so add it to the sorted table. */
-	for (i = rgn->cnt-1; i >= 0; i--) {
-		if (base < rgn->region[i].base) {
-			rgn->region[i + 1].base = rgn->region[i].base;
-			rgn->region[i + 1].size = rgn->region[i].size;
-			rgn->region[i + 1].flags = rgn->region[i].flags;
-		} else {
-			rgn->region[i + 1].base = base;
-			rgn->region[i + 1].size = size;
-			rgn->region[i + 1].flags = flags;
-			break;
-		}
-	}
-
-	if (base < rgn->region[0].base) {
-		rgn->region[0].base = base;
-		rgn->region[0].size = size;
-		rgn->region[0].flags = flags;
-	}
-
+	memmove(&rgn->region[i + 1], &rgn->region[i],
+		(rgn->cnt - i) * sizeof(struct lmb_property));
+	rgn->region[i].base = base;
+	rgn->region[i].size = size;
+	rgn->region[i].flags = flags;
 	rgn->cnt++;
 
 	return 0;
@@ -363,22 +489,18 @@ long lmb_free(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 	struct lmb_region *rgn = &(lmb->reserved);
 	phys_addr_t rgnbegin, rgnend;
 	phys_addr_t end = base + size - 1;
-	int i;
-
-	rgnbegin = rgnend = 0; /* supress gcc warnings */
+	unsigned long i;
 
 	/* Find the region where (base, size) belongs to */
-	for (i = 0; i < rgn->cnt; i++) {
-		rgnbegin = rgn->region[i].base;
-		rgnend = rgnbegin + rgn->region[i].size - 1;
-
-		if ((rgnbegin <= base) && (end <= rgnend))
-			break;
-	}
+	i = lmb_search(rgn, base);
 
 	/* Didn't find the region */
 	if (i == rgn->cnt)
 		return -1;
+	rgnbegin = rgn->region[i].base;
+	rgnend = lmb_region_end(rgn, i);
+	if (rgnbegin > base || end > rgnend)
+		return -1;
 
 	/* Check to see if we are removing entire region */
 	if ((rgnbegin == base) && (rgnend == end)) {
@@ -421,19 +543,49 @@ long lmb_reserve(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 	return lmb_reserve_flags(lmb, base, size, LMB_NONE);
 }
 
+#if CONFIG_IS_ENABLED(EFI_LOADER)
+int lmb_efi_map_update(u64 start, u64 size, int memory_type)
+{
+	struct lmb_region *rgn = &lmb_efi.reserved;
+	phys_addr_t base;
+
+	if (!rgn->region) {
+		lmb_init(&lmb_efi);
+		lmb_efi_valid = true;
+	}
+	if (!lmb_efi_valid)
+		return -ENOMEM;
+
+	base = map_to_sysmem((void *)(uintptr_t)start);
+	if (lmb_remove_range(rgn, base, size))
+		goto err;
+	if (memory_type != EFI_CONVENTIONAL_MEMORY &&
+	    lmb_add_region_flags(rgn, base, size,
+				 memory_type == EFI_RESERVED_MEMORY_TYPE ?
+				 LMB_NOMAP : LMB_NONE) < 0)
+		goto err;
+
+	return 0;
+err:
+	log_debug("Cannot track EFI memory map, using it directly\n");
+	lmb_efi_valid = false;
+	lmb_uninit(&lmb_efi);
+
+	return -ENOMEM;
+}
+#endif
+
 static long lmb_overlaps_region(struct lmb_region *rgn, phys_addr_t base,
 				phys_size_t size)
 {
 	unsigned long i;
 
-	for (i = 0; i < rgn->cnt; i++) {
-		phys_addr_t rgnbase = rgn->region[i].base;
-		phys_size_t rgnsize = rgn->region[i].size;
-		if (lmb_addrs_overlap(base, size, rgnbase, rgnsize))
-			break;
-	}
+	i = lmb_search(rgn, base);
+	if (i < rgn->cnt && lmb_addrs_overlap(base, size, rgn->region[i].base,
+					      rgn->region[i].size))
+		return i;
 
-	return (i < rgn->cnt) ? i : -1;
+	return -1;
 }
 
 phys_addr_t lmb_alloc(struct lmb *lmb, phys_size_t size, ulong align)
@@ -529,22 +681,20 @@ phys_addr_t lmb_alloc_addr(struct lmb *lmb, phys_addr_t base, phys_size_t size)
 /* Return number of bytes from a given address that are free */
 phys_size_t lmb_get_free_size(struct lmb *lmb, phys_addr_t addr)
 {
-	int i;
+	unsigned long i;
 	long rgn;
 
 	/* check if the requested address is in the memory regions */
 	rgn = lmb_overlaps_region(&lmb->memory, addr, 1);
 	if (rgn >= 0) {
-		for (i = 0; i < lmb->reserved.cnt; i++) {
+		i = lmb_search(&lmb->reserved, addr);
+		if (i < lmb->reserved.cnt) {
 			if (addr < lmb->reserved.region[i].base) {
 				/* first reserved range > requested address */
 				return lmb->reserved.region[i].base - addr;
 			}
-			if (lmb->reserved.region[i].base +
-			    lmb->reserved.region[i].size > addr) {
-				/* requested addr is in this reserved range */
-				return 0;
-			}
+			/* requested addr is in this reserved range */
+			return 0;
 		}
 		/* if we come here: no reserved ranges above requested addr */
 		return lmb->memory.region[lmb->memory.cnt - 1].base +
@@ -555,14 +705,12 @@ phys_size_t lmb_get_free_size(struct lmb *lmb, phys_addr_t addr)
 
 int lmb_is_reserved_flags(struct lmb *lmb, phys_addr_t addr, int flags)
 {
-	int i;
+	unsigned long i;
+
+	i = lmb_search(&lmb->reserved, addr);
+	if (i < lmb->reserved.cnt && addr >= lmb->reserved.region[i].base)
+		return (lmb->reserved.region[i].flags & flags) == flags;
 
-	for (i = 0; i < lmb->reserved.cnt; i++) {
-		phys_addr_t upper = lmb->reserved.region[i].base +
-			lmb->reserved.region[i].size - 1;
-		if ((addr >= lmb->reserved.region[i].base) && (addr <= upper))
-			return (lmb->reserved.region[i].flags & flags) == flags;
-	}
 	return 0;
 }
 
@@ -12,6 +12,7 @@
 
 #include <common.h>
 #include <abuf.h>
+#include <fdtdec.h>
 #include <log.h>
 #include <linux/libfdt.h>
 #include <of_live.h>
@@ -319,12 +320,359 @@ int unflatten_device_tree(const void *blob, struct device_node **mynodes)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(OF_LIVE_LAZY)
+/**
+ * struct of_lazy_chunk - A piece of memory allocated for a lazy tree
+ *
+ * @next: Next chunk, or NULL if none
+ * @data: Memory for the caller
+ */
+struct of_lazy_chunk {
+	struct of_lazy_chunk *next;
+	ulong data[];
+};
+
+/**
+ * struct of_lazy_tree - A live tree which is built as it is used
+ *
+ * Nodes are created a level at a time, when the first child of their parent
+ * is requested, and properties are created a node at a time. Everything
+ * points into @blob, so only the node structures, paths and property
+ * structures need to be allocated.
+ *
+ * @root: Root node of the tree
+ * @blob: Flat tree which the live tree is built from
+ * @chunks: Memory allocated for the tree, other than this struct
+ * @size: Number of bytes allocated in @chunks
+ * @nodes: Nodes created so far other than @root, hashed by their offset, or
+ *	NULL if none
+ * @nodes_size: Number of entries in @nodes (a power of two), 0 if none
+ * @node_count: Number of nodes in @nodes
+ */
+struct of_lazy_tree {
+	struct device_node root;
+	const void *blob;
+	struct of_lazy_chunk *chunks;
+	ulong size;
+	struct device_node **nodes;
+	int nodes_size;
+	int node_count;
+};
+
+enum {
+	/* Initial size of the offset map, and how deep a node can be */
+	OF_LAZY_MIN_NODES	= 32,
+	OF_LAZY_MAX_DEPTH	= 32,
+};
+
+static void *of_lazy_alloc(struct of_lazy_tree *tree, int size)
+{
+	struct of_lazy_chunk *chunk;
+
+	chunk = calloc(1, sizeof(*chunk) + size);
+	if (!chunk)
+		return NULL;
+	chunk->next = tree->chunks;
+	tree->chunks = chunk;
+	tree->size += size;
+
+	return chunk->data;
+}
+
+static struct of_lazy_tree *of_lazy_get_tree(struct device_node *np)
+{
+	while (np->parent)
+		np = np->parent;
+
+	return container_of(np, struct of_lazy_tree, root);
+}
+
+/* Node offsets are multiples of 4 */
+static uint of_lazy_hash(struct of_lazy_tree *tree, int offset)
+{
+	return ((uint)offset >> 2) * 2654435761U & (tree->nodes_size - 1);
+}
+
+static struct device_node *of_lazy_lookup(struct of_lazy_tree *tree,
+					  int offset)
+{
+	struct device_node *np;
+	uint i;
+
+	if (!offset)
+		return &tree->root;
+	if (!tree->nodes)
+		return NULL;
+	for (i = of_lazy_hash(tree, offset); (np = tree->nodes[i]);
+	     i = (i + 1) & (tree->nodes_size - 1)) {
+		if (np->offset == offset)
+			return np;
+	}
+
+	return NULL;
+}
+
+static void of_lazy_insert(struct of_lazy_tree *tree, struct device_node *np)
+{
+	uint i;
+
+	for (i = of_lazy_hash(tree, np->offset); tree->nodes[i];
+	     i = (i + 1) & (tree->nodes_size - 1))
+		;
+	tree->nodes[i] = np;
+	tree->node_count++;
+}
+
+/* Make room for another node in the offset map, keeping it half empty */
+static int of_lazy_grow(struct of_lazy_tree *tree)
+{
+	struct device_node **old = tree->nodes;
+	int i, old_size = tree->nodes_size;
+	int size;
+
+	if ((tree->node_count + 1) * 2 <= old_size)
+		return 0;
+	size = old_size ? old_size * 2 : OF_LAZY_MIN_NODES;
+	tree->nodes = calloc(size, sizeof(*tree->nodes));
+	if (!tree->nodes) {
+		tree->nodes = old;
+		return -ENOMEM;
+	}
+	tree->nodes_size = size;
+	tree->node_count = 0;
+	for (i = 0; i < old_size; i++) {
+		if (old[i])
+			of_lazy_insert(tree, old[i]);
+	}
+	free(old);
+
+	return 0;
+}
+
+/* Fill in the fields of a node which can be found without its properties */
+static void of_lazy_setup_node(struct of_lazy_tree *tree,
+			       struct device_node *np, int offset)
+{
+	const char *type;
+
+	np->offset = offset;
+	np->phandle = fdt_get_phandle(tree->blob, offset);
+	type = fdt_getprop(tree->blob, offset, "device_type", NULL);
+	np->type = type ? type : "<NULL>";
+	np->lazy |= OF_LAZY_CHILDREN | OF_LAZY_PROPS;
+}
+
+static struct device_node *of_lazy_new_node(struct of_lazy_tree *tree,
+					    struct device_node *dad, int offset)
+{
+	struct device_node *np;
+	const char *name;
+	int len, dad_len;
+	char *fn;
+
+	name = fdt_get_name(tree->blob, offset, &len);
+	if (!name || of_lazy_grow(tree))
+		return NULL;
+
+	/* The root node's path is "/" but its children do not repeat the / */
+	dad_len = dad->parent ? strlen(dad->full_name) : 0;
+	np = of_lazy_alloc(tree, sizeof(*np) + dad_len + 1 + len + 1);
+	if (!np)
+		return NULL;
+	fn = (char *)(np + 1);
+	memcpy(fn, dad->full_name, dad_len);
+	fn[dad_len] = '/';
+	memcpy(fn + dad_len + 1, name, len + 1);
+	np->full_name = fn;
+	np->name = name;
+	np->parent = dad;
+	of_lazy_setup_node(tree, np, offset);
+	of_lazy_insert(tree, np);
+
+	return np;
+}
+
+void of_live_expand_children(struct device_node *np)
+{
+	struct of_lazy_tree *tree = of_lazy_get_tree(np);
+	struct device_node *child, **prevp = &np->child;
+	int offset;
+
+	fdt_for_each_subnode(offset, tree->blob, np->offset) {
+		child = of_lazy_new_node(tree, np, offset);
+		if (!child) {
+			/* Leave the node unexpanded so that it can be retried */
+			log_err("Cannot expand node '%s'\n", np->full_name);
+			np->child = NULL;
+			return;
+		}
+		*prevp = child;
+		prevp = &child->sibling;
+	}
+	np->lazy &= ~OF_LAZY_CHILDREN;
+}
+
+void of_live_expand_props(struct device_node *np)
+{
+	struct of_lazy_tree *tree = of_lazy_get_tree(np);
+	const void *blob = tree->blob;
+	struct property *pp, **prevp;
+	const char *pname;
+	int offset, count = 0;
+
+	fdt_for_each_property_offset(offset, blob, np->offset)
+		count++;
+	if (count) {
+		pp = of_lazy_alloc(tree, count * sizeof(*pp));
+		if (!pp) {
+			log_err("Cannot expand properties of '%s'\n",
+				np->full_name);
+			return;
+		}
+
+		prevp = &np->properties;
+		fdt_for_each_property_offset(offset, blob, np->offset) {
+			pp->value = (void *)fdt_getprop_by_offset(blob, offset,
+								  &pname,
+								  &pp->length);
+			if (!pp->value)
+				break;
+			pp->name = (char *)pname;
+			*prevp = pp;
+			prevp = &pp->next;
+			pp++;
+		}
+	}
+	np->lazy &= ~OF_LAZY_PROPS;
+}
+
+/*
+ * Find the node for a flat-tree offset, creating it and its parents if needed
+ *
+ * Nodes which have been created already are found in the offset map. For
+ * others, a single pass over the flat tree finds their parents, each of
+ * which is then expanded in turn.
+ */
+static struct device_node *of_lazy_find_offset(struct of_lazy_tree *tree,
+					       int offset)
+{
+	int parents[OF_LAZY_MAX_DEPTH];
+	struct device_node *np;
+	int node, depth, level;
+
+	np = of_lazy_lookup(tree, offset);
+	if (np)
+		return np;
+
+	depth = 0;
+	for (node = 0; node >= 0 && node < offset;
+	     node = fdt_next_node(tree->blob, node, &depth)) {
+		if (depth >= OF_LAZY_MAX_DEPTH)
+			return NULL;
+		parents[depth] = node;
+	}
+	if (node != offset)
+		return NULL;
+
+	np = &tree->root;
+	for (level = 1; np && level <= depth; level++) {
+		of_node_child(np);
+		np = of_lazy_lookup(tree, level < depth ? parents[level] :
+				    offset);
+	}
+
+	return np;
+}
+
+int of_live_find_phandle(struct device_node *root, phandle handle,
+			 struct device_node **npp)
+{
+	struct of_lazy_tree *tree;
+	int offset;
+
+	if (!root || !(root->lazy & OF_LAZY_ROOT))
+		return -ENOSYS;
+	tree = container_of(root, struct of_lazy_tree, root);
+
+	offset = fdtdec_phandle_offset(tree->blob, handle);
+	*npp = offset < 0 ? NULL : of_lazy_find_offset(tree, offset);
+
+	return 0;
+}
+
+int unflatten_device_tree_lazy(const void *blob, struct device_node **rootp)
+{
+	struct of_lazy_tree *tree;
+
+	if (!blob || fdt_check_header(blob))
+		return -EINVAL;
+
+	/* Old trees have full paths in place of unit names */
+	if (fdt_version(blob) < 0x10)
+		return -EPROTONOSUPPORT;
+	if (fdt_totalsize(blob) > OF_LAZY_MAX_OFFSET)
+		return -EFBIG;
+
+	tree = calloc(1, sizeof(*tree));
+	if (!tree)
+		return -ENOMEM;
+	tree->blob = blob;
+	tree->root.name = "";
+	tree->root.full_name = "/";
+	tree->root.lazy = OF_LAZY_ROOT;
+	of_lazy_setup_node(tree, &tree->root, 0);
+	*rootp = &tree->root;
+
+	return 0;
+}
+
+ulong of_live_lazy_size(const struct device_node *root)
+{
+	const struct of_lazy_tree *tree;
+
+	if (!(root->lazy & OF_LAZY_ROOT))
+		return 0;
+	tree = container_of(root, struct of_lazy_tree, root);
+
+	return sizeof(*tree) + tree->size +
+		tree->nodes_size * sizeof(*tree->nodes);
+}
+
+static bool of_lazy_free(struct device_node *root)
+{
+	struct of_lazy_chunk *chunk, *next;
+	struct of_lazy_tree *tree;
+
+	if (!(root->lazy & OF_LAZY_ROOT))
+		return false;
+	tree = container_of(root, struct of_lazy_tree, root);
+	for (chunk = tree->chunks; chunk; chunk = next) {
+		next = chunk->next;
+		free(chunk);
+	}
+	free(tree->nodes);
+	free(tree);
+
+	return true;
+}
+#else
+static bool of_lazy_free(struct device_node *root)
+{
+	return false;
+}
+#endif /* OF_LIVE_LAZY */
+
 int of_live_build(const void *fdt_blob, struct device_node **rootp)
 {
 	int ret;
 
 	debug("%s: start\n", __func__);
-	ret = unflatten_device_tree(fdt_blob, rootp);
+	ret = -ENOSYS;
+	if (CONFIG_IS_ENABLED(OF_LIVE_LAZY))
+		ret = unflatten_device_tree_lazy(fdt_blob, rootp);
+	/* A tree which cannot be built lazily is built in full */
+	if (ret == -ENOSYS || ret == -EFBIG)
+		ret = unflatten_device_tree(fdt_blob, rootp);
 	if (ret) {
 		debug("Failed to create live tree: err=%d\n", ret);
 		return ret;
@@ -341,6 +689,9 @@ int of_live_build(const void *fdt_blob, struct device_node **rootp)
 
 void of_live_free(struct device_node *root)
 {
+	if (of_lazy_free(root))
+		return;
+
 	/* the tree is stored as a contiguous block of memory */
 	free(root);
 }
@@ -402,7 +753,7 @@ static int flatten_node(struct abuf *buf, const struct device_node *node)
 		return log_msg_ret("beg", ret);
 
 	/* First write out the properties */
-	for (pp = node->properties; !ret && pp; pp = pp->next) {
+	for (pp = of_node_props(node); !ret && pp; pp = pp->next) {
 		ret = fdt_property(abuf_data(buf), pp->name, pp->value,
 				   pp->length);
 		ret = check_space(ret, buf);
@@ -413,7 +764,7 @@ static int flatten_node(struct abuf *buf, const struct device_node *node)
 	}
 
 	/* Next write out the subnodes */
-	for (np = node->child; np; np = np->sibling) {
+	for (np = of_node_child(node); np; np = np->sibling) {
 		ret = flatten_node(buf, np);
 		if (ret)
 			return log_msg_ret("sub", ret);
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Sampling profiler
+ *
+ * Samples are written by the architecture's interrupt handler into a ring
+ * buffer, so once it is full the oldest samples are replaced. Nothing here
+ * may be called from the handler except profile_sample(), which must not use
+ * gd since the handler may interrupt an EFI application that has its own
+ * use for the register holding it.
+ */
+
+#define LOG_CATEGORY	LOGC_BOOT
+
+#include <common.h>
+#include <log.h>
+#include <malloc.h>
+#include <profile.h>
+#include <sort.h>
+#include <trace.h>
+#include <asm/global_data.h>
+#include <asm/sections.h>
+#include <linux/errno.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/**
+ * struct profile_state - State of the profiler
+ *
+ * @samples: Ring buffer of samples, with CONFIG_PROFILE_SAMPLES entries
+ * @count: Number of samples taken; the next one goes at @count modulo the
+ *	size of @samples
+ * @base: Address of the start of the U-Boot text
+ * @len: Size of the U-Boot image starting at @base
+ * @period_us: Time between samples in microseconds
+ * @running: true if samples are being taken
+ */
+struct profile_state {
+	struct profile_sample *samples;
+	uint count;
+	ulong base;
+	ulong len;
+	ulong period_us;
+	bool running;
+};
+
+static struct profile_state prof;
+
+static u32 profile_offset(ulong addr)
+{
+	ulong offset = addr - prof.base;
+
+	return offset < prof.len ? offset : PROFILE_OUTSIDE;
+}
+
+void profile_sample(ulong pc, ulong caller)
+{
+	struct profile_sample *sample;
+
+	if (!prof.running)
+		return;
+
+	sample = &prof.samples[prof.count++ % CONFIG_PROFILE_SAMPLES];
+	sample->pc = profile_offset(pc);
+	sample->caller = profile_offset(caller);
+}
+
+int profile_start(ulong period_us)
+{
+	int ret;
+
+	if (prof.running)
+		return -EALREADY;
+	/* The image may still move before relocation */
+	if (!(gd->flags & GD_FLG_RELOC))
+		return log_msg_ret("rel", -EPERM);
+	if (!prof.samples) {
+		prof.samples = malloc(CONFIG_PROFILE_SAMPLES *
+				      sizeof(struct profile_sample));
+		if (!prof.samples)
+			return log_msg_ret("buf", -ENOMEM);
+	}
+
+#ifdef CONFIG_SANDBOX
+	prof.base = (ulong)_init;
+#else
+	prof.base = gd->relocaddr;
+#endif
+	prof.len = gd->mon_len;
+	prof.count = 0;
+	prof.period_us = period_us;
+	prof.running = true;
+	ret = arch_profile_start(period_us);
+	if (ret) {
+		prof.running = false;
+		return log_msg_ret("arch", ret);
+	}
+	log_debug("Profiling every %ldus\n", period_us);
+
+	return 0;
+}
+
+void profile_stop(void)
+{
+	if (!prof.running)
+		return;
+	arch_profile_stop();
+	prof.running = false;
+}
+
+/* Get the number of samples in the buffer and the index of the oldest */
+static uint profile_stored(uint *firstp)
+{
+	uint count = prof.count;
+
+	if (count <= CONFIG_PROFILE_SAMPLES) {
+		*firstp = 0;
+		return count;
+	}
+	*firstp = count % CONFIG_PROFILE_SAMPLES;
+
+	return CONFIG_PROFILE_SAMPLES;
+}
+
+void profile_get_stats(struct profile_stats *stats)
+{
+	uint first, i;
+
+	memset(stats, '\0', sizeof(*stats));
+	stats->count = prof.count;
+	stats->stored = prof.samples ? profile_stored(&first) : 0;
+	for (i = 0; i < stats->stored; i++) {
+		if (prof.samples[i].pc == PROFILE_OUTSIDE)
+			stats->outside++;
+	}
+	stats->period_us = prof.period_us;
+	stats->running = prof.running;
+}
+
+static int h_cmp_u32(const void *v1, const void *v2)
+{
+	u32 a = *(const u32 *)v1, b = *(const u32 *)v2;
+
+	return a < b ? -1 : a > b;
+}
+
+/**
+ * struct profile_hit - Number of samples taken at one address
+ *
+ * @pc: Offset of the address
+ * @count: Number of samples
+ */
+struct profile_hit {
+	u32 pc;
+	u32 count;
+};
+
+static int h_cmp_hits(const void *v1, const void *v2)
+{
+	const struct profile_hit *a = v1, *b = v2;
+
+	if (a->count != b->count)
+		return a->count < b->count ? 1 : -1;
+
+	return h_cmp_u32(&a->pc, &b->pc);
+}
+
+void profile_show(uint max)
+{
+	struct profile_stats stats;
+	struct profile_hit *hits;
+	uint i, n, nhits, inside;
+	u32 *pcs;
+
+	profile_get_stats(&stats);
+	printf("Samples: %u taken every %ldus, %u stored, %u outside U-Boot%s\n",
+	       stats.count, stats.period_us, stats.stored, stats.outside,
+	       stats.running ? " (running)" : "");
+	inside = stats.stored - stats.outside;
+	if (!inside)
+		return;
+
+	/* Sort the addresses so that each one can be counted */
+	pcs = malloc(inside * sizeof(*pcs));
+	hits = malloc(inside * sizeof(*hits));
+	if (!pcs || !hits) {
+		printf("Out of memory\n");
+		goto done;
+	}
+	for (i = 0, n = 0; i < stats.stored; i++) {
+		if (prof.samples[i].pc != PROFILE_OUTSIDE)
+			pcs[n++] = prof.samples[i].pc;
+	}
+	qsort(pcs, inside, sizeof(*pcs), h_cmp_u32);
+
+	for (i = 0, nhits = 0; i < inside; i++) {
+		if (nhits && hits[nhits - 1].pc == pcs[i]) {
+			hits[nhits - 1].count++;
+		} else {
+			hits[nhits].pc = pcs[i];
+			hits[nhits++].count = 1;
+		}
+	}
+	qsort(hits, nhits, sizeof(*hits), h_cmp_hits);
+
+	printf("   Count      %%  Offset\n");
+	for (i = 0; i < nhits && i < max; i++) {
+		printf("%8u  %3u.%u%%  %08x\n", hits[i].count,
+		       hits[i].count * 100 / stats.stored,
+		       hits[i].count * 1000 / stats.stored % 10, hits[i].pc);
+	}
+	if (nhits > max)
+		printf("(%u more addresses)\n", nhits - max);
+done:
+	free(hits);
+	free(pcs);
+}
+
+int profile_list_samples(void *buff, size_t buff_size, size_t *needed)
+{
+	struct trace_output_sample *out;
+	struct trace_output_hdr *hdr;
+	uint first = 0, stored, i, fit;
+	struct profile_sample *sample;
+
+	stored = prof.samples ? profile_stored(&first) : 0;
+	*needed = sizeof(*hdr) + stored * sizeof(*out);
+	if (buff_size < sizeof(*hdr))
+		return -ENOSPC;
+	fit = min((size_t)stored, (buff_size - sizeof(*hdr)) / sizeof(*out));
+
+	hdr = buff;
+	memset(hdr, '\0', sizeof(*hdr));
+	hdr->type = TRACE_CHUNK_SAMPLES;
+	hdr->version = TRACE_VERSION;
+	hdr->rec_count = fit;
+	hdr->text_base = CONFIG_TEXT_BASE;
+
+	/* Write them out oldest first */
+	out = (struct trace_output_sample *)(hdr + 1);
+	for (i = 0; i < fit; i++, out++) {
+		sample = &prof.samples[(first + i) % CONFIG_PROFILE_SAMPLES];
+		out->pc = sample->pc;
+		out->caller = sample->caller;
+	}
+
+	return fit < stored ? -ENOSPC : 0;
+}
+
+__weak int arch_profile_start(ulong period_us)
+{
+	return -ENOSYS;
+}
+
+__weak void arch_profile_stop(void)
+{
+}
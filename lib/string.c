@@ -20,8 +20,30 @@
 #include <linux/types.h>
 #include <linux/string.h>
 #include <linux/ctype.h>
+#include <linux/kernel.h>
 #include <malloc.h>
 
+/*
+ * With CONFIG_STRING_BY_WORD, searches and comparisons look at a word at a
+ * time where the alignment allows it. Only aligned words are read, so a read
+ * past the end of a string never crosses into the next page.
+ */
+static inline bool word_aligned(const void *p)
+{
+	return !((ulong)p & (sizeof(ulong) - 1));
+}
+
+/* Check whether two pointers have the same alignment within a word */
+static inline bool words_match(const void *p, const void *q)
+{
+	return !(((ulong)p ^ (ulong)q) & (sizeof(ulong) - 1));
+}
+
+/* Check whether any byte in a word is zero */
+static inline bool word_has_zero(ulong val)
+{
+	return (val - REPEAT_BYTE(0x01)) & ~val & REPEAT_BYTE(0x80);
+}
 
 /**
  * strncasecmp - Case insensitive, length-limited string comparison
@@ -210,6 +232,20 @@ int strcmp(const char *cs, const char *ct)
 {
 	int ret;
 
+	if (CONFIG_IS_ENABLED(STRING_BY_WORD) && words_match(cs, ct)) {
+		for (; !word_aligned(cs); cs++, ct++) {
+			ret = (unsigned char)*cs - (unsigned char)*ct;
+			if (ret || !*ct)
+				return ret;
+		}
+		/* Skip equal words, finding the difference a byte at a time */
+		while (*(const ulong *)cs == *(const ulong *)ct &&
+		       !word_has_zero(*(const ulong *)cs)) {
+			cs += sizeof(ulong);
+			ct += sizeof(ulong);
+		}
+	}
+
 	while (1) {
 		unsigned char a = *cs++;
 		unsigned char b = *ct++;
@@ -294,9 +330,18 @@ char * strrchr(const char * s, int c)
  */
 size_t strlen(const char * s)
 {
-	const char *sc;
+	const char *sc = s;
 
-	for (sc = s; *sc != '\0'; ++sc)
+	if (CONFIG_IS_ENABLED(STRING_BY_WORD)) {
+		for (; !word_aligned(sc); sc++) {
+			if (!*sc)
+				return sc - s;
+		}
+		while (!word_has_zero(*(const ulong *)sc))
+			sc += sizeof(ulong);
+	}
+
+	for (; *sc != '\0'; ++sc)
 		/* nothing */;
 	return sc - s;
 }
@@ -310,9 +355,21 @@ size_t strlen(const char * s)
  */
 size_t strnlen(const char * s, size_t count)
 {
-	const char *sc;
+	const char *sc = s;
 
-	for (sc = s; count-- && *sc != '\0'; ++sc)
+	if (CONFIG_IS_ENABLED(STRING_BY_WORD)) {
+		for (; count && !word_aligned(sc); count--, sc++) {
+			if (!*sc)
+				return sc - s;
+		}
+		for (; count >= sizeof(ulong); count -= sizeof(ulong)) {
+			if (word_has_zero(*(const ulong *)sc))
+				break;
+			sc += sizeof(ulong);
+		}
+	}
+
+	for (; count-- && *sc != '\0'; ++sc)
 		/* nothing */;
 	return sc - s;
 }
@@ -615,6 +672,15 @@ __used void * memmove(void * dest,const void *src,size_t count)
 	} else {
 		tmp = (char *) dest + count;
 		s = (char *) src + count;
+		if (CONFIG_IS_ENABLED(STRING_BY_WORD) && words_match(tmp, s)) {
+			for (; count && !word_aligned(tmp); count--)
+				*--tmp = *--s;
+			for (; count >= sizeof(ulong); count -= sizeof(ulong)) {
+				tmp -= sizeof(ulong);
+				s -= sizeof(ulong);
+				*(ulong *)tmp = *(ulong *)s;
+			}
+		}
 		while (count--)
 			*--tmp = *--s;
 		}
@@ -632,10 +698,24 @@ __used void * memmove(void * dest,const void *src,size_t count)
  */
 __used int memcmp(const void * cs,const void * ct,size_t count)
 {
-	const unsigned char *su1, *su2;
+	const unsigned char *su1 = cs, *su2 = ct;
 	int res = 0;
 
-	for( su1 = cs, su2 = ct; 0 < count; ++su1, ++su2, count--)
+	if (CONFIG_IS_ENABLED(STRING_BY_WORD) && words_match(su1, su2)) {
+		for (; count && !word_aligned(su1); su1++, su2++, count--) {
+			res = *su1 - *su2;
+			if (res)
+				return res;
+		}
+		for (; count >= sizeof(ulong); count -= sizeof(ulong)) {
+			if (*(const ulong *)su1 != *(const ulong *)su2)
+				break;
+			su1 += sizeof(ulong);
+			su2 += sizeof(ulong);
+		}
+	}
+
+	for (; 0 < count; ++su1, ++su2, count--)
 		if ((res = *su1 - *su2) != 0)
 			break;
 	return res;
@@ -716,6 +796,20 @@ char * strstr(const char * s1,const char * s2)
 void *memchr(const void *s, int c, size_t n)
 {
 	const unsigned char *p = s;
+
+	if (CONFIG_IS_ENABLED(STRING_BY_WORD)) {
+		ulong mask = REPEAT_BYTE((unsigned char)c);
+
+		for (; n && !word_aligned(p); n--, p++) {
+			if (*p == (unsigned char)c)
+				return (void *)p;
+		}
+		for (; n >= sizeof(ulong); n -= sizeof(ulong)) {
+			if (word_has_zero(*(const ulong *)p ^ mask))
+				break;
+			p += sizeof(ulong);
+		}
+	}
 	while (n-- != 0) {
 		if ((unsigned char)c == *p++) {
 			return (void *)(p-1);
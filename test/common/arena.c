@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the scoped arena
+ */
+
+#include <common.h>
+#include <arena.h>
+#include <command.h>
+#include <console.h>
+#include <fs.h>
+#include <malloc.h>
+#include <slab.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <asm/cache.h>
+
+/* Test allocating from nested scopes */
+static int test_arena_scope(struct unit_test_state *uts)
+{
+	struct arena_stats stats, before, mid;
+	int outer, inner;
+	ulong start;
+	void *ptr, *big, *small;
+
+	start = ut_check_free();
+	arena_get_stats(&before);
+
+	outer = arena_push();
+	ut_assert(outer > 0);
+	ptr = arena_alloc(10);
+	ut_assertnonnull(ptr);
+	ut_assert(IS_ALIGNED((ulong)ptr, ARCH_DMA_MINALIGN));
+	arena_get_stats(&mid);
+	ut_asserteq(outer, mid.depth);
+	ut_asserteq(before.used + ARCH_DMA_MINALIGN, mid.used);
+
+	/* An allocation from an outer scope stays until that scope is popped */
+	inner = arena_push();
+	ut_asserteq(outer + 1, inner);
+	arena_free(ptr);
+	arena_get_stats(&stats);
+	ut_asserteq(mid.used, stats.used);
+
+	/* Too big for a normal chunk, so it gets its own */
+	big = arena_alloc(CONFIG_ARENA_CHUNK_SIZE * 2);
+	ut_assertnonnull(big);
+	memset(big, '\xff', CONFIG_ARENA_CHUNK_SIZE * 2);
+	arena_get_stats(&stats);
+	ut_assert(stats.size >= mid.size + CONFIG_ARENA_CHUNK_SIZE * 2);
+
+	/* Freeing the most recent allocation releases its chunk */
+	arena_free(big);
+	arena_get_stats(&stats);
+	ut_asserteq(mid.size, stats.size);
+	ut_asserteq(mid.used, stats.used);
+
+	/* Only the most recent allocation can be given back */
+	small = arena_alloc(20);
+	ut_assertnonnull(small);
+	ut_assertnonnull(arena_alloc(20));
+	arena_free(small);
+	arena_get_stats(&stats);
+	ut_asserteq(mid.used + ARCH_DMA_MINALIGN * 2, stats.used);
+
+	/* Popping releases everything else */
+	big = arena_alloc(CONFIG_ARENA_CHUNK_SIZE * 2);
+	ut_assertnonnull(big);
+	ut_assertnonnull(arena_alloc(10));
+	arena_free(big);
+	arena_pop(inner);
+	arena_get_stats(&stats);
+	ut_asserteq(outer, stats.depth);
+	ut_asserteq(mid.size, stats.size);
+	ut_asserteq(mid.used, stats.used);
+
+	/* Memory from elsewhere is passed to free() */
+	arena_free(malloc(100));
+
+	arena_pop(outer);
+	arena_get_stats(&stats);
+	ut_asserteq(before.depth, stats.depth);
+	ut_asserteq(before.size, stats.size);
+	ut_asserteq(start, ut_check_free());
+
+	/* Popping a scope which failed to push does nothing */
+	arena_pop(-ENOSPC);
+	arena_get_stats(&stats);
+	ut_asserteq(before.depth, stats.depth);
+
+	return 0;
+}
+COMMON_TEST(test_arena_scope, 0);
+
+/* Test that a long run of commands does not grow the heap */
+static int test_arena_commands(struct unit_test_state *uts)
+{
+	ulong start = 0;
+	int i;
+
+	for (i = 0; i < 200; i++) {
+		ut_assertok(run_command("env set arena_test abc", 0));
+		ut_assertok(run_command("printenv arena_test", 0));
+		ut_assertok(run_command("meminfo", 0));
+		console_record_reset();
+		if (!i)
+			start = ut_check_free();
+	}
+	ut_asserteq(start, ut_check_free());
+
+	ut_assertok(run_command("meminfo", 0));
+	ut_assert_nextlinen("DRAM:");
+	ut_assert_nextlinen("Heap:");
+	ut_assert_nextlinen("       in use ");
+	ut_assert_nextlinen("       free ");
+	ut_assert_nextlinen("Arena: ");
+	if (CONFIG_IS_ENABLED(SLAB)) {
+		int count = ll_entry_count(struct slab_cache, slab_cache);
+
+		ut_assert_nextline("Slab:  name          size  used  peak  pages   saved");
+		for (i = 0; i < count; i++)
+			ut_assert_nextlinen("       ");
+		ut_assert_nextlinen("       total ");
+	}
+	ut_assert_console_end();
+	ut_assertok(run_command("env set arena_test", 0));
+
+	return 0;
+}
+COMMON_TEST(test_arena_commands, UT_TESTF_CONSOLE_REC);
+
+/* Test that filesystem access reuses the arena and does not grow the heap */
+static int test_arena_fs(struct unit_test_state *uts)
+{
+	struct arena_stats stats, before;
+	ulong start = 0;
+	int depth, i;
+
+	/*
+	 * Each call allocates and frees a FAT iterator, so many calls within
+	 * one scope should use no more of the arena than the first
+	 */
+	depth = arena_push();
+	ut_assert(depth > 0);
+	for (i = 0; i < 20; i++) {
+		ut_assertok(fs_set_blk_dev("mmc", "1:1", FS_TYPE_FAT));
+		ut_asserteq(1, fs_exists("/extlinux/extlinux.conf"));
+		if (!i)
+			arena_get_stats(&before);
+	}
+	arena_get_stats(&stats);
+	ut_asserteq(before.chunks, stats.chunks);
+	ut_asserteq(before.size, stats.size);
+	ut_asserteq(before.used, stats.used);
+	arena_pop(depth);
+
+	for (i = 0; i < 100; i++) {
+		ut_assertok(run_command("fatls mmc 1:1 /extlinux", 0));
+		ut_assertok(run_command("load mmc 1:1 1000 /extlinux/extlinux.conf",
+					0));
+		console_record_reset();
+		if (!i)
+			start = ut_check_free();
+	}
+	ut_asserteq(start, ut_check_free());
+
+	return 0;
+}
+COMMON_TEST(test_arena_fs, UT_TESTF_DM | UT_TESTF_SCAN_FDT |
+	    UT_TESTF_CONSOLE_REC);
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for bootstage spans and export
+ */
+
+#include <common.h>
+#include <bootstage.h>
+#include <command.h>
+#include <console.h>
+#include <env.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Get the start time and duration of a span from the exported JSON */
+static int get_span_times(struct unit_test_state *uts, const char *buf,
+			  const char *name, ulong *startp, ulong *durp)
+{
+	char key[40];
+	const char *p;
+
+	snprintf(key, sizeof(key), "{\"name\":\"%s\",", name);
+	p = strstr(buf, key);
+	ut_assertnonnull(p);
+	p = strstr(p, "\"ts\":");
+	ut_assertnonnull(p);
+	*startp = simple_strtoul(p + 5, NULL, 10);
+	p = strstr(p, "\"dur\":");
+	ut_assertnonnull(p);
+	*durp = simple_strtoul(p + 6, NULL, 10);
+
+	return 0;
+}
+
+/* Format a time as 'bootstage report' does, with print_grouped_ull() */
+static const char *grouped(char *str, ulong val)
+{
+	char digits[12];
+	int i, len = 0;
+
+	snprintf(digits, sizeof(digits), "%9lu", val);
+	for (i = 0; digits[i]; i++) {
+		if (i && !(i % 3))
+			str[len++] = digits[i - 1] != ' ' ? ',' : ' ';
+		str[len++] = digits[i];
+	}
+	str[len] = '\0';
+
+	return str;
+}
+
+/* Check the report line for a span, using the times in the exported JSON */
+static int check_span_line(struct unit_test_state *uts, const char *buf,
+			   const char *name, const char *rest)
+{
+	char start[16], dur[16];
+	ulong start_us, dur_us;
+
+	ut_assertok(get_span_times(uts, buf, name, &start_us, &dur_us));
+	ut_assert_nextline("%s%s  %s", grouped(start, start_us),
+			   grouped(dur, dur_us), rest);
+
+	return 0;
+}
+
+/* Test recording nested spans and exporting them */
+static int test_bootstage_spans(struct unit_test_state *uts)
+{
+	int outer, inner, other, len, i, fill;
+	char *buf;
+
+	/* Fill the table, so that all the earlier spans are recycled */
+	for (i = 0; i < CONFIG_BOOTSTAGE_SPAN_COUNT; i++) {
+		fill = bootstage_span_begin("test_fill", NULL);
+		ut_assert(fill >= 0);
+		bootstage_span_end(fill, 0);
+	}
+
+	/* Each of these recycles the oldest of those */
+	outer = bootstage_span_begin("test_outer", NULL);
+	ut_assert(outer >= 0);
+	inner = bootstage_span_begin("test_inner", "test_dev");
+	ut_asserteq(outer + 1, inner);
+	bootstage_span_end(inner, 512);
+
+	/* This is inside outer, which ends first */
+	other = bootstage_span_begin("test_other", NULL);
+	ut_asserteq(inner + 1, other);
+	bootstage_span_end(outer, 0);
+	bootstage_span_end(other, 0);
+	bootstage_span_end(-ENOSPC, 0);
+
+	len = bootstage_export(NULL, 0);
+	buf = malloc(len + 1);
+	ut_assertnonnull(buf);
+	ut_asserteq(len, bootstage_export(buf, len + 1));
+	ut_asserteq(len, strlen(buf));
+	ut_asserteq('[', buf[0]);
+	ut_asserteq(']', buf[len - 1]);
+	ut_assertnonnull(strstr(buf, "{\"name\":\"reset\",\"cat\":\"mark\","
+				"\"ph\":\"i\",\"pid\":1,\"tid\":1,"
+				"\"s\":\"p\",\"ts\":0}"));
+	ut_assertnonnull(strstr(buf, "{\"name\":\"test_outer\",\"cat\":\"U-Boot\","
+				"\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"));
+	ut_assertnonnull(strstr(buf, "{\"name\":\"test_inner\",\"cat\":\"U-Boot\","
+				"\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":"));
+	ut_assertnonnull(strstr(buf, "\"args\":{\"bytes\":512,"
+				"\"device\":\"test_dev\"}}"));
+
+	/* The report shows the spans in the order they started */
+	console_record_reset_enable();
+	bootstage_report();
+	ut_assert_skip_to_line("Spans:");
+	ut_assert_nextline("%11s%11s  %s", "Start", "Duration", "Span");
+	for (i = 3; i < CONFIG_BOOTSTAGE_SPAN_COUNT; i++)
+		ut_assert_skipline();
+	ut_assertok(check_span_line(uts, buf, "test_outer", "test_outer"));
+	ut_assertok(check_span_line(uts, buf, "test_inner",
+				    "  test_inner (test_dev), 512 bytes"));
+	ut_assertok(check_span_line(uts, buf, "test_other", "  test_other"));
+	ut_assert_nextlinen("Dropped ");
+	ut_assert_nextline("Please increase CONFIG_(SPL_TPL_)BOOTSTAGE_SPAN_COUNT");
+	ut_assert_console_end();
+
+	/* The output is truncated if the buffer is too small */
+	ut_asserteq(len, bootstage_export(buf, 10));
+	ut_asserteq(9, strlen(buf));
+	free(buf);
+
+	/* Try the command, writing to memory */
+	ut_assertok(run_commandf("bootstage export 1000 %x", len + 1));
+	ut_asserteq(len, env_get_hex("filesize", 0));
+	buf = map_sysmem(0x1000, len + 1);
+	ut_asserteq('[', buf[0]);
+	unmap_sysmem(buf);
+	ut_asserteq(1, run_command("bootstage export 1000 10", 0));
+	ut_assert_nextline("Error: truncated (%#x bytes needed)", len + 1);
+	ut_assert_console_end();
+
+	return 0;
+}
+COMMON_TEST(test_bootstage_spans, UT_TESTF_CONSOLE_REC);
@@ -105,3 +105,42 @@ static int test_event_probe(struct unit_test_state *uts)
 	return 0;
 }
 COMMON_TEST(test_event_probe, UT_TESTF_DM | UT_TESTF_SCAN_FDT);
+
+static int h_count(void *ctx, struct event *event)
+{
+	int *countp = ctx;
+
+	(*countp)++;
+
+	return 0;
+}
+
+/* Check that spies only see their own events and that events are counted */
+static int test_event_stats(struct unit_test_state *uts)
+{
+	struct event_stats before, after;
+	int count = 0, other = 0;
+
+	ut_assertok(event_register("count", EVT_TEST, h_count, &count));
+	ut_assertok(event_register("other", EVT_MAIN_LOOP, h_count, &other));
+	ut_asserteq(-EINVAL, event_register("bad", EVT_COUNT, h_count, NULL));
+
+	event_get_stats(EVT_TEST, &before);
+	ut_assertok(event_notify_null(EVT_TEST));
+	ut_assertok(event_notify_null(EVT_TEST));
+	ut_asserteq(2, count);
+	ut_asserteq(0, other);
+	ut_asserteq(-EINVAL, event_notify_null(EVT_COUNT));
+
+	if (!CONFIG_IS_ENABLED(EVENT_DEBUG)) {
+		ut_asserteq(-ENOSYS, event_get_stats(EVT_TEST, &after));
+		return 0;
+	}
+	ut_assertok(event_get_stats(EVT_TEST, &after));
+	ut_asserteq(before.count + 2, after.count);
+	ut_assert(after.time_us >= before.time_us);
+	ut_asserteq(-EINVAL, event_get_stats(EVT_COUNT, &after));
+
+	return 0;
+}
+COMMON_TEST(test_event_stats, 0);
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for running init sequences
+ */
+
+#include <common.h>
+#include <bootstage.h>
+#include <command.h>
+#include <console.h>
+#include <initcall.h>
+#include <vsprintf.h>
+#include <asm/global_data.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* How long the slow initcall takes */
+#define INITCALL_TEST_DELAY_US	2000
+
+/* Records the order in which things happen */
+static char initcall_trace[10];
+static int initcall_trace_len;
+
+static void initcall_mark(char ch)
+{
+	if (initcall_trace_len < sizeof(initcall_trace) - 1)
+		initcall_trace[initcall_trace_len++] = ch;
+}
+
+static int initcall_test_done(void *ctx)
+{
+	initcall_mark(*(char *)ctx);
+
+	return 0;
+}
+
+static int initcall_test_fail(void *ctx)
+{
+	initcall_mark('x');
+
+	return -EIO;
+}
+
+static int initcall_test_start_a(void)
+{
+	static char id = 'A';
+
+	initcall_mark('a');
+
+	return initcall_defer(initcall_test_done, &id);
+}
+
+static int initcall_test_start_b(void)
+{
+	static char id = 'B';
+
+	initcall_mark('b');
+
+	return initcall_defer(initcall_test_done, &id);
+}
+
+static int initcall_test_slow(void)
+{
+	ulong start = timer_get_boot_us();
+
+	initcall_mark('s');
+	while (timer_get_boot_us() - start < INITCALL_TEST_DELAY_US)
+		;
+
+	return 0;
+}
+
+static int initcall_test_start_fail(void)
+{
+	initcall_mark('f');
+
+	return initcall_defer(initcall_test_fail, NULL);
+}
+
+/* Like run_main_loop(), which must finish the work as it does not return */
+static int initcall_test_finish(void)
+{
+	int ret;
+
+	initcall_mark('e');
+	ret = initcall_finish();
+	if (ret)
+		return ret;
+
+	/* Nothing is deferred after this */
+	return initcall_test_start_b();
+}
+
+static void initcall_reset_trace(void)
+{
+	memset(initcall_trace, '\0', sizeof(initcall_trace));
+	initcall_trace_len = 0;
+}
+
+/* Test that deferred work is done at the right point */
+static int test_initcall_defer(struct unit_test_state *uts)
+{
+	static const init_fnc_t seq_sync[] = {
+		initcall_test_start_a,
+		initcall_test_start_b,
+		initcall_test_slow,
+		INITCALL_SYNC,
+		initcall_test_slow,
+		NULL,
+	};
+	static const init_fnc_t seq_end[] = {
+		initcall_test_start_a,
+		initcall_test_slow,
+		initcall_test_slow,
+		NULL,
+	};
+	static const init_fnc_t seq_finish[] = {
+		initcall_test_start_a,
+		initcall_test_slow,
+		initcall_test_finish,
+		initcall_test_slow,
+		NULL,
+	};
+	static const init_fnc_t seq_fail[] = {
+		initcall_test_start_fail,
+		initcall_test_slow,
+		INITCALL_SYNC,
+		initcall_test_slow,
+		NULL,
+	};
+	static char id = 'C';
+
+	initcall_reset_trace();
+	ut_assertok(initcall_run_list(seq_sync));
+	ut_asserteq_str("absABs", initcall_trace);
+
+	/* Work is finished at the end of the list */
+	initcall_reset_trace();
+	ut_assertok(initcall_run_list(seq_end));
+	ut_asserteq_str("assA", initcall_trace);
+
+	/* ...or earlier, by an initcall which does not return */
+	initcall_reset_trace();
+	ut_assertok(initcall_run_list(seq_finish));
+	ut_asserteq_str("aseAbBs", initcall_trace);
+	ut_assertnull(gd_initcall_run());
+
+	/* A failure stops the sequence */
+	initcall_reset_trace();
+	console_record_reset_enable();
+	ut_asserteq(-EIO, initcall_run_list(seq_fail));
+	ut_asserteq_str("fsx", initcall_trace);
+	ut_assert_nextlinen("initcall deferred call");
+	ut_assert_nextlinen("initcall failed");
+	ut_assert_console_end();
+
+	/* Outside an init sequence, the work is done straight away */
+	initcall_reset_trace();
+	ut_assertok(initcall_defer(initcall_test_done, &id));
+	ut_asserteq_str("C", initcall_trace);
+
+	return 0;
+}
+COMMON_TEST(test_initcall_defer, UT_TESTF_CONSOLE_REC);
+
+#if CONFIG_IS_ENABLED(INITCALL_STATS)
+/* Test that the time taken by each initcall is recorded */
+static int test_initcall_stats(struct unit_test_state *uts)
+{
+	static const init_fnc_t seq[] = {
+		initcall_test_start_a,
+		initcall_test_slow,
+		INITCALL_SYNC,
+		initcall_test_slow,
+		NULL,
+	};
+	struct initcall_stats *stats;
+	struct initcall_stat *rec;
+	ulong time_us, prev = ULONG_MAX, total = 0;
+	char line[80], *p;
+	int i, count;
+
+	/* The init sequences have run already, so there are some records */
+	stats = gd_initcall_stats();
+	ut_assertnonnull(stats);
+	ut_assert(stats->count > 10);
+	count = stats->count;
+
+	initcall_reset_trace();
+	ut_assertok(initcall_run_list(seq));
+	ut_asserteq(count + 4, stats->count);
+	rec = &stats->rec[count];
+
+	ut_asserteq((ulong)initcall_test_start_a - gd->reloc_off, rec[0].func);
+	ut_asserteq(INITCALLF_RELOC, rec[0].flags);
+	ut_asserteq((ulong)initcall_test_slow - gd->reloc_off, rec[1].func);
+	ut_assert(rec[1].time_us >= INITCALL_TEST_DELAY_US);
+	ut_asserteq((ulong)initcall_test_done - gd->reloc_off, rec[2].func);
+	ut_asserteq(INITCALLF_RELOC | INITCALLF_DEFERRED, rec[2].flags);
+	ut_assert(rec[3].time_us >= INITCALL_TEST_DELAY_US);
+
+	/* The slowest come first */
+	console_record_reset_enable();
+	ut_assertok(run_command("initcall stats", 0));
+	ut_assert_nextline("    Time  Phase  Initcall");
+	for (i = 0; i < count + 4; i++) {
+		ut_assert(console_record_readline(line, sizeof(line)) > 0);
+		for (p = line; *p == ' '; p++)
+			;
+		time_us = dectoul(p, NULL);
+		ut_assert(time_us <= prev);
+		prev = time_us;
+		total += time_us;
+	}
+	ut_assert_nextlinen("%8lu  total of %d initcalls", total, count + 4);
+	ut_assert_console_end();
+
+	/* Put things back as they were */
+	stats->count = count;
+
+	return 0;
+}
+COMMON_TEST(test_initcall_stats, UT_TESTF_CONSOLE_REC);
+#endif
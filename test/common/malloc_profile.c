@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the heap profiler
+ */
+
+#include <common.h>
+#include <command.h>
+#include <console.h>
+#include <malloc.h>
+#include <malloc_profile.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include <asm/global_data.h>
+#include <linux/compiler.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* The barriers stop these being tail calls, which would hide the caller */
+static noinline void *prof_test_alloc(size_t size)
+{
+	void *ptr = malloc(size);
+
+	barrier();
+
+	return ptr;
+}
+
+static noinline void *prof_test_realloc(void *ptr, size_t size)
+{
+	ptr = realloc(ptr, size);
+	barrier();
+
+	return ptr;
+}
+
+/* Find the call site inside a function, which only makes one call */
+static struct malloc_site *find_site(void *func)
+{
+	struct malloc_profile *prof = gd->malloc_profile;
+	struct malloc_site *site;
+	uint i;
+
+	for (i = 0; i < prof->num_sites; i++) {
+		site = &prof->sites[i];
+		if (site->caller > (ulong)func && site->caller < (ulong)func + 0x40)
+			return malloc_profile_find(site->caller);
+	}
+
+	return NULL;
+}
+
+/* Test that allocations are charged to their caller */
+static int test_malloc_profile(struct unit_test_state *uts)
+{
+	struct malloc_profile *prof = gd->malloc_profile;
+	struct malloc_site *site, *rsite;
+	struct malloc_site before;
+	uint dropped;
+	void *ptr[3];
+
+	ut_assertnonnull(prof);
+	ut_assertnonnull(prof->live);
+
+	/* Every allocation here must be recorded for the counts to add up */
+	dropped = prof->dropped;
+
+	ptr[0] = prof_test_alloc(100);
+	ut_assertnonnull(ptr[0]);
+	site = find_site(prof_test_alloc);
+	ut_assertnonnull(site);
+	before = *site;
+	before.count--;
+	before.bytes -= 100;
+	before.total--;
+
+	ptr[1] = prof_test_alloc(200);
+	ptr[2] = prof_test_alloc(300);
+	ut_asserteq(dropped, prof->dropped);
+	ut_asserteq(before.count + 3, site->count);
+	ut_asserteq(before.bytes + 600, site->bytes);
+	ut_asserteq(before.total + 3, site->total);
+	ut_assert(site->peak_count >= before.count + 3);
+	ut_assert(site->peak_bytes >= before.bytes + 600);
+
+	/* The new memory is charged to realloc()'s caller */
+	ptr[0] = prof_test_realloc(ptr[0], 1000);
+	ut_assertnonnull(ptr[0]);
+	rsite = find_site(prof_test_realloc);
+	ut_assertnonnull(rsite);
+	ut_asserteq(before.count + 2, site->count);
+	ut_asserteq(before.bytes + 500, site->bytes);
+	ut_assert(rsite->count > 0);
+	ut_assert(rsite->bytes >= 1000);
+
+	free(ptr[0]);
+	free(ptr[1]);
+	free(ptr[2]);
+	ut_asserteq(dropped, prof->dropped);
+	ut_asserteq(before.count, site->count);
+	ut_asserteq(before.bytes, site->bytes);
+	ut_asserteq(before.total + 3, site->total);
+	ut_assert(site->peak_bytes >= before.bytes + 600);
+
+	return 0;
+}
+COMMON_TEST(test_malloc_profile, 0);
+
+/* Test the 'malloc dump' command */
+static int test_malloc_profile_dump(struct unit_test_state *uts)
+{
+	struct malloc_profile *prof = gd->malloc_profile;
+	char header[80];
+
+	snprintf(header, sizeof(header), "%-*s  %6s %6s %10s %10s %7s",
+		 (int)sizeof(long) * 2, "caller", "count", "peak", "bytes",
+		 "peak", "total");
+	ut_assertok(run_command("malloc dump 1", 0));
+	ut_assert_skipline();
+	ut_assert_nextline("%s", header);
+	ut_assert_skipline();
+	if (prof->num_early) {
+		ut_assert_nextline("%s", "");
+		ut_assert_nextline("Before the full heap was ready:");
+		ut_assert_nextline("%s", header);
+		ut_assert_skipline();
+	}
+	ut_assert_console_end();
+
+	return 0;
+}
+COMMON_TEST(test_malloc_profile_dump, UT_TESTF_CONSOLE_REC);
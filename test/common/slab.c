@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for slab caches
+ */
+
+#include <common.h>
+#include <command.h>
+#include <console.h>
+#include <malloc.h>
+#include <slab.h>
+#include <test/common.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+struct slab_test_obj {
+	ulong val[5];
+};
+
+SLAB_CACHE(slab_test, struct slab_test_obj);
+
+enum {
+	SLAB_TEST_COUNT	= 300,
+};
+
+/* Test allocating and freeing enough objects to need several pages */
+static int test_slab_alloc(struct unit_test_state *uts)
+{
+	struct slab_cache *cache = SLAB_CACHE_GET(slab_test);
+	struct slab_test_obj *obj[SLAB_TEST_COUNT];
+	ulong start;
+	void *ptr;
+	int i, j;
+
+	start = ut_check_free();
+	ut_asserteq(0, cache->live);
+	ut_asserteq(0, cache->pages);
+
+	for (i = 0; i < SLAB_TEST_COUNT; i++) {
+		obj[i] = slab_alloc(cache);
+		ut_assertnonnull(obj[i]);
+		for (j = 0; j < ARRAY_SIZE(obj[i]->val); j++) {
+			ut_asserteq(0, obj[i]->val[j]);
+			obj[i]->val[j] = i;
+		}
+	}
+	ut_asserteq(SLAB_TEST_COUNT, cache->live);
+	ut_asserteq(SLAB_TEST_COUNT, cache->peak);
+	ut_assert(cache->pages > 1);
+	ut_assert(slab_heap_size(cache) < slab_malloc_size(cache));
+
+	/* The objects must not overlap */
+	for (i = 0; i < SLAB_TEST_COUNT; i++) {
+		for (j = 0; j < ARRAY_SIZE(obj[i]->val); j++)
+			ut_asserteq(i, obj[i]->val[j]);
+	}
+
+	/* A freed object is handed out again, and zeroed */
+	ptr = obj[10];
+	slab_free(cache, obj[10]);
+	obj[10] = slab_alloc(cache);
+	ut_asserteq_ptr(ptr, obj[10]);
+	ut_asserteq(0, obj[10]->val[0]);
+
+	/* Memory from elsewhere is passed to free() */
+	slab_free(cache, malloc(sizeof(struct slab_test_obj)));
+
+	for (i = 0; i < SLAB_TEST_COUNT; i++)
+		slab_free(cache, obj[i]);
+	ut_asserteq(0, cache->live);
+	ut_asserteq(0, cache->pages);
+	ut_asserteq(start, ut_check_free());
+
+	return 0;
+}
+COMMON_TEST(test_slab_alloc, 0);
+
+/* Test that meminfo shows the caches */
+static int test_slab_meminfo(struct unit_test_state *uts)
+{
+	struct slab_cache *cache = SLAB_CACHE_GET(slab_test);
+	void *ptr;
+
+	ptr = slab_alloc(cache);
+	ut_assertnonnull(ptr);
+	ut_assertok(run_command("meminfo", 0));
+	ut_assert_skip_to_line("Slab:  name          size  used  peak  pages   saved");
+	ut_assert_skip_to_line("       %-12s %5u %5u %5u %6u %7ld", "slab_test",
+			       cache->size, 1, cache->peak, 1,
+			       (long)(slab_malloc_size(cache) -
+				      slab_heap_size(cache)));
+	slab_free(cache, ptr);
+
+	return 0;
+}
+COMMON_TEST(test_slab_meminfo, UT_TESTF_CONSOLE_REC);
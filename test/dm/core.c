@@ -6,13 +6,19 @@
  */
 
 #include <common.h>
+#include <command.h>
 #include <errno.h>
 #include <dm.h>
+#include <event.h>
 #include <fdtdec.h>
 #include <log.h>
 #include <malloc.h>
+#include <time.h>
 #include <asm/global_data.h>
+#include <linux/libfdt.h>
 #include <dm/device-internal.h>
+#include <dm/devres.h>
+#include <dm/lists.h>
 #include <dm/root.h>
 #include <dm/util.h>
 #include <dm/test.h>
@@ -1353,3 +1359,282 @@ static int dm_test_dev_get_mem(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_dev_get_mem, UT_TESTF_SCAN_FDT);
+
+/* Test that looking up drivers by compatible string matches a linear scan */
+static int dm_test_lists_match_compat(struct unit_test_state *uts)
+{
+	struct driver *driver = ll_entry_start(struct driver, driver);
+	const int n_ents = ll_entry_count(struct driver, driver);
+	const struct udevice_id *id, *found, *expect;
+	struct driver *drv, *entry;
+	ulong start, indexed, scanned;
+	int count = 0;
+
+	start = timer_get_us();
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++)
+			ut_assertnonnull(lists_driver_match_compat(id->compatible,
+								   &found));
+	}
+	indexed = timer_get_us() - start;
+
+	start = timer_get_us();
+	for (entry = driver; entry != driver + n_ents; entry++) {
+		for (id = entry->of_match; id && id->compatible; id++) {
+			/* The first driver in the list with the string wins */
+			for (drv = driver; drv != entry + 1; drv++) {
+				for (expect = drv->of_match;
+				     expect && expect->compatible; expect++) {
+					if (!strcmp(expect->compatible,
+						    id->compatible))
+						goto matched;
+				}
+			}
+matched:
+			ut_asserteq_ptr(drv, lists_driver_match_compat(id->compatible,
+								       &found));
+			ut_asserteq_ptr(expect, found);
+			count++;
+		}
+	}
+	scanned = timer_get_us() - start;
+
+	ut_assertnull(lists_driver_match_compat("not,a-device", &found));
+	printf("%d compatible strings: lookup %lu us, scan and lookup %lu us\n",
+	       count, indexed, scanned);
+
+	return 0;
+}
+DM_TEST(dm_test_lists_match_compat, 0);
+
+/* Check uclass and device lookups against list walks, and time them */
+static int dm_test_uclass_lookup(struct unit_test_state *uts)
+{
+	struct udevice *dev, *found;
+	ulong start, uc_us, dev_us;
+	struct uclass *uc, *iter;
+	enum uclass_id id;
+	int i, count = 0;
+
+	start = timer_get_us();
+	for (i = 0; i < 100; i++) {
+		for (id = 0; id < UCLASS_COUNT; id++) {
+			uc = uclass_find(id);
+
+			/* The result must match a walk through the list */
+			if (!i) {
+				struct uclass *expect = NULL;
+
+				list_for_each_entry(iter, gd->uclass_root,
+						    sibling_node) {
+					if (iter->uc_drv->id == id) {
+						expect = iter;
+						break;
+					}
+				}
+				ut_asserteq_ptr(expect, uc);
+			}
+		}
+	}
+	uc_us = timer_get_us() - start;
+	ut_assertnull(uclass_find(UCLASS_INVALID));
+
+	start = timer_get_us();
+	for (i = 0; i < 100; i++) {
+		uclass_id_foreach_dev(UCLASS_TEST_FDT, dev, uc) {
+			if (dev_seq(dev) != -1) {
+				ut_assertok(uclass_find_device_by_seq(UCLASS_TEST_FDT,
+								      dev_seq(dev),
+								      &found));
+				ut_asserteq_ptr(dev, found);
+			}
+			if (dev_has_ofnode(dev)) {
+				ut_assertok(uclass_find_device_by_ofnode(UCLASS_TEST_FDT,
+									 dev_ofnode(dev),
+									 &found));
+				ut_asserteq_ptr(dev, found);
+			}
+			count++;
+		}
+	}
+	dev_us = timer_get_us() - start;
+	ut_asserteq(-ENODEV, uclass_find_device_by_seq(UCLASS_TEST_FDT, 1000,
+						       &found));
+
+	/* Unbinding a device must drop it from the cache */
+	ut_assertok(uclass_find_device_by_seq(UCLASS_TEST_FDT, 0, &dev));
+	ut_assertok(device_unbind(dev));
+	ut_asserteq(-ENODEV, uclass_find_device_by_seq(UCLASS_TEST_FDT, 0,
+						       &found));
+
+	printf("%d uclass lookups: %lu us, %d device lookups: %lu us\n",
+	       100 * UCLASS_COUNT, uc_us, count * 2, dev_us);
+
+	return 0;
+}
+DM_TEST(dm_test_uclass_lookup, UT_TESTF_SCAN_FDT);
+
+#if CONFIG_IS_ENABLED(DM_DEVICE_STATS)
+/* How long the stats test device takes to probe and remove, in ms */
+#define STATS_TEST_PROBE_MS	10
+#define STATS_TEST_REMOVE_MS	3
+
+/* Move the sandbox timer on, rather than actually waiting */
+static int dm_stats_test_probe(struct udevice *dev)
+{
+	timer_test_add_offset(STATS_TEST_PROBE_MS);
+
+	return 0;
+}
+
+static int dm_stats_test_remove(struct udevice *dev)
+{
+	timer_test_add_offset(STATS_TEST_REMOVE_MS);
+
+	return 0;
+}
+
+U_BOOT_DRIVER(dm_stats_test) = {
+	.name	= "dm_stats_test",
+	.id	= UCLASS_NOP,
+	.probe	= dm_stats_test_probe,
+	.remove	= dm_stats_test_remove,
+	.priv_auto	= 24,
+};
+
+/* Test recording the cost of each device */
+static int dm_test_device_stats(struct unit_test_state *uts)
+{
+	struct dm_dev_stats stats;
+	struct udevice *dev;
+	ulong probe_us;
+	int size;
+
+	/* Make sure the timer is up, so that times are recorded */
+	timer_get_us();
+
+	ut_assertok(device_bind(dm_root(), DM_DRIVER_GET(dm_stats_test),
+				"stats-test", NULL, ofnode_null(), &dev));
+	ut_asserteq(0, dev_get_probe_time(dev));
+	ut_assertok(device_probe(dev));
+	dev_get_stats(dev, &stats);
+	probe_us = dev_get_probe_time(dev);
+	ut_assert(probe_us >= STATS_TEST_PROBE_MS * 1000);
+	ut_asserteq(probe_us, stats.probe_us);
+	size = dev_get_attach_size(dev, DM_TAG_PRIV);
+	ut_asserteq(24, size);
+	ut_asserteq(size, stats.attach_size[DM_TAG_PRIV]);
+	ut_assert(stats.attach_total >= size);
+	ut_asserteq(0, stats.remove_us);
+	ut_asserteq(0, stats.devres_size);
+
+	if (CONFIG_IS_ENABLED(DEVRES)) {
+		ut_assertnonnull(devm_kmalloc(dev, 100, 0));
+		dev_get_stats(dev, &stats);
+		ut_asserteq(1, stats.devres_count);
+		ut_asserteq(100, stats.devres_size);
+	}
+
+	/*
+	 * Private data and probe-time allocations go with the device, but the
+	 * probe time is kept
+	 */
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	dev_get_stats(dev, &stats);
+	ut_asserteq(probe_us, stats.probe_us);
+	ut_assert(stats.remove_us >= STATS_TEST_REMOVE_MS * 1000);
+	ut_asserteq(dev_get_remove_time(dev), stats.remove_us);
+	ut_asserteq(0, stats.attach_size[DM_TAG_PRIV]);
+	ut_asserteq(0, stats.devres_size);
+
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_device_stats, UT_TESTF_SCAN_FDT);
+
+/* Test the probe and remove times, and the 'dm stats' command */
+static int dm_test_device_stats_cmd(struct unit_test_state *uts)
+{
+	struct dm_dev_stats stats;
+	struct udevice *dev;
+
+	/* Make sure the timer is up, so that times are recorded */
+	timer_get_us();
+
+	ut_assertok(device_bind(dm_root(), DM_DRIVER_GET(dm_stats_test),
+				"stats-test", NULL, ofnode_null(), &dev));
+	ut_assertok(device_probe(dev));
+	dev_get_stats(dev, &stats);
+	ut_assert(stats.probe_us >= STATS_TEST_PROBE_MS * 1000);
+	ut_asserteq(0, stats.remove_us);
+	ut_asserteq(24, stats.attach_size[DM_TAG_PRIV]);
+
+	console_record_reset_enable();
+	ut_assertok(run_command("dm stats", 0));
+	ut_assert_nextline(" %-20s  %-20s  %9s  %9s  %6s  %6s  %6s  %6s",
+			   "Device", "Driver", "Probe us", "Remove us", "Priv",
+			   "Plat", "UcPriv", "Devres");
+	ut_assert_nextlinen("-----");
+	ut_assert_skip_to_line(" %-20.20s  %-20.20s  %9u  %9u  %6d  %6d  %6d  %6d",
+			       "stats-test", "dm_stats_test", stats.probe_us,
+			       0, 24, 0, 0, 0);
+
+	/* The probe and removal times are kept, and the device is still shown */
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	dev_get_stats(dev, &stats);
+	ut_assert(stats.probe_us >= STATS_TEST_PROBE_MS * 1000);
+	ut_assert(stats.remove_us >= STATS_TEST_REMOVE_MS * 1000);
+
+	console_record_reset_enable();
+	ut_assertok(run_command("dm stats -s", 0));
+	ut_assert_skip_to_line(" %-20.20s  %-20.20s  %9u  %9u  %6d  %6d  %6d  %6d",
+			       "stats-test", "dm_stats_test", stats.probe_us,
+			       stats.remove_us, 0, 0, 0, 0);
+
+	ut_assertok(device_unbind(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_device_stats_cmd, UT_TESTF_SCAN_FDT | UT_TESTF_CONSOLE_REC);
+#endif
+
+#if CONFIG_IS_ENABLED(DM_DEVICE_STATS_FDT)
+/* Test passing the device stats to the OS */
+static int dm_test_device_stats_fdt(struct unit_test_state *uts)
+{
+	struct event_ft_fixup fixup;
+	char fdt_buf[0x4000];
+	struct udevice *dev;
+	ofnode node;
+	u32 val;
+
+	ut_assertok(uclass_first_device_err(UCLASS_TEST_FDT, &dev));
+
+	ut_assertok(fdt_create_empty_tree(fdt_buf, sizeof(fdt_buf)));
+	fixup.tree = oftree_from_fdt(fdt_buf);
+	fixup.images = NULL;
+	ut_assertok(event_notify(EVT_FT_FIXUP, &fixup, sizeof(fixup)));
+
+	/* The root device is always first */
+	node = oftree_path(fixup.tree, "/dm-stats/0");
+	ut_assert(ofnode_valid(node));
+	ut_asserteq_str("root_driver", ofnode_read_string(node, "name"));
+	ut_asserteq_str("root_driver", ofnode_read_string(node, "driver"));
+	ut_assertok(ofnode_read_u32(node, "probe-us", &val));
+	ut_assertok(ofnode_read_u32(node, "alloc-bytes", &val));
+
+	/* A device which was probed must be in there somewhere */
+	ofnode_for_each_subnode(node, oftree_path(fixup.tree, "/dm-stats")) {
+		if (!strcmp(dev->name, ofnode_read_string(node, "name")))
+			break;
+	}
+	ut_assert(ofnode_valid(node));
+	ut_asserteq_str(dev->driver->name, ofnode_read_string(node, "driver"));
+	ut_assertok(ofnode_read_u32(node, "alloc-bytes", &val));
+	ut_assert(val >= dev_get_attach_size(dev, DM_TAG_PRIV));
+
+	return 0;
+}
+DM_TEST(dm_test_device_stats_fdt, UT_TESTF_SCAN_FDT | UT_TESTF_FLAT_TREE);
+#endif
@@ -11,6 +11,7 @@
 #include <malloc.h>
 #include <dm/test.h>
 #include <dma.h>
+#include <asm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
 
@@ -37,6 +38,49 @@ static int dm_test_dma_m2m(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_dma_m2m, UT_TESTF_SCAN_FDT);
 
+static int dm_test_dma_memcpy_large(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+	size_t len;
+	u8 *src, *dst;
+	uint count;
+	int i;
+
+	if (!IS_ENABLED(CONFIG_DMA_MEMCPY_OFFLOAD))
+		return -EAGAIN;
+
+	ut_assertok(uclass_get_device_by_name(UCLASS_DMA, "dma", &dev));
+	count = sandbox_dma_get_transfers(dev);
+
+	/* Use an unaligned destination so that the CPU copies the ends */
+	len = CONFIG_DMA_MEMCPY_THRESHOLD + 3;
+	src = malloc(len);
+	dst = calloc(1, len + 2);
+	ut_assertnonnull(src);
+	ut_assertnonnull(dst);
+	for (i = 0; i < len; i++)
+		src[i] = i * 7;
+
+	ut_assertok(dma_memcpy_large(dst + 1, src, len));
+	ut_asserteq_mem(src, dst + 1, len);
+	ut_asserteq(0, dst[0]);
+	ut_asserteq(0, dst[len + 1]);
+	ut_asserteq(count + 1, sandbox_dma_get_transfers(dev));
+
+	/* Small and overlapping copies are left to the caller */
+	memset(dst, '\0', len + 2);
+	ut_asserteq(-EINVAL, dma_memcpy_large(dst, src, 100));
+	ut_asserteq(0, dst[0]);
+	ut_asserteq(-EINVAL, dma_memcpy_large(src + 1, src, len - 1));
+	ut_asserteq(count + 1, sandbox_dma_get_transfers(dev));
+
+	free(dst);
+	free(src);
+
+	return 0;
+}
+DM_TEST(dm_test_dma_memcpy_large, UT_TESTF_SCAN_FDT);
+
 static int dm_test_dma(struct unit_test_state *uts)
 {
 	struct udevice *dev;
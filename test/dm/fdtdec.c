@@ -5,8 +5,11 @@
 
 #include <common.h>
 #include <dm.h>
+#include <fdtdec.h>
+#include <time.h>
 #include <asm/global_data.h>
 #include <dm/of_extra.h>
+#include <dm/ofnode.h>
 #include <dm/test.h>
 #include <test/ut.h>
 
@@ -130,3 +133,105 @@ static int dm_test_fdtdec_add_reserved_memory(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_fdtdec_add_reserved_memory,
 	UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT | UT_TESTF_FLAT_TREE);
+
+#if CONFIG_IS_ENABLED(OF_FLAT_INDEX)
+/* Look up every phandle in the control FDT, returning the number found */
+static int lookup_all_phandles(struct unit_test_state *uts, bool indexed)
+{
+	const void *blob = gd->fdt_blob;
+	int offset, found, count = 0;
+	uint phandle;
+
+	for (offset = fdt_next_node(blob, -1, NULL); offset >= 0;
+	     offset = fdt_next_node(blob, offset, NULL)) {
+		phandle = fdt_get_phandle(blob, offset);
+		if (!phandle)
+			continue;
+		if (indexed)
+			found = fdtdec_phandle_offset(blob, phandle);
+		else
+			found = fdt_node_offset_by_phandle(blob, phandle);
+		ut_asserteq(offset, found);
+		count++;
+	}
+
+	return count;
+}
+
+static int dm_test_fdtdec_index(struct unit_test_state *uts)
+{
+	static const char *const paths[] = {
+		"/a-test", "/pinmux-gpios", "/leds/default_on", "/i2c@0",
+	};
+	const void *blob = gd->fdt_blob;
+	ulong start, scan_us, index_us;
+	ofnode node, subnode;
+	int i, count, offset;
+	uint phandle;
+
+	start = timer_get_us();
+	count = lookup_all_phandles(uts, false);
+	scan_us = timer_get_us() - start;
+	ut_assert(count > 10);
+
+	/* The first indexed lookup builds the index, so do it twice */
+	ut_asserteq(count, lookup_all_phandles(uts, true));
+	start = timer_get_us();
+	ut_asserteq(count, lookup_all_phandles(uts, true));
+	index_us = timer_get_us() - start;
+	printf("%d phandles: scan %luus, indexed %luus\n", count, scan_us,
+	       index_us);
+
+	ut_asserteq(-FDT_ERR_NOTFOUND, fdtdec_phandle_offset(blob, 0x7fffffff));
+	ut_asserteq(-FDT_ERR_BADPHANDLE, fdtdec_phandle_offset(blob, 0));
+
+	/* Paths are remembered once used */
+	for (i = 0; i < ARRAY_SIZE(paths); i++) {
+		offset = fdt_path_offset(blob, paths[i]);
+		ut_assert(offset > 0);
+		ut_asserteq(offset, fdtdec_path_offset(blob, paths[i]));
+		ut_asserteq(offset, fdtdec_path_offset(blob, paths[i]));
+	}
+	ut_asserteq(-FDT_ERR_NOTFOUND, fdtdec_path_offset(blob, "/no-such"));
+
+	/* Adding a node moves everything after it */
+	node = ofnode_path("/");
+	ut_assertok(ofnode_add_subnode(node, "an-extra-node", &subnode));
+	ut_asserteq(count, lookup_all_phandles(uts, true));
+	for (i = 0; i < ARRAY_SIZE(paths); i++) {
+		ut_asserteq(fdt_path_offset(blob, paths[i]),
+			    fdtdec_path_offset(blob, paths[i]));
+	}
+
+	ut_assertok(ofnode_delete(&subnode));
+
+	/*
+	 * Changing the tree behind our back is detected too. A new subnode
+	 * goes before the existing ones, so every offset moves.
+	 */
+	offset = fdt_add_subnode((void *)blob, 0, "behind-our-back");
+	ut_assert(offset > 0);
+	ut_assert(offset < fdt_path_offset(blob, paths[0]));
+	ut_assertok(fdt_generate_phandle(blob, &phandle));
+	ut_assertok(fdt_setprop_u32((void *)blob, offset, "phandle", phandle));
+	ut_asserteq(offset, fdtdec_phandle_offset(blob, phandle));
+	ut_asserteq(count + 1, lookup_all_phandles(uts, true));
+	for (i = 0; i < ARRAY_SIZE(paths); i++) {
+		ut_asserteq(fdt_path_offset(blob, paths[i]),
+			    fdtdec_path_offset(blob, paths[i]));
+	}
+	ut_asserteq(offset, fdtdec_path_offset(blob, "/behind-our-back"));
+
+	/* A new phandle which leaves the tree the same size is still found */
+	ut_assertok(fdt_setprop_inplace_u32((void *)blob, offset, "phandle",
+					    phandle + 1));
+	ut_asserteq(-FDT_ERR_NOTFOUND, fdtdec_phandle_offset(blob, phandle));
+	ut_asserteq(offset, fdtdec_phandle_offset(blob, phandle + 1));
+	ut_asserteq(offset, fdtdec_path_offset(blob, "/behind-our-back"));
+	ut_assertok(fdt_del_node((void *)blob, offset));
+	ut_asserteq(-FDT_ERR_NOTFOUND, fdtdec_phandle_offset(blob, phandle + 1));
+
+	return 0;
+}
+DM_TEST(dm_test_fdtdec_index, UT_TESTF_SCAN_FDT | UT_TESTF_FLAT_TREE);
+#endif
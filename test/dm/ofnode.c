@@ -1347,6 +1347,89 @@ static int dm_test_livetree_align(struct unit_test_state *uts)
 }
 DM_TEST(dm_test_livetree_align, UT_TESTF_SCAN_FDT | UT_TESTF_LIVE_TREE);
 
+#if CONFIG_IS_ENABLED(OF_LIVE_LAZY)
+/* Check that two live trees have the same nodes and properties */
+static int check_same_tree(struct unit_test_state *uts,
+			   const struct device_node *a,
+			   const struct device_node *b)
+{
+	const struct device_node *ca, *cb;
+	const struct property *pa, *pb;
+
+	ut_asserteq_str(a->name, b->name);
+	ut_asserteq_str(a->full_name, b->full_name);
+	ut_asserteq_str(a->type, b->type);
+	ut_asserteq(a->phandle, b->phandle);
+
+	for (pa = of_node_props(a), pb = of_node_props(b); pa && pb;
+	     pa = pa->next, pb = pb->next) {
+		ut_asserteq_str(pa->name, pb->name);
+		ut_asserteq(pa->length, pb->length);
+		ut_asserteq_mem(pa->value, pb->value, pa->length);
+	}
+	ut_assert(!pa && !pb);
+
+	for (ca = of_node_child(a), cb = of_node_child(b); ca && cb;
+	     ca = ca->sibling, cb = cb->sibling)
+		ut_assertok(check_same_tree(uts, ca, cb));
+	ut_assert(!ca && !cb);
+
+	return 0;
+}
+
+/* check building a livetree as it is used */
+static int dm_test_livetree_lazy(struct unit_test_state *uts)
+{
+	struct device_node *eager, *lazy, *np, *gpio;
+	long eager_size, lazy_size;
+	ulong before;
+
+	before = ut_check_free();
+	ut_assertok(unflatten_device_tree(gd->fdt_blob, &eager));
+	eager_size = ut_check_delta(before);
+
+	/* At first there is only the root node */
+	ut_assertok(unflatten_device_tree_lazy(gd->fdt_blob, &lazy));
+	ut_assert(of_live_lazy_size(lazy) < 256);
+	ut_asserteq(0, of_live_lazy_size(eager));
+
+	/* Looking up a node only creates the nodes on the way to it */
+	np = of_find_node_opts_by_path(lazy, "/a-test", NULL);
+	ut_assertnonnull(np);
+	ut_assert(np->lazy & OF_LAZY_CHILDREN);
+	ut_assert(np->lazy & OF_LAZY_PROPS);
+	ut_assertnonnull(of_find_property(np, "bool-value", NULL));
+	ut_assert(!(np->lazy & OF_LAZY_PROPS));
+
+	/* So does following a phandle */
+	gpio = of_find_node_opts_by_path(eager, "/pinmux-gpios", NULL);
+	ut_assertnonnull(gpio);
+	ut_assert(gpio->phandle);
+	np = of_find_node_by_phandle(lazy, gpio->phandle);
+	ut_assertnonnull(np);
+	ut_asserteq_str(gpio->full_name, np->full_name);
+	ut_assert(np->lazy & OF_LAZY_PROPS);
+	ut_asserteq_ptr(np, of_find_node_by_phandle(lazy, gpio->phandle));
+	ut_assertnull(of_find_node_by_phandle(lazy, 0x7fffffff));
+
+	lazy_size = of_live_lazy_size(lazy);
+	ut_assert(lazy_size < eager_size / 2);
+	printf("Live tree: full %ld bytes, lazy %ld bytes after two lookups",
+	       eager_size, lazy_size);
+
+	/* Once everything has been looked at, the trees must match */
+	ut_assertok(check_same_tree(uts, eager, lazy));
+	printf(", %ld bytes when complete\n", of_live_lazy_size(lazy));
+
+	of_live_free(lazy);
+	of_live_free(eager);
+	ut_assertok(ut_check_delta(before));
+
+	return 0;
+}
+DM_TEST(dm_test_livetree_lazy, UT_TESTF_SCAN_FDT);
+#endif
+
 /* check that it is possible to load an arbitrary livetree */
 static int dm_test_livetree_ensure(struct unit_test_state *uts)
 {
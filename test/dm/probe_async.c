@@ -0,0 +1,321 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for probing devices in the background
+ */
+
+#include <common.h>
+#include <command.h>
+#include <dm.h>
+#include <dm/device-internal.h>
+#include <dm/probe-async.h>
+#include <dm/root.h>
+#include <dm/test.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/*
+ * Number of times each test device must be polled before it is ready. The
+ * devices count polls rather than time, so the test does not depend on how
+ * fast the machine is.
+ */
+#define ASYNC_TEST_POLLS	5
+
+#define ASYNC_TEST_COUNT	3
+
+/* Counts probes, polls and completions, to show the order things happen */
+static int async_test_events;
+
+/**
+ * struct async_test_priv - Private data for the test devices
+ *
+ * @polls: Number of times the device has been polled
+ * @started: Value of async_test_events when probe() was called
+ * @ready: Value of async_test_events when the device became ready
+ * @remove_ret: Value returned by device_remove() from the poll function
+ */
+struct async_test_priv {
+	int polls;
+	int started;
+	int ready;
+	int remove_ret;
+};
+
+/* Number of times async_fail_drv was removed */
+static int async_fail_removes;
+
+static int async_test_poll(struct udevice *dev)
+{
+	struct async_test_priv *priv = dev_get_priv(dev);
+
+	async_test_events++;
+	if (++priv->polls < ASYNC_TEST_POLLS)
+		return -EAGAIN;
+	priv->ready = async_test_events;
+
+	return 0;
+}
+
+static int async_test_probe(struct udevice *dev)
+{
+	struct async_test_priv *priv = dev_get_priv(dev);
+
+	/* Pretend to start some hardware which takes a while */
+	priv->polls = 0;
+	priv->started = ++async_test_events;
+
+	return dev_probe_async(dev, async_test_poll, 1000000);
+}
+
+U_BOOT_DRIVER(async_test_drv) = {
+	.name	= "async_test_drv",
+	.id	= UCLASS_NOP,
+	.probe	= async_test_probe,
+	.priv_auto	= sizeof(struct async_test_priv),
+};
+
+/* This device fails after its probe() method has succeeded */
+static int async_fail_poll(struct udevice *dev)
+{
+	struct async_test_priv *priv = dev_get_priv(dev);
+
+	if (++priv->polls < ASYNC_TEST_POLLS)
+		return -EAGAIN;
+
+	return -EIO;
+}
+
+static int async_fail_probe(struct udevice *dev)
+{
+	return dev_probe_async(dev, async_fail_poll, 1000000);
+}
+
+static int async_fail_remove(struct udevice *dev)
+{
+	async_fail_removes++;
+
+	return 0;
+}
+
+U_BOOT_DRIVER(async_fail_drv) = {
+	.name	= "async_fail_drv",
+	.id	= UCLASS_NOP,
+	.probe	= async_fail_probe,
+	.remove	= async_fail_remove,
+	.priv_auto	= sizeof(struct async_test_priv),
+};
+
+/* This device tries to remove itself while it is being polled */
+static int async_self_poll(struct udevice *dev)
+{
+	struct async_test_priv *priv = dev_get_priv(dev);
+
+	if (!priv->polls)
+		priv->remove_ret = device_remove(dev, DM_REMOVE_NORMAL);
+
+	return async_test_poll(dev);
+}
+
+static int async_self_probe(struct udevice *dev)
+{
+	return dev_probe_async(dev, async_self_poll, 1000000);
+}
+
+U_BOOT_DRIVER(async_self_drv) = {
+	.name	= "async_self_drv",
+	.id	= UCLASS_NOP,
+	.probe	= async_self_probe,
+	.priv_auto	= sizeof(struct async_test_priv),
+};
+
+/* The platform data of this device is the device it needs */
+static int async_user_probe(struct udevice *dev)
+{
+	return device_probe(dev_get_plat(dev));
+}
+
+U_BOOT_DRIVER(async_user_drv) = {
+	.name	= "async_user_drv",
+	.id	= UCLASS_NOP,
+	.probe	= async_user_probe,
+};
+
+static const char *const async_test_names[ASYNC_TEST_COUNT] = {
+	"async0", "async1", "async2",
+};
+
+static int bind_async_devices(struct unit_test_state *uts,
+			      struct udevice *devs[])
+{
+	int i;
+
+	for (i = 0; i < ASYNC_TEST_COUNT; i++) {
+		ut_assertok(device_bind(dm_root(),
+					DM_DRIVER_GET(async_test_drv),
+					async_test_names[i], NULL,
+					ofnode_null(), &devs[i]));
+	}
+
+	return 0;
+}
+
+/* Test that slow devices probed in the background overlap */
+static int dm_test_probe_async(struct unit_test_state *uts)
+{
+	struct async_test_priv *priv[ASYNC_TEST_COUNT];
+	struct udevice *devs[ASYNC_TEST_COUNT];
+	int polls[ASYNC_TEST_COUNT];
+	int i;
+
+	ut_assertok(bind_async_devices(uts, devs));
+
+	/* Probing normally waits for each device in turn */
+	for (i = 0; i < ASYNC_TEST_COUNT; i++) {
+		ut_assertok(device_probe(devs[i]));
+		ut_assert(device_active(devs[i]));
+		ut_assert(!(dev_get_flags(devs[i]) & DM_FLAG_PROBE_PENDING));
+		priv[i] = dev_get_priv(devs[i]);
+		ut_asserteq(ASYNC_TEST_POLLS, priv[i]->polls);
+		if (i)
+			ut_assert(priv[i - 1]->ready < priv[i]->started);
+	}
+	ut_asserteq(0, dm_probe_pending());
+
+	for (i = 0; i < ASYNC_TEST_COUNT; i++)
+		ut_assertok(device_remove(devs[i], DM_REMOVE_NORMAL));
+
+	/* Now start them all and wait for them together */
+	for (i = 0; i < ASYNC_TEST_COUNT; i++) {
+		ut_assertok(device_probe_async(devs[i]));
+		ut_assert(dev_get_flags(devs[i]) & DM_FLAG_PROBE_PENDING);
+		ut_asserteq(0, dev_get_probe_time(devs[i]));
+		priv[i] = dev_get_priv(devs[i]);
+	}
+	ut_asserteq(ASYNC_TEST_COUNT, dm_probe_pending());
+
+	/* Each poll moves every pending device along */
+	for (i = 0; i < ASYNC_TEST_COUNT; i++)
+		polls[i] = priv[i]->polls;
+	dm_probe_poll();
+	for (i = 0; i < ASYNC_TEST_COUNT; i++)
+		ut_assert(priv[i]->polls > polls[i] ||
+			  priv[i]->polls == ASYNC_TEST_POLLS);
+
+	/* Polling notes that they are ready but does not finish the probe */
+	for (i = 0; i < ASYNC_TEST_POLLS; i++)
+		dm_probe_poll();
+	for (i = 0; i < ASYNC_TEST_COUNT; i++) {
+		ut_asserteq(ASYNC_TEST_POLLS, priv[i]->polls);
+		ut_assert(dev_get_flags(devs[i]) & DM_FLAG_PROBE_PENDING);
+	}
+	ut_asserteq(ASYNC_TEST_COUNT, dm_probe_pending());
+
+	/* Probing a device finishes just that one */
+	ut_assertok(device_probe(devs[0]));
+	ut_assert(!(dev_get_flags(devs[0]) & DM_FLAG_PROBE_PENDING));
+	ut_asserteq(ASYNC_TEST_COUNT - 1, dm_probe_pending());
+
+	ut_assertok(dm_probe_join_all());
+	ut_asserteq(0, dm_probe_pending());
+
+	/* All were started before any of them was ready */
+	for (i = 0; i < ASYNC_TEST_COUNT; i++) {
+		ut_assert(device_active(devs[i]));
+		ut_assert(!(dev_get_flags(devs[i]) & DM_FLAG_PROBE_PENDING));
+		ut_asserteq(ASYNC_TEST_POLLS, priv[i]->polls);
+		ut_assert(priv[ASYNC_TEST_COUNT - 1]->started < priv[i]->ready);
+	}
+
+	return 0;
+}
+DM_TEST(dm_test_probe_async, UT_TESTF_SCAN_FDT);
+
+/* Test that a pending device is joined when it is used */
+static int dm_test_probe_async_join(struct unit_test_state *uts)
+{
+	struct udevice *devs[ASYNC_TEST_COUNT], *user;
+
+	ut_assertok(bind_async_devices(uts, devs));
+	ut_assertok(device_bind(dm_root(), DM_DRIVER_GET(async_user_drv),
+				"async-user", devs[0], ofnode_null(), &user));
+
+	ut_assertok(device_probe_async(devs[0]));
+	ut_asserteq(1, dm_probe_pending());
+
+	/* Probing the user waits for the device it needs */
+	ut_assertok(device_probe(user));
+	ut_assert(!(dev_get_flags(devs[0]) & DM_FLAG_PROBE_PENDING));
+	ut_assert(device_active(devs[0]));
+	ut_asserteq(0, dm_probe_pending());
+
+	/* The dependency is recorded */
+	console_record_reset_enable();
+	ut_assertok(run_command("dm deps", 0));
+	ut_assert_nextlinen(" Device");
+	ut_assert_nextlinen("---");
+	ut_assert_skip_to_line(" async-user            async0                nop");
+	ut_assert_console_end();
+
+	/* Removing a pending device waits for it first */
+	ut_assertok(device_probe_async(devs[1]));
+	ut_asserteq(1, dm_probe_pending());
+	ut_assertok(device_remove(devs[1], DM_REMOVE_NORMAL));
+	ut_assert(!device_active(devs[1]));
+	ut_asserteq(0, dm_probe_pending());
+
+	return 0;
+}
+DM_TEST(dm_test_probe_async_join, UT_TESTF_SCAN_FDT | UT_TESTF_CONSOLE_REC);
+
+/* Test that a device which fails in the background is removed again */
+static int dm_test_probe_async_fail(struct unit_test_state *uts)
+{
+	struct udevice *dev;
+
+	ut_assertok(device_bind(dm_root(), DM_DRIVER_GET(async_fail_drv),
+				"async-fail", NULL, ofnode_null(), &dev));
+	async_fail_removes = 0;
+
+	ut_assertok(device_probe_async(dev));
+	ut_asserteq(1, dm_probe_pending());
+	ut_asserteq(-EIO, dm_probe_join(dev));
+	ut_asserteq(0, dm_probe_pending());
+	ut_asserteq(1, async_fail_removes);
+	ut_assert(!device_active(dev));
+	ut_assert(!(dev_get_flags(dev) & DM_FLAG_PROBE_PENDING));
+
+	/* Probing the device reports the error too */
+	ut_assertok(device_probe_async(dev));
+	ut_asserteq(-EIO, device_probe(dev));
+	ut_asserteq(2, async_fail_removes);
+	ut_assert(!device_active(dev));
+
+	return 0;
+}
+DM_TEST(dm_test_probe_async_fail, UT_TESTF_SCAN_FDT);
+
+/* Test that a device cannot be removed from its own poll function */
+static int dm_test_probe_async_self(struct unit_test_state *uts)
+{
+	struct async_test_priv *priv;
+	struct udevice *dev;
+
+	ut_assertok(device_bind(dm_root(), DM_DRIVER_GET(async_self_drv),
+				"async-self", NULL, ofnode_null(), &dev));
+	ut_assertok(device_probe_async(dev));
+	priv = dev_get_priv(dev);
+
+	dm_probe_poll();
+	ut_asserteq(-EDEADLK, priv->remove_ret);
+	ut_assert(device_active(dev));
+	ut_assert(dev_get_flags(dev) & DM_FLAG_PROBE_PENDING);
+	ut_asserteq(1, dm_probe_pending());
+
+	/* The probe still finishes normally */
+	ut_assertok(dm_probe_join(dev));
+	ut_assert(device_active(dev));
+	ut_asserteq(ASYNC_TEST_POLLS, priv->polls);
+	ut_asserteq(0, dm_probe_pending());
+
+	return 0;
+}
+DM_TEST(dm_test_probe_async_self, UT_TESTF_SCAN_FDT);
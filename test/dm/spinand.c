@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the SPI NAND core, using the sandbox SPI NAND emulator
+ */
+
+#include <common.h>
+#include <dm.h>
+#include <malloc.h>
+#include <spi.h>
+#include <asm/state.h>
+#include <asm/test.h>
+#include <dm/device-internal.h>
+#include <dm/test.h>
+#include <linux/mtd/mtd.h>
+#include <linux/mtd/spinand.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+enum {
+	/* Chip select taken over from the second SPI flash */
+	NAND_CS		= 1,
+	PAGE_LEN	= 2048,
+	BLOCK_PAGES	= 64,
+	/* Column address bit which selects the plane of odd blocks */
+	PLANE_COLUMN	= 0x1000,
+};
+
+#define OP(_opcode, _addr)	{ .opcode = _opcode, .addr = _addr }
+#define OP_STATUS		OP(0x0f, REG_STATUS)
+
+/* Bind the emulator and a SPI NAND device using it, then probe the device */
+static int spinand_setup(struct unit_test_state *uts, struct udevice **emulp,
+			 struct mtd_info **mtdp)
+{
+	struct sandbox_state *state = state_get_current();
+	struct dm_spi_slave_plat *plat;
+	struct udevice *bus, *dev;
+
+	ut_assertok(uclass_first_device_err(UCLASS_SPI, &bus));
+	ut_assertok(spi_find_chip_select(bus, NAND_CS, &dev));
+	ut_assertok(device_remove(dev, DM_REMOVE_NORMAL));
+	ut_assertok(device_unbind(dev));
+
+	ut_assertok(device_bind(bus, DM_DRIVER_GET(sandbox_spinand_emul),
+				"spinand-emul", NULL, ofnode_null(), emulp));
+	state->spi[dev_seq(bus)][NAND_CS].emul = *emulp;
+
+	ut_assertok(device_bind(bus, DM_DRIVER_GET(spinand), "spi-nand", NULL,
+				ofnode_null(), &dev));
+	plat = dev_get_parent_plat(dev);
+	plat->cs = NAND_CS;
+	ut_assertok(device_probe(dev));
+	*mtdp = dev_get_uclass_priv(dev);
+
+	return 0;
+}
+
+/* Check the operations seen by the emulator since the log was cleared */
+static int check_ops(struct unit_test_state *uts, struct udevice *emul,
+		     const struct sandbox_spinand_op *expect, int count)
+{
+	const struct sandbox_spinand_op *ops;
+	int i;
+
+	ut_asserteq(count, sandbox_spinand_get_ops(emul, &ops));
+	for (i = 0; i < count; i++) {
+		ut_asserteq(expect[i].opcode, ops[i].opcode);
+		ut_asserteq(expect[i].addr, ops[i].addr);
+	}
+	sandbox_spinand_clear_ops(emul);
+
+	return 0;
+}
+
+/* Check that each page read holds its own page number */
+static int check_pages(struct unit_test_state *uts, const u8 *buf,
+		       int first_page, int count)
+{
+	int i, j;
+
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < PAGE_LEN; j++)
+			ut_asserteq((u8)(first_page + i), buf[i * PAGE_LEN + j]);
+	}
+
+	return 0;
+}
+
+/* Check that sequential page reads are pipelined with cache reads */
+static int dm_test_spinand_read_seq(struct unit_test_state *uts)
+{
+	static const struct sandbox_spinand_op single[] = {
+		OP(0x13, 0), OP_STATUS, OP_STATUS,
+		OP(0x0b, 0),
+	};
+	static const struct sandbox_spinand_op seq[] = {
+		OP(0x13, BLOCK_PAGES), OP_STATUS, OP_STATUS,
+		OP(0x31, 0), OP_STATUS, OP_STATUS,
+		OP(0x0b, PLANE_COLUMN),
+		OP(0x31, 0), OP_STATUS, OP_STATUS,
+		OP(0x0b, PLANE_COLUMN),
+		OP(0x3f, 0), OP_STATUS, OP_STATUS,
+		OP(0x0b, PLANE_COLUMN),
+	};
+	static const struct sandbox_spinand_op cross[] = {
+		OP(0x13, 2 * BLOCK_PAGES - 1), OP_STATUS, OP_STATUS,
+		OP(0x0b, PLANE_COLUMN),
+		OP(0x13, 2 * BLOCK_PAGES), OP_STATUS, OP_STATUS,
+		OP(0x0b, 0),
+	};
+	struct udevice *emul;
+	struct mtd_info *mtd;
+	uint corrected;
+	size_t retlen;
+	u8 *buf;
+
+	ut_assertok(spinand_setup(uts, &emul, &mtd));
+	buf = malloc(3 * PAGE_LEN);
+	ut_assertnonnull(buf);
+
+	/* A single page is read with PAGE READ and no cache read sequence */
+	sandbox_spinand_clear_ops(emul);
+	ut_assertok(mtd_read(mtd, 0, PAGE_LEN, &retlen, buf));
+	ut_asserteq(PAGE_LEN, retlen);
+	ut_assertok(check_pages(uts, buf, 0, 1));
+	ut_assertok(check_ops(uts, emul, single, ARRAY_SIZE(single)));
+
+	/*
+	 * Three pages of a block: the sequence is started with PAGE READ,
+	 * continued with PAGE READ CACHE SEQUENTIAL and ended with PAGE READ
+	 * CACHE LAST, polling the status after each. The bitflips in the last
+	 * page are reported from the status read after it reached the cache.
+	 */
+	sandbox_spinand_set_flip_page(emul, BLOCK_PAGES + 2);
+	corrected = mtd->ecc_stats.corrected;
+	ut_assertok(mtd_read(mtd, BLOCK_PAGES * PAGE_LEN, 3 * PAGE_LEN, &retlen,
+			     buf));
+	ut_asserteq(3 * PAGE_LEN, retlen);
+	ut_assertok(check_pages(uts, buf, BLOCK_PAGES, 3));
+	ut_assertok(check_ops(uts, emul, seq, ARRAY_SIZE(seq)));
+	ut_asserteq(corrected + 3, mtd->ecc_stats.corrected);
+
+	/* A cache read sequence does not cross into the next block */
+	sandbox_spinand_set_flip_page(emul, -1);
+	ut_assertok(mtd_read(mtd, (2 * BLOCK_PAGES - 1) * PAGE_LEN,
+			     2 * PAGE_LEN, &retlen, buf));
+	ut_assertok(check_pages(uts, buf, 2 * BLOCK_PAGES - 1, 2));
+	ut_assertok(check_ops(uts, emul, cross, ARRAY_SIZE(cross)));
+
+	free(buf);
+
+	return 0;
+}
+DM_TEST(dm_test_spinand_read_seq, UT_TESTF_SCAN_FDT);
@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for attaching UBI to a simulated NAND device
+ */
+
+#include <common.h>
+#include <command.h>
+#include <dm.h>
+#include <malloc.h>
+#include <ubi_uboot.h>
+#include <dm/test.h>
+#include <linux/mtd/mtd.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+enum {
+	NANDSIM_PAGE_SIZE	= 512,
+	NANDSIM_BLOCK_SIZE	= 16 << 10,
+	NANDSIM_BLOCKS		= 64,
+	NANDSIM_SIZE		= NANDSIM_BLOCK_SIZE * NANDSIM_BLOCKS,
+	NANDSIM_MAX_READS	= 8,
+};
+
+/**
+ * struct nandsim_read - An MTD read seen by the simulated NAND
+ *
+ * @from: Offset within the block
+ * @len: Number of bytes read
+ * @bitflips: Value returned to the MTD layer
+ */
+struct nandsim_read {
+	loff_t from;
+	size_t len;
+	int bitflips;
+};
+
+/**
+ * struct nandsim - A RAM-backed NAND device with bitflip injection
+ *
+ * @mtd: MTD device
+ * @data: Contents of the device
+ * @flip_page: Offset of a page which reports a corrected bitflip when read,
+ *	or -1 for none
+ * @log_block: Block whose reads are recorded
+ * @reads: Reads of @log_block
+ * @read_count: Number of reads of @log_block
+ */
+struct nandsim {
+	struct mtd_info mtd;
+	u8 *data;
+	loff_t flip_page;
+	int log_block;
+	struct nandsim_read reads[NANDSIM_MAX_READS];
+	int read_count;
+};
+
+static int nandsim_read(struct mtd_info *mtd, loff_t from, size_t len,
+			size_t *retlen, u_char *buf)
+{
+	struct nandsim *ns = mtd->priv;
+	struct nandsim_read *rd;
+	int bitflips = 0;
+
+	if (ns->flip_page >= 0 && from < ns->flip_page + NANDSIM_PAGE_SIZE &&
+	    from + len > ns->flip_page)
+		bitflips = 1;
+	if (from / NANDSIM_BLOCK_SIZE == ns->log_block &&
+	    ns->read_count < NANDSIM_MAX_READS) {
+		rd = &ns->reads[ns->read_count++];
+		rd->from = from % NANDSIM_BLOCK_SIZE;
+		rd->len = len;
+		rd->bitflips = bitflips;
+	}
+	memcpy(buf, ns->data + from, len);
+	*retlen = len;
+
+	return bitflips;
+}
+
+static int nandsim_write(struct mtd_info *mtd, loff_t to, size_t len,
+			 size_t *retlen, const u_char *buf)
+{
+	struct nandsim *ns = mtd->priv;
+	size_t i;
+
+	/* Programming can only clear bits */
+	for (i = 0; i < len; i++)
+		ns->data[to + i] &= buf[i];
+	*retlen = len;
+
+	return 0;
+}
+
+static int nandsim_erase(struct mtd_info *mtd, struct erase_info *instr)
+{
+	struct nandsim *ns = mtd->priv;
+
+	memset(ns->data + instr->addr, '\xff', instr->len);
+	instr->state = MTD_ERASE_DONE;
+
+	return 0;
+}
+
+static int nandsim_init(struct nandsim *ns)
+{
+	struct mtd_info *mtd = &ns->mtd;
+
+	memset(ns, '\0', sizeof(*ns));
+	ns->data = malloc(NANDSIM_SIZE);
+	if (!ns->data)
+		return -ENOMEM;
+	memset(ns->data, '\xff', NANDSIM_SIZE);
+	ns->flip_page = -1;
+	ns->log_block = -1;
+
+	mtd->name = "nandsim";
+	mtd->type = MTD_NANDFLASH;
+	mtd->flags = MTD_CAP_NANDFLASH;
+	mtd->size = NANDSIM_SIZE;
+	mtd->erasesize = NANDSIM_BLOCK_SIZE;
+	mtd->writesize = NANDSIM_PAGE_SIZE;
+	mtd->writebufsize = NANDSIM_PAGE_SIZE;
+	mtd->oobsize = 16;
+	mtd->ecc_strength = 4;
+	mtd->bitflip_threshold = 1;
+	mtd->_read = nandsim_read;
+	mtd->_write = nandsim_write;
+	mtd->_erase = nandsim_erase;
+	mtd->priv = ns;
+	mtd->flash_node = ofnode_null();
+
+	return add_mtd_device(mtd);
+}
+
+static void nandsim_remove(struct nandsim *ns)
+{
+	del_mtd_device(&ns->mtd);
+	free(ns->data);
+}
+
+/*
+ * Check that the EC and VID headers are read with one MTD read while scanning,
+ * and that bitflips in that read are put down to the right header
+ */
+static int dm_test_ubi_attach_hdrs(struct unit_test_state *uts)
+{
+	const int block = NANDSIM_BLOCKS - 1;
+	struct nandsim ns;
+	int i;
+
+	ut_assertok(nandsim_init(&ns));
+
+	/* Format the empty device, writing an EC header to each block */
+	ut_assertok(ubi_part("nandsim", NULL));
+	ut_assertok(run_command("ubi detach", 0));
+
+	/*
+	 * Both headers are served from a single read of their two pages. Any
+	 * later reads are of the data area.
+	 */
+	ns.log_block = block;
+	ut_assertok(ubi_part("nandsim", NULL));
+	ut_assertok(run_command("ubi detach", 0));
+	ut_assert(ns.read_count >= 1);
+	ut_asserteq(0, ns.reads[0].from);
+	ut_asserteq(2 * NANDSIM_PAGE_SIZE, ns.reads[0].len);
+	for (i = 1; i < ns.read_count; i++)
+		ut_assert(ns.reads[i].from >= 2 * NANDSIM_PAGE_SIZE);
+
+	/*
+	 * A bitflip in the VID header's page makes the headers be read
+	 * separately, so it is not charged to the EC header
+	 */
+	ns.flip_page = (loff_t)block * NANDSIM_BLOCK_SIZE + NANDSIM_PAGE_SIZE;
+	ns.read_count = 0;
+	ut_assertok(ubi_part("nandsim", NULL));
+	ut_assertok(run_command("ubi detach", 0));
+	ut_assert(ns.read_count >= 3);
+	ut_asserteq(0, ns.reads[0].from);
+	ut_asserteq(2 * NANDSIM_PAGE_SIZE, ns.reads[0].len);
+	ut_asserteq(1, ns.reads[0].bitflips);
+	ut_asserteq(0, ns.reads[1].from);
+	ut_asserteq(0, ns.reads[1].bitflips);
+	ut_asserteq(NANDSIM_PAGE_SIZE, ns.reads[2].from);
+	ut_asserteq(1, ns.reads[2].bitflips);
+
+	nandsim_remove(&ns);
+
+	return 0;
+}
+DM_TEST(dm_test_ubi_attach_hdrs, UT_TESTF_CONSOLE_REC);
@@ -371,6 +371,154 @@ SPL_IMG_TEST(spl_test_image, IMX8, 0);
 SPL_IMG_TEST(spl_test_image, FIT_INTERNAL, 0);
 SPL_IMG_TEST(spl_test_image, FIT_EXTERNAL, 0);
 
+static int spl_test_read_count;
+
+static ulong spl_test_read_counted(struct spl_load_info *load, ulong sector,
+				   ulong count, void *buf)
+{
+	spl_test_read_count++;
+	return spl_test_read(load, sector, count, buf);
+}
+
+/**
+ * struct spl_test_fit_image - An image in a FIT with several images
+ *
+ * @name: Name of the image node
+ * @offset: Offset of the data after the FIT
+ * @load_addr: Address to load the image to
+ */
+struct spl_test_fit_image {
+	const char *name;
+	size_t offset;
+	ulong load_addr;
+};
+
+static const struct spl_test_fit_image spl_test_fit_images[] = {
+	/* These two are read together, straight to their load addresses */
+	{ "u-boot", 0, CONFIG_TEXT_BASE },
+	{ "tee", SPL_TEST_DATA_SIZE, CONFIG_TEXT_BASE + SPL_TEST_DATA_SIZE },
+	/* These are close together but not in memory, so are read alone */
+	{ "atf-1", SPL_TEST_DATA_SIZE * 2 + 16, CONFIG_TEXT_BASE + 0x100000 },
+	{ "atf-2", SPL_TEST_DATA_SIZE * 3 + 19, CONFIG_TEXT_BASE + 0x80000 },
+};
+
+#define SPL_TEST_FIT_SIZE	0x800
+
+/* Create a FIT with each image in spl_test_fit_images, as external data */
+static int create_fit_multi(void *dst)
+{
+	const char *os = genimg_get_os_short_name(IH_OS_TEE);
+	const struct spl_test_fit_image *img;
+	int i;
+
+	if (fdt_create(dst, SPL_TEST_FIT_SIZE) ||
+	    fdt_finish_reservemap(dst) ||
+	    fdt_begin_node(dst, "") ||
+	    fdt_property_u32(dst, FIT_TIMESTAMP_PROP, 0) ||
+	    fdt_property_u32(dst, "#address-cells", ADDRESS_CELLS) ||
+	    fdt_begin_node(dst, "images"))
+		return -EINVAL;
+
+	for (i = 0; i < ARRAY_SIZE(spl_test_fit_images); i++) {
+		img = &spl_test_fit_images[i];
+		/*
+		 * spl_fit_append_fdt() would put U-Boot's FDT over the next
+		 * image, so use an OS which doesn't take a devicetree
+		 */
+		if (fdt_begin_node(dst, img->name) ||
+		    (!i && fdt_property_string(dst, FIT_OS_PROP, os)) ||
+		    fdt_property_string(dst, FIT_TYPE_PROP, "firmware") ||
+		    fdt_property_string(dst, FIT_COMP_PROP, "none") ||
+		    fdt_property_u32(dst, FIT_DATA_OFFSET_PROP, img->offset) ||
+		    fdt_property_u32(dst, FIT_DATA_SIZE_PROP,
+				     SPL_TEST_DATA_SIZE) ||
+		    fdt_property_addr(dst, FIT_LOAD_PROP, img->load_addr) ||
+		    fdt_end_node(dst))
+			return -EINVAL;
+	}
+	if (fdt_end_node(dst)) /* images */
+		return -EINVAL;
+
+	/* The loadables are not in order, to check that they get sorted */
+	if (fdt_begin_node(dst, "configurations") ||
+	    fdt_property_string(dst, FIT_DEFAULT_PROP, "config-1") ||
+	    fdt_begin_node(dst, "config-1") ||
+	    fdt_property_string(dst, FIT_DESC_PROP, "coalesce") ||
+	    fdt_property_string(dst, FIT_FIRMWARE_PROP, "u-boot") ||
+	    fdt_property(dst, FIT_LOADABLE_PROP, "tee\0atf-2\0atf-1",
+			 sizeof("tee\0atf-2\0atf-1")) ||
+	    fdt_end_node(dst) ||
+	    fdt_end_node(dst) ||
+	    fdt_end_node(dst) ||
+	    fdt_finish(dst))
+		return -EINVAL;
+	fdt_set_totalsize(dst, SPL_TEST_FIT_SIZE);
+
+	return 0;
+}
+
+/* Test that neighbouring images in a FIT are read together */
+static int spl_test_fit_coalesce(struct unit_test_state *uts)
+{
+	const struct spl_test_fit_image *img;
+	struct spl_image_info info_read = { };
+	struct spl_load_info load = {
+		.bl_len = 1,
+		.read = spl_test_read_counted,
+	};
+	size_t img_size;
+	ulong before;
+	char *data;
+	void *fit;
+	int i;
+
+	if (!IS_ENABLED(CONFIG_SPL_LOAD_FIT))
+		return -EAGAIN;
+
+	img_size = SPL_TEST_FIT_SIZE + SPL_TEST_DATA_SIZE * 4 + 19;
+	fit = calloc(img_size, 1);
+	ut_assertnonnull(fit);
+	ut_assertok(create_fit_multi(fit));
+
+	data = fit + SPL_TEST_FIT_SIZE;
+	for (i = 0; i < ARRAY_SIZE(spl_test_fit_images); i++) {
+		img = &spl_test_fit_images[i];
+		generate_data(data + img->offset, SPL_TEST_DATA_SIZE,
+			      img->name);
+	}
+
+	load.priv = fit;
+	spl_test_read_count = 0;
+	ut_assertok(spl_load_simple_fit(&info_read, &load, 0, fit));
+	ut_asserteq(CONFIG_TEXT_BASE, info_read.load_addr);
+
+	/* One read for the FIT, one for the first two images, then the rest */
+	if (IS_ENABLED(CONFIG_SPL_LOAD_FIT_COALESCE))
+		ut_asserteq(4, spl_test_read_count);
+	else
+		ut_asserteq(5, spl_test_read_count);
+
+	for (i = 0; i < ARRAY_SIZE(spl_test_fit_images); i++) {
+		img = &spl_test_fit_images[i];
+		ut_asserteq_mem(data + img->offset,
+				map_sysmem(img->load_addr, SPL_TEST_DATA_SIZE),
+				SPL_TEST_DATA_SIZE);
+	}
+
+	/*
+	 * No buffer is allocated for the images read together. The FIT buffer
+	 * is kept for next time, so it is allocated already.
+	 */
+	before = ut_check_free();
+	ut_assertok(spl_load_simple_fit(&info_read, &load, 0, fit));
+	ut_assertok(ut_check_delta(before));
+
+	free(fit);
+
+	return 0;
+}
+SPL_TEST(spl_test_fit_coalesce, 0);
+
 /*
  * LZMA is too complex to generate on the fly, so let's use some data I put in
  * the oven^H^H^H^H compressed earlier
@@ -5,13 +5,18 @@
 
 #include <common.h>
 #include <dm.h>
+#include <efi_loader.h>
 #include <lmb.h>
 #include <log.h>
 #include <malloc.h>
+#include <mapmem.h>
+#include <asm/global_data.h>
 #include <dm/test.h>
 #include <test/test.h>
 #include <test/ut.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
 static inline bool lmb_is_nomap(struct lmb_property *m)
 {
 	return m->flags & LMB_NOMAP;
@@ -708,13 +713,7 @@ static int lib_test_lmb_max_regions(struct unit_test_state *uts)
 	ut_asserteq(lmb.memory.cnt, CONFIG_LMB_MAX_REGIONS);
 	ut_asserteq(lmb.reserved.cnt, 0);
 
-	/*  error for the (CONFIG_LMB_MAX_REGIONS + 1) memory regions */
-	offset = ram + 2 * (CONFIG_LMB_MAX_REGIONS + 1) * ram_size;
-	ret = lmb_add(&lmb, offset, ram_size);
-	ut_asserteq(ret, -1);
-
-	ut_asserteq(lmb.memory.cnt, CONFIG_LMB_MAX_REGIONS);
-	ut_asserteq(lmb.reserved.cnt, 0);
+	ut_asserteq_ptr(lmb.memory_regions, lmb.memory.region);
 
 	/*  reserve CONFIG_LMB_MAX_REGIONS regions */
 	for (i = 0; i < CONFIG_LMB_MAX_REGIONS; i++) {
@@ -726,21 +725,36 @@ static int lib_test_lmb_max_regions(struct unit_test_state *uts)
 	ut_asserteq(lmb.memory.cnt, CONFIG_LMB_MAX_REGIONS);
 	ut_asserteq(lmb.reserved.cnt, CONFIG_LMB_MAX_REGIONS);
 
-	/*  error for the 9th reserved blocks */
-	offset = ram + 2 * (CONFIG_LMB_MAX_REGIONS + 1) * blk_size;
+	ut_asserteq_ptr(lmb.reserved_regions, lmb.reserved.region);
+
+	/*  the arrays move to the heap for the next regions */
+	offset = ram + 2 * CONFIG_LMB_MAX_REGIONS * ram_size;
+	ret = lmb_add(&lmb, offset, ram_size);
+	ut_asserteq(ret, 0);
+	ut_asserteq(lmb.memory.max, CONFIG_LMB_MAX_REGIONS * 2);
+	ut_assert(lmb.memory.alloced);
+
+	offset = ram + 2 * CONFIG_LMB_MAX_REGIONS * blk_size;
 	ret = lmb_reserve(&lmb, offset, blk_size);
-	ut_asserteq(ret, -1);
+	ut_asserteq(ret, 0);
+	ut_asserteq(lmb.reserved.max, CONFIG_LMB_MAX_REGIONS * 2);
+	ut_assert(lmb.reserved.alloced);
 
-	ut_asserteq(lmb.memory.cnt, CONFIG_LMB_MAX_REGIONS);
-	ut_asserteq(lmb.reserved.cnt, CONFIG_LMB_MAX_REGIONS);
+	ut_asserteq(lmb.memory.cnt, CONFIG_LMB_MAX_REGIONS + 1);
+	ut_asserteq(lmb.reserved.cnt, CONFIG_LMB_MAX_REGIONS + 1);
 
 	/*  check each regions */
-	for (i = 0; i < CONFIG_LMB_MAX_REGIONS; i++)
+	for (i = 0; i <= CONFIG_LMB_MAX_REGIONS; i++)
 		ut_asserteq(lmb.memory.region[i].base, ram + 2 * i * ram_size);
 
-	for (i = 0; i < CONFIG_LMB_MAX_REGIONS; i++)
+	for (i = 0; i <= CONFIG_LMB_MAX_REGIONS; i++)
 		ut_asserteq(lmb.reserved.region[i].base, ram + 2 * i * blk_size);
 
+	lmb_uninit(&lmb);
+	ut_asserteq(lmb.memory.cnt, 0);
+	ut_asserteq_ptr(lmb.memory_regions, lmb.memory.region);
+	ut_asserteq_ptr(lmb.reserved_regions, lmb.reserved.region);
+
 	return 0;
 }
 #endif
@@ -836,3 +850,142 @@ static int lib_test_lmb_flags(struct unit_test_state *uts)
 
 DM_TEST(lib_test_lmb_flags,
 	UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+enum {
+	LMB_TEST_MANY	= 4096,
+};
+
+/* Check that thousands of regions can be reserved, looked up and freed */
+static int lib_test_lmb_many(struct unit_test_state *uts)
+{
+	const phys_addr_t ram = 0x40000000;
+	const phys_size_t ram_size = 0x20000000;
+	const phys_size_t blk_size = 0x1000;
+	phys_addr_t base, alloc;
+	struct lmb lmb;
+	ulong start;
+	long ret;
+	int i, j;
+
+	start = ut_check_free();
+	lmb_init(&lmb);
+	ret = lmb_add(&lmb, ram, ram_size);
+	ut_asserteq(ret, 0);
+
+	/*
+	 * Reserve every other block, visiting them out of order so that
+	 * regions are inserted all over the array
+	 */
+	for (i = 0; i < LMB_TEST_MANY; i++) {
+		j = (i * 1031) % LMB_TEST_MANY;
+		base = ram + 2 * j * blk_size;
+		ret = lmb_reserve_flags(&lmb, base, blk_size,
+					j & 2 ? LMB_NOMAP : LMB_NONE);
+		ut_asserteq(ret, 0);
+	}
+	ut_asserteq(lmb.reserved.cnt, LMB_TEST_MANY);
+	ut_assert(lmb.reserved.max >= LMB_TEST_MANY);
+
+	for (i = 0; i < LMB_TEST_MANY; i++) {
+		base = ram + 2 * i * blk_size;
+		ut_asserteq(lmb.reserved.region[i].base, base);
+		ut_asserteq(lmb.reserved.region[i].size, blk_size);
+		ut_asserteq(lmb_is_reserved(&lmb, base + blk_size - 1), 1);
+		ut_asserteq(lmb_is_reserved_flags(&lmb, base, LMB_NOMAP),
+			    (i >> 1) & 1);
+		ut_asserteq(lmb_is_reserved(&lmb, base + blk_size), 0);
+		if (i < LMB_TEST_MANY - 1)
+			ut_asserteq(lmb_get_free_size(&lmb, base + blk_size),
+				    blk_size);
+	}
+
+	/* overlapping a region fails, wherever it is */
+	ret = lmb_reserve(&lmb, ram + 2 * 1000 * blk_size + 0x800, blk_size);
+	ut_asserteq(ret, -1);
+
+	/* filling a gap joins the regions either side, if the flags match */
+	ret = lmb_reserve(&lmb, ram + 2 * 2001 * blk_size + blk_size, blk_size);
+	ut_asserteq(ret, 1);
+	ut_asserteq(lmb.reserved.cnt, LMB_TEST_MANY);
+	ret = lmb_reserve_flags(&lmb, ram + 2 * 3002 * blk_size + blk_size,
+				blk_size, LMB_NOMAP);
+	ut_asserteq(ret, 2);
+	ut_asserteq(lmb.reserved.cnt, LMB_TEST_MANY - 1);
+	ut_asserteq(lmb.reserved.region[3002].base,
+		    ram + 2 * 3002 * blk_size);
+	ut_asserteq(lmb.reserved.region[3002].size, 3 * blk_size);
+
+	/* the only gap big enough is above all the reservations */
+	alloc = __lmb_alloc_base(&lmb, 2 * blk_size, blk_size,
+				 ram + 2 * LMB_TEST_MANY * blk_size);
+	ut_asserteq(alloc, 0);
+	alloc = lmb_alloc(&lmb, 2 * blk_size, blk_size);
+	ut_asserteq(alloc, ram + ram_size - 2 * blk_size);
+
+	/* free the blocks, splitting one of them first */
+	ret = lmb_free(&lmb, alloc, 2 * blk_size);
+	ut_asserteq(ret, 0);
+	ret = lmb_free(&lmb, ram + 2 * 3002 * blk_size + blk_size, blk_size);
+	ut_asserteq(ret, 0);
+	ut_asserteq(lmb.reserved.cnt, LMB_TEST_MANY);
+	for (i = 0; i < LMB_TEST_MANY; i++) {
+		base = ram + 2 * i * blk_size;
+		if (i == 2001)
+			ret = lmb_free(&lmb, base, 2 * blk_size);
+		else
+			ret = lmb_free(&lmb, base, blk_size);
+		ut_asserteq(ret, 0);
+	}
+	ut_asserteq(lmb.reserved.cnt, 0);
+	ut_asserteq(lmb_free(&lmb, ram, blk_size), -1);
+
+	lmb_uninit(&lmb);
+	ut_asserteq(start, ut_check_free());
+
+	return 0;
+}
+
+DM_TEST(lib_test_lmb_many, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
+
+/* Check that changes to the EFI memory map are seen by LMB */
+static int lib_test_lmb_efi(struct unit_test_state *uts)
+{
+	const efi_uintn_t pages = 4;
+	struct lmb lmb;
+	phys_addr_t base, end;
+	u64 addr;
+
+	if (!CONFIG_IS_ENABLED(EFI_LOADER))
+		return -EAGAIN;
+
+	ut_asserteq(EFI_SUCCESS,
+		    efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES,
+				       EFI_RESERVED_MEMORY_TYPE, pages, &addr));
+	base = map_to_sysmem((void *)(uintptr_t)addr);
+	end = base + pages * EFI_PAGE_SIZE;
+
+	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
+	ut_asserteq(1, lmb_is_reserved_flags(&lmb, base, LMB_NOMAP));
+	ut_asserteq(1, lmb_is_reserved_flags(&lmb, end - 1, LMB_NOMAP));
+	lmb_uninit(&lmb);
+
+	/* freeing part of the area leaves the rest reserved */
+	ut_asserteq(EFI_SUCCESS, efi_free_pages(addr, 1));
+	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
+	ut_asserteq(0, lmb_is_reserved_flags(&lmb, base, LMB_NOMAP));
+	ut_asserteq(1, lmb_is_reserved_flags(&lmb, base + EFI_PAGE_SIZE,
+					     LMB_NOMAP));
+	lmb_uninit(&lmb);
+
+	ut_asserteq(EFI_SUCCESS, efi_free_pages(addr + EFI_PAGE_SIZE,
+						pages - 1));
+	lmb_init_and_reserve(&lmb, gd->bd, (void *)gd->fdt_blob);
+	ut_asserteq(0, lmb_is_reserved_flags(&lmb, base + EFI_PAGE_SIZE,
+					     LMB_NOMAP));
+	ut_asserteq(0, lmb_is_reserved_flags(&lmb, end - 1, LMB_NOMAP));
+	lmb_uninit(&lmb);
+
+	return 0;
+}
+
+DM_TEST(lib_test_lmb_efi, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
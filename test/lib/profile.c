@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the sampling profiler
+ */
+
+#include <common.h>
+#include <command.h>
+#include <console.h>
+#include <malloc.h>
+#include <profile.h>
+#include <time.h>
+#include <trace.h>
+#include <asm/global_data.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+/* Time between samples, and how long to keep the CPU busy for */
+#define PROFILE_TEST_PERIOD_US	100
+#define PROFILE_TEST_BUSY_MS	50
+
+static volatile ulong profile_test_count;
+
+static void profile_test_busy(void)
+{
+	ulong start = get_timer(0);
+
+	while (get_timer(start) < PROFILE_TEST_BUSY_MS)
+		profile_test_count++;
+}
+
+/* Test taking samples and showing them */
+static int lib_test_profile(struct unit_test_state *uts)
+{
+	struct trace_output_sample *out;
+	struct trace_output_hdr *hdr;
+	struct profile_stats stats;
+	size_t needed;
+	void *buff;
+
+	ut_assertok(profile_start(PROFILE_TEST_PERIOD_US));
+	ut_asserteq(-EALREADY, profile_start(PROFILE_TEST_PERIOD_US));
+	profile_test_busy();
+	profile_stop();
+
+	profile_get_stats(&stats);
+	ut_assert(!stats.running);
+	ut_asserteq(PROFILE_TEST_PERIOD_US, stats.period_us);
+	ut_assert(stats.count > 0);
+	ut_asserteq(min_t(uint, stats.count, CONFIG_PROFILE_SAMPLES),
+		    stats.stored);
+	ut_assert(stats.outside <= stats.stored);
+
+	/* Stopping again does nothing */
+	profile_stop();
+
+	/* Too small for the samples, so they are truncated */
+	buff = malloc(sizeof(*hdr) + sizeof(*out));
+	ut_assertnonnull(buff);
+	ut_asserteq(stats.stored > 1 ? -ENOSPC : 0,
+		    profile_list_samples(buff, sizeof(*hdr) + sizeof(*out),
+					 &needed));
+	ut_asserteq(sizeof(*hdr) + stats.stored * sizeof(*out), needed);
+	free(buff);
+
+	buff = malloc(needed);
+	ut_assertnonnull(buff);
+	ut_assertok(profile_list_samples(buff, needed, &needed));
+	hdr = buff;
+	ut_asserteq(TRACE_CHUNK_SAMPLES, hdr->type);
+	ut_asserteq(TRACE_VERSION, hdr->version);
+	ut_asserteq(stats.stored, hdr->rec_count);
+	out = (struct trace_output_sample *)(hdr + 1);
+	ut_assert(out->pc == TRACE_SAMPLE_OUTSIDE || out->pc < gd->mon_len);
+	free(buff);
+
+	console_record_reset_enable();
+	ut_assertok(run_command("profile show 1", 0));
+	ut_assert_nextlinen("Samples: %u taken every %dus", stats.count,
+			    PROFILE_TEST_PERIOD_US);
+	if (stats.stored > stats.outside) {
+		ut_assert_nextline("   Count      %%  Offset");
+		ut_assert_nextlinen("  ");
+		if (console_record_avail())
+			ut_assert_nextlinen("(");
+	}
+	ut_assert_console_end();
+
+	return 0;
+}
+LIB_TEST(lib_test_profile, UT_TESTF_CONSOLE_REC);
@@ -225,3 +225,146 @@ static int lib_memdup(struct unit_test_state *uts)
 	return 0;
 }
 LIB_TEST(lib_memdup, 0);
+
+/**
+ * lib_strlen() - unit test for strlen() and strnlen()
+ *
+ * Test with varied alignment and length of the string, and for strnlen() with
+ * limits either side of the length.
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_strlen(struct unit_test_state *uts)
+{
+	char buf[BUFLEN];
+	int offset, len, limit;
+
+	for (offset = 0; offset <= SWEEP; ++offset) {
+		for (len = 0; len < BUFLEN - SWEEP; ++len) {
+			memset(buf, 'a', BUFLEN);
+			buf[offset + len] = '\0';
+			ut_asserteq(len, strlen(buf + offset));
+			for (limit = 0; limit < BUFLEN - offset; ++limit)
+				ut_asserteq(min(len, limit),
+					    strnlen(buf + offset, limit));
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_strlen, 0);
+
+/**
+ * lib_memchr() - unit test for memchr()
+ *
+ * Test with varied alignment and length of the area and position of the byte,
+ * including a byte which differs from the one searched for only in its top bit
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_memchr(struct unit_test_state *uts)
+{
+	u8 buf[BUFLEN];
+	int offset, len, pos;
+
+	for (offset = 0; offset <= SWEEP; ++offset) {
+		for (len = 0; len < BUFLEN - SWEEP; ++len) {
+			for (pos = 0; pos < BUFLEN - offset; ++pos) {
+				memset(buf, 0x01, BUFLEN);
+				buf[offset + pos] = 0x81;
+				ut_asserteq_ptr(pos < len ? buf + offset + pos :
+						NULL, memchr(buf + offset, 0x81,
+							     len));
+				ut_assertnull(memchr(buf + offset, 0, len));
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_memchr, 0);
+
+/**
+ * lib_memcmp() - unit test for memcmp()
+ *
+ * Test with varied alignment of both areas, length and position of the first
+ * difference, checking the sign of the result
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_memcmp(struct unit_test_state *uts)
+{
+	u8 buf1[BUFLEN], buf2[BUFLEN];
+	int offset1, offset2, len, pos, ret;
+
+	for (offset1 = 0; offset1 <= SWEEP; ++offset1) {
+		for (offset2 = 0; offset2 <= SWEEP; ++offset2) {
+			for (len = 0; len < BUFLEN - SWEEP; ++len) {
+				init_buffer(buf1, 0);
+				memcpy(buf2 + offset2, buf1 + offset1, len);
+				ut_asserteq(0, memcmp(buf1 + offset1,
+						      buf2 + offset2, len));
+				for (pos = 0; pos < len; ++pos) {
+					buf2[offset2 + pos] ^= 0x80;
+					ret = memcmp(buf1 + offset1,
+						     buf2 + offset2, len);
+					if (buf1[offset1 + pos] < 0x80)
+						ut_assert(ret < 0);
+					else
+						ut_assert(ret > 0);
+					buf2[offset2 + pos] ^= 0x80;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_memcmp, 0);
+
+/**
+ * lib_strcmp() - unit test for strcmp()
+ *
+ * Test with varied alignment of both strings, length and position of the
+ * first difference, including one string being a prefix of the other
+ *
+ * @uts:	unit test state
+ * Return:	0 = success, 1 = failure
+ */
+static int lib_strcmp(struct unit_test_state *uts)
+{
+	char buf1[BUFLEN], buf2[BUFLEN];
+	int offset1, offset2, len, pos;
+
+	for (offset1 = 0; offset1 <= SWEEP; ++offset1) {
+		for (offset2 = 0; offset2 <= SWEEP; ++offset2) {
+			for (len = 0; len < BUFLEN - SWEEP - 1; ++len) {
+				memset(buf1, 'a', BUFLEN);
+				memset(buf2, 'a', BUFLEN);
+				buf1[offset1 + len] = '\0';
+				buf2[offset2 + len] = '\0';
+				ut_asserteq(0, strcmp(buf1 + offset1,
+						      buf2 + offset2));
+				for (pos = 0; pos < len; ++pos) {
+					buf2[offset2 + pos] = 'b';
+					ut_assert(strcmp(buf1 + offset1,
+							 buf2 + offset2) < 0);
+					ut_assert(strcmp(buf2 + offset2,
+							 buf1 + offset1) > 0);
+					buf2[offset2 + pos] = 'a';
+				}
+
+				/* Make buf1 a prefix of buf2 */
+				buf2[offset2 + len] = 'a';
+				ut_assert(strcmp(buf1 + offset1,
+						 buf2 + offset2) < 0);
+			}
+		}
+	}
+
+	return 0;
+}
+LIB_TEST(lib_strcmp, 0);
@@ -116,6 +116,7 @@ static int dm_test_post_run(struct unit_test_state *uts)
 	if (gd->fdt_blob) {
 		switch (fdt_action()) {
 		case FDTCHK_COPY:
+			fdtdec_index_invalidate(gd->fdt_blob);
 			memcpy((void *)gd->fdt_blob, uts->fdt_copy, uts->fdt_size);
 			break;
 		case FDTCHK_CHECKSUM: {
@@ -70,6 +70,8 @@ enum {
  * @OUT_FMT_FLAMEGRAPH_CALLS: Write a file suitable for flamegraph.pl
  * @OUT_FMT_FLAMEGRAPH_TIMING: Write a file suitable for flamegraph.pl with the
  * counts set to the number of microseconds used by each function
+ * @OUT_FMT_FLAMEGRAPH_SAMPLES: Write a file suitable for flamegraph.pl with the
+ * counts set to the number of profiler samples taken in each function
  */
 enum out_format_t {
 	OUT_FMT_DEFAULT,
@@ -77,6 +79,7 @@ enum out_format_t {
 	OUT_FMT_FUNCGRAPH,
 	OUT_FMT_FLAMEGRAPH_CALLS,
 	OUT_FMT_FLAMEGRAPH_TIMING,
+	OUT_FMT_FLAMEGRAPH_SAMPLES,
 };
 
 /* Section types for v7 format (trace-cmd format) */
@@ -254,6 +257,8 @@ struct func_info *func_list;
 int func_count;			/* number of functions */
 struct trace_call *call_list;	/* list of all calls in the input trace file */
 int call_count;			/* number of calls */
+struct trace_output_sample *sample_list; /* profiler samples, oldest first */
+int sample_count;		/* number of samples */
 int verbose;	/* Verbosity level 0=none, 1=warn, 2=notice, 3=info, 4=debug */
 ulong text_offset;		/* text address of first function */
 ulong text_base;		/* CONFIG_TEXT_BASE from trace file */
@@ -286,13 +291,15 @@ static void usage(void)
 		"Commands\n"
 		"   dump-ftrace\t\tDump out records in ftrace format for use by trace-cmd\n"
 		"   dump-flamegraph\tWrite a file for use with flamegraph.pl\n"
+		"   dump-profile\t\tWrite the number of samples in each function\n"
 		"\n"
 		"Options:\n"
 		"   -c <cfg>\tSpecify config file\n"
 		"   -f <subtype>\tSpecify output subtype\n"
 		"   -m <map>\tSpecify Systen.map file\n"
 		"   -o <fname>\tSpecify output file\n"
-		"   -t <fname>\tSpecify trace data file (from U-Boot 'trace calls')\n"
+		"   -t <fname>\tSpecify trace data file (from U-Boot 'trace calls'\n"
+		"\t\tor 'profile save')\n"
 		"   -v <0-4>\tSpecify verbosity\n"
 		"\n"
 		"Subtypes for dump-ftrace:\n"
@@ -301,7 +308,8 @@ static void usage(void)
 		"\n"
 		"Subtypes for dump-flamegraph\n"
 		"   calls - create a flamegraph of stack frames\n"
-		"   timing - create a flamegraph of microseconds for each stack frame\n");
+		"   timing - create a flamegraph of microseconds for each stack frame\n"
+		"   samples - create a flamegraph of profiler samples (caller and function)\n");
 	exit(EXIT_FAILURE);
 }
 
@@ -450,6 +458,10 @@ static struct func_info *find_caller_by_offset(uint offset)
 			return &func_list[mid];
 	}
 
+	/* The search never reaches the last function, so check it here */
+	if (high > low && h_cmp_offset(&key, &func_list[high]) >= 0)
+		return &func_list[high];
+
 	return low >= 0 ? &func_list[low] : NULL;
 }
 
@@ -483,11 +495,40 @@ static int read_calls(FILE *fin, size_t count)
 	return 0;
 }
 
+/**
+ * read_samples() - Read the list of profiler samples from the trace data
+ *
+ * @fin: File to read from
+ * @count: Number of samples to read
+ * Returns: 0 if OK, -1 on error
+ */
+static int read_samples(FILE *fin, size_t count)
+{
+	struct trace_output_sample *sample;
+	int i;
+
+	notice("sample count: %zu\n", count);
+	sample_list = realloc(sample_list,
+			      (sample_count + count) * sizeof(*sample));
+	if (!sample_list) {
+		error("Cannot allocate sample_list\n");
+		return -1;
+	}
+
+	sample = sample_list + sample_count;
+	sample_count += count;
+	for (i = 0; i < count; i++, sample++) {
+		if (read_data(fin, sample, sizeof(*sample)))
+			return -1;
+	}
+	return 0;
+}
+
 /**
  * read_trace() - Read the U-Boot trace file
  *
- * Read in the calls from the trace file. The function list is ignored at
- * present
+ * Read in the calls and profiler samples from the trace file. The function
+ * list is ignored at present
  *
  * @fin: File to read
  * Returns 0 if OK, non-zero on error
@@ -515,6 +556,11 @@ static int read_trace(FILE *fin)
 			if (read_calls(fin, hdr.rec_count))
 				return 1;
 			break;
+
+		case TRACE_CHUNK_SAMPLES:
+			if (read_samples(fin, hdr.rec_count))
+				return 1;
+			break;
 		}
 	}
 	return 0;
@@ -1774,6 +1820,84 @@ static int make_flame_tree(enum out_format_t out_format,
 	return 0;
 }
 
+/**
+ * find_child() - Find the child of a flamegraph node for a function
+ *
+ * @node: Parent node
+ * @func: Function to look for
+ * @nodesp: Incremented if a new node is created
+ * Returns: Child node, newly created if needed, or NULL if out of memory
+ */
+static struct flame_node *find_child(struct flame_node *node,
+				     struct func_info *func, int *nodesp)
+{
+	struct flame_node *child;
+
+	list_for_each_entry(child, &node->child_head, sibling_node) {
+		if (child->func == func)
+			return child;
+	}
+	child = create_node("sample");
+	if (!child)
+		return NULL;
+	child->parent = node;
+	child->func = func;
+	list_add_tail(&child->sibling_node, &node->child_head);
+	(*nodesp)++;
+
+	return child;
+}
+
+/**
+ * make_sample_tree() - Create a flamegraph tree from profiler samples
+ *
+ * Each sample only records the function it was taken in and (usually) its
+ * caller, so the tree is at most two levels deep. When the caller is not known
+ * or lies in the same function (e.g. the link register has not been saved
+ * yet), only the function is used.
+ *
+ * @treep: Returns the resulting flamegraph tree
+ * Returns: 0 on success, -ve on error
+ */
+static int make_sample_tree(struct flame_node **treep)
+{
+	struct trace_output_sample *sample;
+	struct func_info *func, *caller;
+	struct flame_node *tree, *node;
+	int i, nodes = 0;
+
+	tree = create_node("tree");
+	if (!tree)
+		return -1;
+
+	for (i = 0, sample = sample_list; i < sample_count; i++, sample++) {
+		if (sample->pc == TRACE_SAMPLE_OUTSIDE)
+			continue;
+		func = find_caller_by_offset(sample->pc);
+		if (!func) {
+			warn("Cannot find function at %lx\n",
+			     text_offset + sample->pc);
+			continue;
+		}
+		caller = NULL;
+		if (sample->caller != TRACE_SAMPLE_OUTSIDE)
+			caller = find_caller_by_offset(sample->caller);
+
+		node = tree;
+		if (caller && caller != func)
+			node = find_child(node, caller, &nodes);
+		if (node)
+			node = find_child(node, func, &nodes);
+		if (!node)
+			return -1;
+		node->count++;
+	}
+	fprintf(stderr, "%d nodes\n", nodes);
+	*treep = tree;
+
+	return 0;
+}
+
 /**
  * output_tree() - Output a flamegraph tree
  *
@@ -1809,7 +1933,7 @@ static int output_tree(FILE *fout, enum out_format_t out_format,
 	int pos;
 
 	if (node->count) {
-		if (out_format == OUT_FMT_FLAMEGRAPH_CALLS) {
+		if (out_format != OUT_FMT_FLAMEGRAPH_TIMING) {
 			fprintf(fout, "%s %d\n", str, node->count);
 		} else {
 			/*
@@ -1861,8 +1985,12 @@ static int make_flamegraph(FILE *fout, enum out_format_t out_format)
 	struct flame_node *tree;
 	char str[500];
 
-	if (make_flame_tree(out_format, &tree))
+	if (out_format == OUT_FMT_FLAMEGRAPH_SAMPLES) {
+		if (make_sample_tree(&tree))
+			return -1;
+	} else if (make_flame_tree(out_format, &tree)) {
 		return -1;
+	}
 
 	*str = '\0';
 	if (output_tree(fout, out_format, tree, str, sizeof(str), 0))
@@ -1871,6 +1999,80 @@ static int make_flamegraph(FILE *fout, enum out_format_t out_format)
 	return 0;
 }
 
+/**
+ * struct func_samples - Number of profiler samples taken in a function
+ *
+ * @func: Function
+ * @count: Number of samples
+ */
+struct func_samples {
+	struct func_info *func;
+	int count;
+};
+
+static int h_cmp_samples(const void *v1, const void *v2)
+{
+	const struct func_samples *s1 = v1, *s2 = v2;
+
+	if (s1->count != s2->count)
+		return s2->count - s1->count;
+
+	return strcmp(s1->func->name, s2->func->name);
+}
+
+/**
+ * make_profile() - Write out the number of samples taken in each function
+ *
+ * The functions are written with the most samples first
+ *
+ * @fout: Output file
+ * Returns 0 if OK, -1 on error
+ */
+static int make_profile(FILE *fout)
+{
+	struct trace_output_sample *sample;
+	struct func_samples *counts;
+	struct func_info *func;
+	int i, outside = 0;
+
+	if (!sample_count) {
+		error("No profiler samples in trace file\n");
+		return -1;
+	}
+	counts = calloc(func_count, sizeof(*counts));
+	if (!counts) {
+		error("Cannot allocate counts\n");
+		return -1;
+	}
+	for (i = 0; i < func_count; i++)
+		counts[i].func = &func_list[i];
+
+	for (i = 0, sample = sample_list; i < sample_count; i++, sample++) {
+		func = NULL;
+		if (sample->pc != TRACE_SAMPLE_OUTSIDE)
+			func = find_caller_by_offset(sample->pc);
+		if (func)
+			counts[func - func_list].count++;
+		else
+			outside++;
+	}
+	qsort(counts, func_count, sizeof(*counts), h_cmp_samples);
+
+	fprintf(fout, "%8s  %6s  %s\n", "Samples", "%", "Function");
+	for (i = 0; i < func_count && counts[i].count; i++) {
+		fprintf(fout, "%8d  %5.1f%%  %s\n", counts[i].count,
+			counts[i].count * 100.0 / sample_count,
+			counts[i].func->name);
+	}
+	if (outside) {
+		fprintf(fout, "%8d  %5.1f%%  (outside U-Boot)\n", outside,
+			outside * 100.0 / sample_count);
+	}
+	free(counts);
+
+	return 0;
+}
+
 /**
  * prof_tool() - Performs requested action
  *
@@ -1918,8 +2120,11 @@ static int prof_tool(int argc, char *const argv[],
 			FILE *fout;
 
 			if (out_format != OUT_FMT_FLAMEGRAPH_CALLS &&
-			    out_format != OUT_FMT_FLAMEGRAPH_TIMING)
-				out_format = OUT_FMT_FLAMEGRAPH_CALLS;
+			    out_format != OUT_FMT_FLAMEGRAPH_TIMING &&
+			    out_format != OUT_FMT_FLAMEGRAPH_SAMPLES)
+				out_format = call_count || !sample_count ?
+					OUT_FMT_FLAMEGRAPH_CALLS :
+					OUT_FMT_FLAMEGRAPH_SAMPLES;
 			fout = fopen(out_fname, "w");
 			if (!fout) {
 				fprintf(stderr, "Cannot write file '%s'\n",
@@ -1928,6 +2133,17 @@ static int prof_tool(int argc, char *const argv[],
 			}
 			err = make_flamegraph(fout, out_format);
 			fclose(fout);
+		} else if (!strcmp(cmd, "dump-profile")) {
+			FILE *fout;
+
+			fout = fopen(out_fname, "w");
+			if (!fout) {
+				fprintf(stderr, "Cannot write file '%s'\n",
+					out_fname);
+				return -1;
+			}
+			err = make_profile(fout);
+			fclose(fout);
 		} else {
 			warn("Unknown command '%s'\n", cmd);
 		}
@@ -1960,9 +2176,11 @@ int main(int argc, char *argv[])
 				out_format = OUT_FMT_FLAMEGRAPH_CALLS;
 			} else if (!strcmp("timing", optarg)) {
 				out_format = OUT_FMT_FLAMEGRAPH_TIMING;
+			} else if (!strcmp("samples", optarg)) {
+				out_format = OUT_FMT_FLAMEGRAPH_SAMPLES;
 			} else {
 				fprintf(stderr,
-					"Invalid format: use function, funcgraph, calls, timing\n");
+					"Invalid format: use function, funcgraph, calls, timing, samples\n");
 				exit(1);
 			}
 			break;